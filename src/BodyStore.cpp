@@ -0,0 +1,276 @@
+#include "BodyStore.h"
+#include "Components.h"
+
+/// @brief Wszystkie tablice obiektu, zmieniane razem przy zmianie rozmiaru.
+static constexpr BodyStore::Array BodyStore::* arrays[] = {
+    &BodyStore::positionX, &BodyStore::positionY, &BodyStore::positionZ,
+    &BodyStore::rotationW, &BodyStore::rotationX, &BodyStore::rotationY, &BodyStore::rotationZ,
+    &BodyStore::velocityX, &BodyStore::velocityY, &BodyStore::velocityZ,
+    &BodyStore::angularVelocityX, &BodyStore::angularVelocityY, &BodyStore::angularVelocityZ,
+    &BodyStore::previousPositionX, &BodyStore::previousPositionY, &BodyStore::previousPositionZ,
+    &BodyStore::previousRotationW, &BodyStore::previousRotationX, &BodyStore::previousRotationY, &BodyStore::previousRotationZ,
+    &BodyStore::previousVelocityX, &BodyStore::previousVelocityY, &BodyStore::previousVelocityZ,
+    &BodyStore::previousAngularVelocityX, &BodyStore::previousAngularVelocityY, &BodyStore::previousAngularVelocityZ,
+    &BodyStore::inverseMass,
+    &BodyStore::inertiaXX, &BodyStore::inertiaXY, &BodyStore::inertiaXZ, &BodyStore::inertiaYY, &BodyStore::inertiaYZ, &BodyStore::inertiaZZ,
+    &BodyStore::inverseInertiaXX, &BodyStore::inverseInertiaXY, &BodyStore::inverseInertiaXZ,
+    &BodyStore::inverseInertiaYY, &BodyStore::inverseInertiaYZ, &BodyStore::inverseInertiaZZ,
+    &BodyStore::restitution, &BodyStore::staticFriction, &BodyStore::dynamicFriction,
+    &BodyStore::active, &BodyStore::kinematic,
+};
+
+void BodyStore::Resize(uint32_t bodyCount)
+{
+    count = bodyCount;
+    size_t paddedCount = (bodyCount + padding - 1) / padding * padding;
+    for (auto array : arrays)
+    {
+        (this->*array).resize(paddedCount);
+        std::fill((this->*array).begin() + bodyCount, (this->*array).end(), 0.0);
+    }
+
+    // Dopełnienie ma jednostkowe obroty, żeby aktualizacja prędkości nie dzieliła przez zero.
+    std::fill(rotationW.begin() + bodyCount, rotationW.end(), 1.0);
+    std::fill(previousRotationW.begin() + bodyCount, previousRotationW.end(), 1.0);
+}
+
+void BodyStore::Load(std::vector<RigidBody>& bodies, real restitutionMultiplier, real staticFrictionMultiplier, real dynamicFrictionMultiplier)
+{
+    Resize(bodies.size());
+    movingBlocks.clear();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        RigidBody& body = bodies[i];
+        bool dynamic = body.type == RigidBody::Type::Dynamic && body.inverseMass != 0;
+        bool isKinematic = body.type == RigidBody::Type::Kinematic;
+        const rvec3& position = body.GetPosition();
+        const rquat& rotation = body.GetRotation();
+        positionX[i] = position.x;
+        positionY[i] = position.y;
+        positionZ[i] = position.z;
+        rotationW[i] = rotation.w;
+        rotationX[i] = rotation.x;
+        rotationY[i] = rotation.y;
+        rotationZ[i] = rotation.z;
+        // Prędkość obiektu statycznego jest zerowa, nawet jeżeli ustawiono ją w komponencie, bo obiekt nie jest całkowany.
+        rvec3 velocity = dynamic || isKinematic ? body.velocity : rvec3(0);
+        rvec3 angularVelocity = dynamic || isKinematic ? body.angularVelocity : rvec3(0);
+        velocityX[i] = velocity.x;
+        velocityY[i] = velocity.y;
+        velocityZ[i] = velocity.z;
+        angularVelocityX[i] = angularVelocity.x;
+        angularVelocityY[i] = angularVelocity.y;
+        angularVelocityZ[i] = angularVelocity.z;
+
+        previousPositionX[i] = body.previousPosition.x;
+        previousPositionY[i] = body.previousPosition.y;
+        previousPositionZ[i] = body.previousPosition.z;
+        previousRotationW[i] = body.previousRotation.w;
+        previousRotationX[i] = body.previousRotation.x;
+        previousRotationY[i] = body.previousRotation.y;
+        previousRotationZ[i] = body.previousRotation.z;
+        previousVelocityX[i] = body.previousVelocity.x;
+        previousVelocityY[i] = body.previousVelocity.y;
+        previousVelocityZ[i] = body.previousVelocity.z;
+        previousAngularVelocityX[i] = body.previousAngularVelocity.x;
+        previousAngularVelocityY[i] = body.previousAngularVelocity.y;
+        previousAngularVelocityZ[i] = body.previousAngularVelocity.z;
+
+        // Tensor obiektu statycznego ma nieskończoności, które w jądrach dałyby NaN nawet po zamaskowaniu mnożeniem.
+        inverseMass[i] = dynamic ? body.inverseMass : 0;
+        inertiaXX[i] = dynamic ? body.inertiaTensor[0][0] : 0;
+        inertiaXY[i] = dynamic ? body.inertiaTensor[0][1] : 0;
+        inertiaXZ[i] = dynamic ? body.inertiaTensor[0][2] : 0;
+        inertiaYY[i] = dynamic ? body.inertiaTensor[1][1] : 0;
+        inertiaYZ[i] = dynamic ? body.inertiaTensor[1][2] : 0;
+        inertiaZZ[i] = dynamic ? body.inertiaTensor[2][2] : 0;
+        inverseInertiaXX[i] = dynamic ? body.inverseInertiaTensor[0][0] : 0;
+        inverseInertiaXY[i] = dynamic ? body.inverseInertiaTensor[0][1] : 0;
+        inverseInertiaXZ[i] = dynamic ? body.inverseInertiaTensor[0][2] : 0;
+        inverseInertiaYY[i] = dynamic ? body.inverseInertiaTensor[1][1] : 0;
+        inverseInertiaYZ[i] = dynamic ? body.inverseInertiaTensor[1][2] : 0;
+        inverseInertiaZZ[i] = dynamic ? body.inverseInertiaTensor[2][2] : 0;
+
+        restitution[i] = body.restitutionCoefficient * restitutionMultiplier;
+        staticFriction[i] = body.staticFrictionCoefficient * staticFrictionMultiplier;
+        dynamicFriction[i] = body.dynamicFrictionCoefficient * dynamicFrictionMultiplier;
+        active[i] = dynamic && !body.sleeping ? 1.0 : 0.0;
+        kinematic[i] = isKinematic ? 1.0 : 0.0;
+
+        if (IsMoving(i) && (movingBlocks.empty() || movingBlocks.back() != i / padding * padding))
+            movingBlocks.push_back(i / padding * padding);
+    }
+}
+
+void BodyStore::Store(std::vector<RigidBody>& bodies) const
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        RigidBody& body = bodies[i];
+        body.GetPosition() = GetPosition(i);
+        body.GetRotation() = GetRotation(i);
+        body.velocity = GetVelocity(i);
+        body.angularVelocity = GetAngularVelocity(i);
+        body.previousPosition = GetPreviousPosition(i);
+        body.previousRotation = GetPreviousRotation(i);
+        body.previousVelocity = GetPreviousVelocity(i);
+        body.previousAngularVelocity = GetPreviousAngularVelocity(i);
+    }
+}
+
+void BodyStore::Integrate(uint32_t begin, uint32_t end, const rvec3& gravity, real deltaT)
+{
+    using V = SimdReal;
+    V dt = deltaT;
+    V halfDt = 0.5 * deltaT;
+    V gravityX = gravity.x * deltaT;
+    V gravityY = gravity.y * deltaT;
+    V gravityZ = gravity.z * deltaT;
+
+    for (uint32_t i = begin; i < end; i += V::width)
+    {
+        // Grawitacja i moment żyroskopowy działają tylko na obudzone obiekty dynamiczne, a obiekty kinematyczne są tylko przesuwane.
+        SimdMask mask = V::Load(&active[i]) != V(0.0);
+        SimdMask moving = mask | (V::Load(&kinematic[i]) != V(0.0));
+
+        V vx = Select(mask, V::Load(&velocityX[i]) + gravityX, V::Load(&velocityX[i]));
+        V vy = Select(mask, V::Load(&velocityY[i]) + gravityY, V::Load(&velocityY[i]));
+        V vz = Select(mask, V::Load(&velocityZ[i]) + gravityZ, V::Load(&velocityZ[i]));
+        V wx = V::Load(&angularVelocityX[i]);
+        V wy = V::Load(&angularVelocityY[i]);
+        V wz = V::Load(&angularVelocityZ[i]);
+        V px = V::Load(&positionX[i]);
+        V py = V::Load(&positionY[i]);
+        V pz = V::Load(&positionZ[i]);
+        V qw = V::Load(&rotationW[i]);
+        V qx = V::Load(&rotationX[i]);
+        V qy = V::Load(&rotationY[i]);
+        V qz = V::Load(&rotationZ[i]);
+
+        px.Store(&previousPositionX[i]);
+        py.Store(&previousPositionY[i]);
+        pz.Store(&previousPositionZ[i]);
+        qw.Store(&previousRotationW[i]);
+        qx.Store(&previousRotationX[i]);
+        qy.Store(&previousRotationY[i]);
+        qz.Store(&previousRotationZ[i]);
+        vx.Store(&previousVelocityX[i]);
+        vy.Store(&previousVelocityY[i]);
+        vz.Store(&previousVelocityZ[i]);
+        wx.Store(&previousAngularVelocityX[i]);
+        wy.Store(&previousAngularVelocityY[i]);
+        wz.Store(&previousAngularVelocityZ[i]);
+        vx.Store(&velocityX[i]);
+        vy.Store(&velocityY[i]);
+        vz.Store(&velocityZ[i]);
+
+        // Moment żyroskopowy: w -= dt * I^-1 * (w x I * w).
+        V Ixx = V::Load(&inertiaXX[i]), Ixy = V::Load(&inertiaXY[i]), Ixz = V::Load(&inertiaXZ[i]);
+        V Iyy = V::Load(&inertiaYY[i]), Iyz = V::Load(&inertiaYZ[i]), Izz = V::Load(&inertiaZZ[i]);
+        V Iwx = Ixx * wx + Ixy * wy + Ixz * wz;
+        V Iwy = Ixy * wx + Iyy * wy + Iyz * wz;
+        V Iwz = Ixz * wx + Iyz * wy + Izz * wz;
+        V cx = wy * Iwz - wz * Iwy;
+        V cy = wz * Iwx - wx * Iwz;
+        V cz = wx * Iwy - wy * Iwx;
+        V Jxx = V::Load(&inverseInertiaXX[i]), Jxy = V::Load(&inverseInertiaXY[i]), Jxz = V::Load(&inverseInertiaXZ[i]);
+        V Jyy = V::Load(&inverseInertiaYY[i]), Jyz = V::Load(&inverseInertiaYZ[i]), Jzz = V::Load(&inverseInertiaZZ[i]);
+        wx = Select(mask, wx - dt * (Jxx * cx + Jxy * cy + Jxz * cz), wx);
+        wy = Select(mask, wy - dt * (Jxy * cx + Jyy * cy + Jyz * cz), wy);
+        wz = Select(mask, wz - dt * (Jxz * cx + Jyz * cy + Jzz * cz), wz);
+        wx.Store(&angularVelocityX[i]);
+        wy.Store(&angularVelocityY[i]);
+        wz.Store(&angularVelocityZ[i]);
+
+        Select(moving, px + vx * dt, px).Store(&positionX[i]);
+        Select(moving, py + vy * dt, py).Store(&positionY[i]);
+        Select(moving, pz + vz * dt, pz).Store(&positionZ[i]);
+
+        // q += dt / 2 * (0, w) * q, a następnie normalizacja.
+        V nw = qw - halfDt * (wx * qx + wy * qy + wz * qz);
+        V nx = qx + halfDt * (wx * qw + wy * qz - wz * qy);
+        V ny = qy + halfDt * (wy * qw + wz * qx - wx * qz);
+        V nz = qz + halfDt * (wz * qw + wx * qy - wy * qx);
+        V inverseLength = V(1.0) / Sqrt(nw * nw + nx * nx + ny * ny + nz * nz);
+        Select(moving, nw * inverseLength, qw).Store(&rotationW[i]);
+        Select(moving, nx * inverseLength, qx).Store(&rotationX[i]);
+        Select(moving, ny * inverseLength, qy).Store(&rotationY[i]);
+        Select(moving, nz * inverseLength, qz).Store(&rotationZ[i]);
+    }
+}
+
+void BodyStore::UpdateVelocities(uint32_t begin, uint32_t end, real deltaT)
+{
+    using V = SimdReal;
+    V inverseDt = 1.0 / deltaT;
+    V twoInverseDt = 2.0 / deltaT;
+
+    for (uint32_t i = begin; i < end; i += V::width)
+    {
+        // Obiekty kinematyczne zachowują zadaną prędkość, różnica położeń dawałaby ją z błędem zaokrąglenia.
+        SimdMask mask = V::Load(&active[i]) != V(0.0);
+        Select(mask, (V::Load(&positionX[i]) - V::Load(&previousPositionX[i])) * inverseDt, V::Load(&velocityX[i])).Store(&velocityX[i]);
+        Select(mask, (V::Load(&positionY[i]) - V::Load(&previousPositionY[i])) * inverseDt, V::Load(&velocityY[i])).Store(&velocityY[i]);
+        Select(mask, (V::Load(&positionZ[i]) - V::Load(&previousPositionZ[i])) * inverseDt, V::Load(&velocityZ[i])).Store(&velocityZ[i]);
+
+        // Obrót w pod kroku: q * p^-1, gdzie p^-1 to sprzężenie p podzielone przez kwadrat jego długości.
+        V qw = V::Load(&rotationW[i]), qx = V::Load(&rotationX[i]), qy = V::Load(&rotationY[i]), qz = V::Load(&rotationZ[i]);
+        V pw = V::Load(&previousRotationW[i]), px = V::Load(&previousRotationX[i]), py = V::Load(&previousRotationY[i]), pz = V::Load(&previousRotationZ[i]);
+        V inverseNorm = V(1.0) / (pw * pw + px * px + py * py + pz * pz);
+        pw = pw * inverseNorm;
+        px = -px * inverseNorm;
+        py = -py * inverseNorm;
+        pz = -pz * inverseNorm;
+        V dw = qw * pw - qx * px - qy * py - qz * pz;
+        V dx = qw * px + qx * pw + qy * pz - qz * py;
+        V dy = qw * py - qx * pz + qy * pw + qz * px;
+        V dz = qw * pz + qx * py - qy * px + qz * pw;
+
+        // Kwaternion i jego przeciwny to ten sam obrót, wybierany jest krótszy.
+        V scale = Select(dw >= V(0.0), twoInverseDt, -twoInverseDt);
+        Select(mask, dx * scale, V::Load(&angularVelocityX[i])).Store(&angularVelocityX[i]);
+        Select(mask, dy * scale, V::Load(&angularVelocityY[i])).Store(&angularVelocityY[i]);
+        Select(mask, dz * scale, V::Load(&angularVelocityZ[i])).Store(&angularVelocityZ[i]);
+    }
+}
+
+real BodyStore::GetMass(uint32_t i, const rvec3& point, const rvec3& normal) const
+{
+    if (active[i] == 0)
+        return 0;
+
+    rvec3 cross = glm::cross(point, normal);
+    return inverseMass[i] + glm::dot(cross, GetInverseInertia(i) * cross);
+}
+
+void BodyStore::ApplyPositionalImpulse(uint32_t i, const rvec3& impulse, const rvec3& point)
+{
+    if (active[i] == 0)
+        return;
+
+    positionX[i] += impulse.x * inverseMass[i];
+    positionY[i] += impulse.y * inverseMass[i];
+    positionZ[i] += impulse.z * inverseMass[i];
+
+    rquat rotation = GetRotation(i);
+    rotation += real(0.5) * rquat(0, GetInverseInertia(i) * glm::cross(point, impulse)) * rotation;
+    rotationW[i] = rotation.w;
+    rotationX[i] = rotation.x;
+    rotationY[i] = rotation.y;
+    rotationZ[i] = rotation.z;
+}
+
+void BodyStore::ApplyVelocityImpulse(uint32_t i, const rvec3& impulse, const rvec3& point)
+{
+    if (active[i] == 0)
+        return;
+
+    velocityX[i] += impulse.x * inverseMass[i];
+    velocityY[i] += impulse.y * inverseMass[i];
+    velocityZ[i] += impulse.z * inverseMass[i];
+
+    rvec3 angularImpulse = GetInverseInertia(i) * glm::cross(point, impulse);
+    angularVelocityX[i] += angularImpulse.x;
+    angularVelocityY[i] += angularImpulse.y;
+    angularVelocityZ[i] += angularImpulse.z;
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include "Real.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include "SimdReal.h"
+
+struct RigidBody;
+
+/// @brief Alokator zwracający pamięć wyrównaną do @p Alignment bajtów.
+template <typename T, size_t Alignment = SimdReal::alignment>
+struct AlignedAllocator
+{
+    using value_type = T;
+
+    template <typename U>
+    struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment))); }
+    void deallocate(T* p, size_t) { ::operator delete(p, std::align_val_t(Alignment)); }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+};
+
+/// @brief Stan obiektów sztywnych w układzie struktury tablic (SoA), na którym Physics wykonuje krok.
+/// @details Każda składowa wektorów, kwaternionów i tensorów to osobna ciągła tablica wyrównana do 64 bajtów, dzięki czemu całkowanie
+/// i aktualizacja prędkości przetwarzają SimdReal::width obiektów naraz bez rozgałęzień. Indeks obiektu to indeks komponentu RigidBody,
+/// tablice są dopełnione do wielokrotności szerokości AVX-512 nieaktywnymi obiektami.
+/// Stan jest kopiowany z komponentów przez Load na początku kroku i zapisywany do Transform i RigidBody przez Store na jego końcu,
+/// w trakcie kroku komponenty nie są czytane.
+class BodyStore
+{
+public:
+    using Array = std::vector<real, AlignedAllocator<real>>;
+
+    /// @brief Liczba obiektów, do której dopełniane są tablice.
+    static constexpr size_t padding = SimdReal::alignment / sizeof(real);
+
+    Array positionX, positionY, positionZ;
+    Array rotationW, rotationX, rotationY, rotationZ;
+    Array velocityX, velocityY, velocityZ;
+    Array angularVelocityX, angularVelocityY, angularVelocityZ;
+
+    Array previousPositionX, previousPositionY, previousPositionZ;
+    Array previousRotationW, previousRotationX, previousRotationY, previousRotationZ;
+    Array previousVelocityX, previousVelocityY, previousVelocityZ;
+    Array previousAngularVelocityX, previousAngularVelocityY, previousAngularVelocityZ;
+
+    Array inverseMass;
+    /// @brief Tensor bezwładności i jego odwrotność, symetryczne, więc zapisane jest 6 składowych.
+    Array inertiaXX, inertiaXY, inertiaXZ, inertiaYY, inertiaYZ, inertiaZZ;
+    Array inverseInertiaXX, inverseInertiaXY, inverseInertiaXZ, inverseInertiaYY, inverseInertiaYZ, inverseInertiaZZ;
+
+    /// @brief Współczynniki z komponentów przemnożone przez mnożniki podane w Load.
+    Array restitution, staticFriction, dynamicFriction;
+    /// @brief 1 dla obudzonych obiektów dynamicznych, 0 dla statycznych, kinematycznych i śpiących, które nie są całkowane ani przesuwane przez ograniczniki.
+    Array active;
+    /// @brief 1 dla obiektów kinematycznych, które Integrate przesuwa z ich prędkością, ale bez grawitacji i ograniczników.
+    Array kinematic;
+
+    /// @brief Początki bloków @ref padding obiektów, w których jest obudzony obiekt dynamiczny lub obiekt kinematyczny, rosnąco.
+    /// @details Integrate i UpdateVelocities wywoływane są tylko dla tych bloków, bloki samych obiektów statycznych i śpiących są pomijane.
+    std::vector<uint32_t> movingBlocks;
+
+    /// @brief Liczba obiektów bez dopełnienia.
+    uint32_t size() const { return count; }
+    /// @brief Liczba obiektów z dopełnieniem, wielokrotność @ref padding .
+    uint32_t GetPaddedSize() const { return positionX.size(); }
+
+    /// @brief Kopiuje stan komponentów do tablic.
+    /// @param restitutionMultiplier mnożnik współczynników restytucji
+    /// @param staticFrictionMultiplier mnożnik współczynników tarcia statycznego
+    /// @param dynamicFrictionMultiplier mnożnik współczynników tarcia dynamicznego
+    void Load(std::vector<RigidBody>& bodies, real restitutionMultiplier, real staticFrictionMultiplier, real dynamicFrictionMultiplier);
+
+    /// @brief Zapisuje położenia i obroty do komponentów Transform, a prędkości i stan z początku pod kroku do komponentów RigidBody.
+    void Store(std::vector<RigidBody>& bodies) const;
+
+    /// @brief Dodaje grawitację, zapamiętuje stan z początku pod kroku i przesuwa obiekty w przedziale [ @p begin , @p end ).
+    /// @details Granice przedziału muszą być wielokrotnościami @ref padding .
+    void Integrate(uint32_t begin, uint32_t end, const rvec3& gravity, real deltaT);
+
+    /// @brief Wyznacza prędkości obudzonych obiektów dynamicznych z różnicy położeń i obrotów względem początku pod kroku w przedziale [ @p begin , @p end ).
+    /// @details Granice przedziału muszą być wielokrotnościami @ref padding .
+    void UpdateVelocities(uint32_t begin, uint32_t end, real deltaT);
+
+    /// @brief Czy obiekt zmienia położenie w trakcie kroku, czyli jest obudzonym obiektem dynamicznym lub obiektem kinematycznym.
+    bool IsMoving(uint32_t i) const { return active[i] != 0 || kinematic[i] != 0; }
+
+    rvec3 GetPosition(uint32_t i) const { return { positionX[i], positionY[i], positionZ[i] }; }
+    rquat GetRotation(uint32_t i) const { return rquat(rotationW[i], rotationX[i], rotationY[i], rotationZ[i]); }
+    rvec3 GetVelocity(uint32_t i) const { return { velocityX[i], velocityY[i], velocityZ[i] }; }
+    rvec3 GetAngularVelocity(uint32_t i) const { return { angularVelocityX[i], angularVelocityY[i], angularVelocityZ[i] }; }
+    rvec3 GetPreviousPosition(uint32_t i) const { return { previousPositionX[i], previousPositionY[i], previousPositionZ[i] }; }
+    rquat GetPreviousRotation(uint32_t i) const { return rquat(previousRotationW[i], previousRotationX[i], previousRotationY[i], previousRotationZ[i]); }
+    rvec3 GetPreviousVelocity(uint32_t i) const { return { previousVelocityX[i], previousVelocityY[i], previousVelocityZ[i] }; }
+    rvec3 GetPreviousAngularVelocity(uint32_t i) const { return { previousAngularVelocityX[i], previousAngularVelocityY[i], previousAngularVelocityZ[i] }; }
+
+    rmat3 GetInverseInertia(uint32_t i) const
+    {
+        return rmat3(
+            inverseInertiaXX[i], inverseInertiaXY[i], inverseInertiaXZ[i],
+            inverseInertiaXY[i], inverseInertiaYY[i], inverseInertiaYZ[i],
+            inverseInertiaXZ[i], inverseInertiaYZ[i], inverseInertiaZZ[i]);
+    }
+
+    /// @brief Odwrotność masy uogólnionej w punkcie @p point względem środka masy, w kierunku @p normal , 0 dla nieaktywnych obiektów.
+    real GetMass(uint32_t i, const rvec3& point, const rvec3& normal) const;
+    void ApplyPositionalImpulse(uint32_t i, const rvec3& impulse, const rvec3& point);
+    void ApplyVelocityImpulse(uint32_t i, const rvec3& impulse, const rvec3& point);
+
+private:
+    uint32_t count = 0;
+
+    void Resize(uint32_t bodyCount);
+};
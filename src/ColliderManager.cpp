@@ -1,62 +1,89 @@
 #include "ColliderManager.h"
+#include "SimdReal.h"
+#include "Profiler.h"
 #include <math.h>
 #include <unordered_set>
+#include <algorithm>
+#include <bit>
 
+// Punkty przeliczane między układem obiektu i układem świata tracą ostatnie bity mantysy, w pojedynczej precyzji
+// daleko od początku układu to około 1e-4 rozmiaru obiektu, więc tolerancje przynależności i zbieżności EPA są większe.
+#ifdef PHYSICS_SINGLE_PRECISION
+static constexpr real containmentTolerance = 1.0001;
+static constexpr real epaTolerance = 0.0001;
+#else
+static constexpr real containmentTolerance = 1.000000001;
+static constexpr real epaTolerance = 0.00001;
+#endif
 
-bool IsVectorZero(dvec3 v, double e)
+bool IsVectorZero(rvec3 v, real e)
 {
     v = glm::abs(v);
     return v.x < e && v.y < e && v.z < e;
 }
 
-bool ColliderManager::GJK(const Collider& a, const Collider& b, Support* simplex)
+bool ColliderManager::SolveGJK(const Collider& a, const Collider& b, Support* simplex, rvec3* separatingAxis, uint32_t* supportEvaluations)
 {
+    auto support = [&](const rvec3& n) {
+        (*supportEvaluations)++;
+        return Support(a, b, n);
+        };
+
     // Wyznacz p1 punkt który na pewno jest wewnątrz różnicy minkowskiego, jest to np różnica środków obiektów.
-    dvec3 n = { 0,0,1 };
-    simplex[0] = Support(a.GetComponent<Transform>().position, b.GetComponent<Transform>().position);
+    rvec3 n = { 0,0,1 };
+    simplex[0] = Support(GetPose(a).position, GetPose(b).position);
 
     // Znjadź p2 na różnicy minkowskiego w kierunku punktu (0,0) z punktu p1.
     if (!IsVectorZero(simplex[0], 0.000000001))
-        n = glm::normalize(-(dvec3) simplex[0]);
-    simplex[1] = Support(a, b, n);
+        n = glm::normalize(-(rvec3) simplex[0]);
+    simplex[1] = support(n);
 
     // Jeżeli p2 nie jest za punktem (0,0) to znaczy że nie ma kolizji.
-    double dotProduct = glm::dot((dvec3) simplex[1], n);
+    real dotProduct = glm::dot((rvec3) simplex[1], n);
     if (dotProduct < 0)
+    {
+        *separatingAxis = n;
         return false;
+    }
 
     // Znjadź p3 na różnicy minkowskiego w kierunku punktu (0,0) z punktu p2.
-    n = glm::normalize(-(dvec3) simplex[1]);
-    simplex[2] = Support(a, b, n);
+    n = glm::normalize(-(rvec3) simplex[1]);
+    simplex[2] = support(n);
 
     // Jeżeli p1, p2, p3 są kolniowe, to znajdź nowy p3 w kierunku prostopadłym do p1, p2.
-    dvec3 cross = glm::cross((dvec3) simplex[1] - (dvec3) simplex[0], (dvec3) simplex[2] - (dvec3) simplex[0]);
+    rvec3 cross = glm::cross((rvec3) simplex[1] - (rvec3) simplex[0], (rvec3) simplex[2] - (rvec3) simplex[0]);
     if (IsVectorZero(cross, 0.000000001))
     {
-        n = glm::normalize(glm::cross(-(dvec3) simplex[0], -(dvec3) simplex[1] + dvec3{ ((dvec3) simplex[1]).y,  ((dvec3) simplex[1]).z,  ((dvec3) simplex[1]).x }));
-        simplex[2] = Support(a, b, n);
+        n = glm::normalize(glm::cross(-(rvec3) simplex[0], -(rvec3) simplex[1] + rvec3{ ((rvec3) simplex[1]).y,  ((rvec3) simplex[1]).z,  ((rvec3) simplex[1]).x }));
+        simplex[2] = support(n);
     }
 
     // Jeżeli p3 nie jest za punktem (0,0) to znaczy że nie ma kolizji.
-    dotProduct = glm::dot((dvec3) simplex[2], n);
+    dotProduct = glm::dot((rvec3) simplex[2], n);
     if (dotProduct < 0)
+    {
+        *separatingAxis = n;
         return false;
+    }
 
     // Znajdź punkt p4, w kierunku przeciwnym do normalnej trójkąta stworzonego z p1, p2, p3.
     // Jeżeli normalna jest skierowana w kierunku (0,0) to odwróć trójkąt
-    n = glm::cross((dvec3) simplex[1] - (dvec3) simplex[0], (dvec3) simplex[2] - (dvec3) simplex[0]);
-    if (glm::dot(n, (dvec3) simplex[0]) > 0)
+    n = glm::cross((rvec3) simplex[1] - (rvec3) simplex[0], (rvec3) simplex[2] - (rvec3) simplex[0]);
+    if (glm::dot(n, (rvec3) simplex[0]) > 0)
     {
         std::swap(simplex[0], simplex[1]);
-        n = glm::cross((dvec3) simplex[1] - (dvec3) simplex[0], (dvec3) simplex[2] - (dvec3) simplex[0]);
+        n = glm::cross((rvec3) simplex[1] - (rvec3) simplex[0], (rvec3) simplex[2] - (rvec3) simplex[0]);
     }
     n = glm::normalize(n);
-    simplex[3] = Support(a, b, n);
-    dotProduct = glm::dot((dvec3) simplex[3], n);
+    simplex[3] = support(n);
+    dotProduct = glm::dot((rvec3) simplex[3], n);
 
     // Jeżeli p4 nie jest za punktem (0,0) to nie ma kolizji, natomiast jeżeli jest za to jest kolizja.
     if (dotProduct <= 0)
+    {
+        *separatingAxis = n;
         return false;
+    }
 
     // Simplex jest już tetrahedronem, ma 4 trójkąty jeden zawsze na pewno ma normalną po dobrej stronie,
     // przejdź po pozostałych 3, jeżeli (0.0) jest po stronie normalnej trójkąta, to znaczy że jest poza tetrahedronem z tej strony,
@@ -76,18 +103,21 @@ bool ColliderManager::GJK(const Collider& a, const Collider& b, Support* simplex
             if (triangleWinding < 0) triangleWinding = 3 + triangleWinding;
             int thirdIndex = (baseIndex + triangleWinding + 1) % 4;
 
-            n = glm::cross((dvec3) simplex[secondIndex] - (dvec3) simplex[baseIndex], (dvec3) simplex[thirdIndex] - (dvec3) simplex[baseIndex]);
-            if (glm::dot(n, (dvec3) simplex[baseIndex]) < 0)
+            n = glm::cross((rvec3) simplex[secondIndex] - (rvec3) simplex[baseIndex], (rvec3) simplex[thirdIndex] - (rvec3) simplex[baseIndex]);
+            if (glm::dot(n, (rvec3) simplex[baseIndex]) < 0)
             {
                 int unusedIndex = 6 - (baseIndex + secondIndex + thirdIndex);
                 std::swap(simplex[secondIndex], simplex[thirdIndex]);
 
                 n = glm::normalize(n);
-                simplex[unusedIndex] = Support(a, b, n);
+                simplex[unusedIndex] = support(n);
 
                 lastCorrectedPoint = unusedIndex;
-                if (glm::dot(n, (dvec3) simplex[unusedIndex]) < 0)
+                if (glm::dot(n, (rvec3) simplex[unusedIndex]) < 0)
+                {
+                    *separatingAxis = n;
                     return false;
+                }
 
                 j = -1;
                 break;
@@ -97,26 +127,536 @@ bool ColliderManager::GJK(const Collider& a, const Collider& b, Support* simplex
             return true;
     }
 
+    *separatingAxis = rvec3(0);
     return false;
 }
 
+/// @brief Czy punkt w lokalnym układzie obiektu należy do obiektu.
+static bool ContainsLocalPoint(const Collider& collider, const rvec3& point)
+{
+    if (collider.type == Collider::Type::Sphere)
+        return glm::dot(point, point) <= collider.radius * collider.radius * containmentTolerance;
+
+    rvec3 p = glm::abs(point);
+    rvec3 size = collider.size * containmentTolerance;
+    return p.x <= size.x && p.y <= size.y && p.z <= size.z;
+}
+
+/// @brief Objętość ze znakiem czworościanu o wierzchołkach @p a , @p b , @p c , @p d pomnożona przez 6.
+static real SignedVolume(const rvec3& a, const rvec3& b, const rvec3& c, const rvec3& d)
+{
+    return glm::dot(b - a, glm::cross(c - a, d - a));
+}
+
+bool ColliderManager::GJK(const Collider& a, const Collider& b, Support* simplex, GJKCache* cache)
+{
+    PROFILE_ZONE("ColliderManager::GJK");
+    gjkStatistics.calls.fetch_add(1, std::memory_order_relaxed);
+    if (cache)
+    {
+        // Obiekty przesuwają się między wywołaniami niewiele, więc poprzednia oś zwykle dalej je rozdziela.
+        if (cache->state == GJKCache::State::Separated)
+        {
+            gjkStatistics.supportEvaluations.fetch_add(1, std::memory_order_relaxed);
+            if (glm::dot((rvec3) Support(a, b, cache->separatingAxis), cache->separatingAxis) < 0)
+            {
+                gjkStatistics.cacheHits.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        else if (cache->state == GJKCache::State::Colliding && IsCachedSimplexValid(a, b, *cache, simplex))
+        {
+            gjkStatistics.cacheHits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    rvec3 separatingAxis;
+    uint32_t supportEvaluations = 0;
+    bool colliding = SolveGJK(a, b, simplex, &separatingAxis, &supportEvaluations);
+    gjkStatistics.supportEvaluations.fetch_add(supportEvaluations, std::memory_order_relaxed);
+    if (!cache)
+        return colliding;
+
+    if (colliding)
+    {
+        const ColliderPose& aTr = GetPose(a);
+        const ColliderPose& bTr = GetPose(b);
+        for (int i = 0; i < 4; i++)
+            cache->simplex[i] = Support(aTr.inverseRotationMatrix * (simplex[i].GetA() - aTr.position), bTr.inverseRotationMatrix * (simplex[i].GetB() - bTr.position));
+        cache->positiveVolume = SignedVolume(simplex[0], simplex[1], simplex[2], simplex[3]) > 0;
+        cache->state = GJKCache::State::Colliding;
+    }
+    else if (separatingAxis != rvec3(0))
+    {
+        cache->separatingAxis = separatingAxis;
+        cache->state = GJKCache::State::Separated;
+    }
+    else
+        cache->state = GJKCache::State::Empty;
+
+    return colliding;
+}
+
+bool ColliderManager::IsCachedSimplexValid(const Collider& a, const Collider& b, const GJKCache& cache, Support* simplex)
+{
+    // Punkty należące do obu obiektów zawsze dają punkt różnicy Minkowskiego, więc jeżeli czworościan z takich punktów
+    // zawiera początek układu, to obiekty są w kolizji, niezależnie od tego jak bardzo przesunęły się od poprzedniego wywołania.
+    const ColliderPose& aTr = GetPose(a);
+    const ColliderPose& bTr = GetPose(b);
+    rvec3 points[4];
+    for (int i = 0; i < 4; i++)
+    {
+        if (!ContainsLocalPoint(a, cache.simplex[i].GetA()) || !ContainsLocalPoint(b, cache.simplex[i].GetB()))
+            return false;
+
+        simplex[i] = Support(aTr.rotationMatrix * cache.simplex[i].GetA() + aTr.position, bTr.rotationMatrix * cache.simplex[i].GetB() + bTr.position);
+        points[i] = simplex[i];
+    }
+
+    // Początek układu leży wewnątrz, jeżeli zastąpienie nim dowolnego wierzchołka nie zmienia znaku objętości.
+    rvec3 origin(0);
+    real volume = SignedVolume(points[0], points[1], points[2], points[3]);
+    if (volume == 0 || (volume > 0) != cache.positiveVolume)
+        return false;
+
+    return
+        SignedVolume(origin, points[1], points[2], points[3]) * volume > 0 &&
+        SignedVolume(points[0], origin, points[2], points[3]) * volume > 0 &&
+        SignedVolume(points[0], points[1], origin, points[3]) * volume > 0 &&
+        SignedVolume(points[0], points[1], points[2], origin) * volume > 0;
+}
+
+/// @brief Wektor trzech składowych, każda dla SimdReal::width par naraz.
+struct SimdVec3
+{
+    SimdReal x, y, z;
+
+    SimdVec3() {}
+    SimdVec3(SimdReal x, SimdReal y, SimdReal z) :x(x), y(y), z(z) {}
+
+    friend SimdVec3 operator+(const SimdVec3& a, const SimdVec3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+    friend SimdVec3 operator-(const SimdVec3& a, const SimdVec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+    friend SimdVec3 operator-(const SimdVec3& a) { return { -a.x, -a.y, -a.z }; }
+    friend SimdVec3 operator*(const SimdVec3& a, SimdReal s) { return { a.x * s, a.y * s, a.z * s }; }
+    friend SimdReal Dot(const SimdVec3& a, const SimdVec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    friend SimdVec3 Cross(const SimdVec3& a, const SimdVec3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+    friend SimdVec3 Normalize(const SimdVec3& a) { return a * (SimdReal(1) / Sqrt(Dot(a, a))); }
+    friend SimdVec3 Select(SimdMask mask, const SimdVec3& a, const SimdVec3& b) { return { Select(mask, a.x, b.x), Select(mask, a.y, b.y), Select(mask, a.z, b.z) }; }
+    friend SimdMask IsVectorZero(const SimdVec3& v, real e) { return (Abs(v.x) < SimdReal(e)) & (Abs(v.y) < SimdReal(e)) & (Abs(v.z) < SimdReal(e)); }
+};
+
+/// @brief Obiekty kolizji jednej strony SimdReal::width par, stan z ColliderManager::poses w układzie struktury tablic.
+struct SimdColliders
+{
+    SimdVec3 position;
+    /// @brief Kolumny macierzy obrotu.
+    SimdVec3 axes[3];
+    /// @brief Połowy wymiarów prostopadłościanu, dla kuli promień w każdej składowej.
+    SimdVec3 size;
+    SimdMask sphere;
+
+    SimdColliders(const Collider* const* colliders)
+    {
+        constexpr size_t width = SimdReal::width;
+        alignas(SimdReal::alignment) real data[16][width];
+        for (size_t i = 0; i < width; i++)
+        {
+            const Collider& collider = *colliders[i];
+            const ColliderPose& pose = ColliderManager::GetPose(collider);
+            bool isSphere = collider.type == Collider::Type::Sphere;
+            for (int k = 0; k < 3; k++)
+            {
+                data[k][i] = pose.position[k];
+                data[3 + k][i] = pose.rotationMatrix[0][k];
+                data[6 + k][i] = pose.rotationMatrix[1][k];
+                data[9 + k][i] = pose.rotationMatrix[2][k];
+                data[12 + k][i] = isSphere ? collider.radius : collider.size[k];
+            }
+            data[15][i] = isSphere;
+        }
+
+        auto load = [&](int row) { return SimdVec3(SimdReal::Load(data[row]), SimdReal::Load(data[row + 1]), SimdReal::Load(data[row + 2])); };
+        position = load(0);
+        axes[0] = load(3);
+        axes[1] = load(6);
+        axes[2] = load(9);
+        size = load(12);
+        sphere = SimdReal::Load(data[15]) != SimdReal(0);
+    }
+
+    /// @brief Punkty najdalej w kierunkach @p direction w układzie świata, jak ColliderPose::SupportMapping.
+    SimdVec3 SupportMapping(const SimdVec3& direction) const
+    {
+        SimdVec3 local(Dot(axes[0], direction), Dot(axes[1], direction), Dot(axes[2], direction));
+        SimdReal zero(0);
+        SimdVec3 box(Select(local.x > zero, size.x, -size.x), Select(local.y > zero, size.y, -size.y), Select(local.z > zero, size.z, -size.z));
+        SimdVec3 point = Select(sphere, local * (size.x / Sqrt(Dot(local, local))), box);
+        return axes[0] * point.x + axes[1] * point.y + axes[2] * point.z + position;
+    }
+};
+
+uint32_t ColliderManager::GJKBatch(const CollisionPair* pairs, uint32_t count, GJKCache* const* caches)
+{
+    using V = SimdReal;
+    constexpr uint32_t width = V::width;
+
+    // Puste linie powtarzają pierwszą parę i od początku są nieaktywne.
+    const Collider* aColliders[width];
+    const Collider* bColliders[width];
+    alignas(V::alignment) real cachedAxis[4][width];
+    alignas(V::alignment) real used[width];
+    for (uint32_t i = 0; i < width; i++)
+    {
+        const CollisionPair& pair = pairs[i < count ? i : 0];
+        aColliders[i] = &components[pair.a];
+        bColliders[i] = &components[pair.b];
+
+        const GJKCache* cache = caches && i < count ? caches[i] : nullptr;
+        bool cached = cache && cache->state == GJKCache::State::Separated;
+        for (int k = 0; k < 3; k++)
+            cachedAxis[k][i] = cached ? cache->separatingAxis[k] : 0;
+        cachedAxis[3][i] = cached;
+        used[i] = i < count;
+    }
+
+    SimdColliders a(aColliders);
+    SimdColliders b(bColliders);
+
+    SimdMask active = V::Load(used) != V(0);
+    uint32_t separated = 0;
+    uint32_t supportEvaluations = 0;
+    SimdVec3 separatingAxis(0, 0, 0);
+
+    auto support = [&](const SimdVec3& n, SimdMask lanes) {
+        supportEvaluations += std::popcount(lanes.Bits());
+        return b.SupportMapping(n) - a.SupportMapping(-n);
+        };
+    // Linie, w których punkt w kierunku n nie przekracza początku układu, mają oś rozdzielającą n.
+    auto separate = [&](SimdMask found, const SimdVec3& n) {
+        found = active & found;
+        separatingAxis = Select(found, n, separatingAxis);
+        separated |= found.Bits();
+        active = AndNot(active, found);
+        return active.Any();
+        };
+    auto finish = [&]() {
+        alignas(V::alignment) real axis[3][width];
+        separatingAxis.x.Store(axis[0]);
+        separatingAxis.y.Store(axis[1]);
+        separatingAxis.z.Store(axis[2]);
+        for (uint32_t i = 0; caches && i < count; i++)
+        {
+            if (caches[i] && (separated >> i & 1))
+            {
+                caches[i]->separatingAxis = rvec3(axis[0][i], axis[1][i], axis[2][i]);
+                caches[i]->state = GJKCache::State::Separated;
+            }
+        }
+        gjkStatistics.calls.fetch_add(count, std::memory_order_relaxed);
+        gjkStatistics.supportEvaluations.fetch_add(supportEvaluations, std::memory_order_relaxed);
+        return separated;
+        };
+
+    // Pierwszy kierunek to zapamiętana oś rozdzielająca lub kierunek od różnicy środków do początku układu.
+    SimdVec3 s0 = b.position - a.position;
+    SimdMask useCachedAxis = V::Load(cachedAxis[3]) != V(0);
+    SimdVec3 n = Select(IsVectorZero(s0, 0.000000001), SimdVec3(0, 0, 1), Normalize(-s0));
+    n = Select(useCachedAxis, SimdVec3(V::Load(cachedAxis[0]), V::Load(cachedAxis[1]), V::Load(cachedAxis[2])), n);
+    SimdVec3 s1 = support(n, active);
+    SimdMask before = active;
+    bool running = separate(Dot(s1, n) < V(0), n);
+    gjkStatistics.cacheHits.fetch_add(std::popcount((AndNot(before, active) & useCachedAxis).Bits()), std::memory_order_relaxed);
+    if (!running)
+        return finish();
+
+    n = Normalize(-s1);
+    SimdVec3 s2 = support(n, active);
+    SimdMask collinear = active & IsVectorZero(Cross(s1 - s0, s2 - s0), 0.000000001);
+    if (collinear.Any())
+    {
+        SimdVec3 m = Normalize(Cross(-s0, -s1 + SimdVec3(s1.y, s1.z, s1.x)));
+        n = Select(collinear, m, n);
+        s2 = Select(collinear, support(m, collinear), s2);
+    }
+    if (!separate(Dot(s2, n) < V(0), n))
+        return finish();
+
+    // Trójkąt s0, s1, s2 z normalną skierowaną do początku układu, tak jak w GJK zamieniane są s0 i s1.
+    n = Cross(s1 - s0, s2 - s0);
+    SimdMask flip = Dot(n, s0) > V(0);
+    SimdVec3 swapped = s0;
+    s0 = Select(flip, s1, s0);
+    s1 = Select(flip, swapped, s1);
+    n = Normalize(Select(flip, Cross(s1 - s0, s2 - s0), n));
+    SimdVec3 s3 = support(n, active);
+    if (!separate(Dot(s3, n) <= V(0), n))
+        return finish();
+
+    // Czworościan to trójkąt pa, pb, pc z normalną skierowaną do ostatniego punktu pd, sprawdzane są trzy ściany zawierające pd
+    // z normalnymi na zewnątrz. Pierwsza ściana, za którą jest początek układu, staje się trójkątem, a nowy punkt w kierunku jej normalnej pd.
+    SimdVec3 pa = s0, pb = s1, pc = s2, pd = s3;
+    for (int i = 0; i < 64; i++)
+    {
+        SimdVec3 nABD = Cross(pb - pa, pd - pa);
+        SimdVec3 nBCD = Cross(pc - pb, pd - pb);
+        SimdVec3 nCAD = Cross(pa - pc, pd - pc);
+        SimdMask outsideABD = Dot(nABD, pd) < V(0);
+        SimdMask outsideBCD = AndNot(Dot(nBCD, pd) < V(0), outsideABD);
+        SimdMask outsideCAD = AndNot(AndNot(Dot(nCAD, pd) < V(0), outsideABD), outsideBCD);
+
+        // Początek układu wewnątrz czworościanu, para jest w kolizji.
+        active = active & (outsideABD | outsideBCD | outsideCAD);
+        if (!active.Any())
+            break;
+
+        n = Normalize(Select(outsideABD, nABD, Select(outsideBCD, nBCD, nCAD)));
+        SimdVec3 newA = Select(outsideABD, pa, Select(outsideBCD, pb, pc));
+        SimdVec3 newB = Select(outsideABD, pb, Select(outsideBCD, pc, pa));
+        pa = newA;
+        pb = newB;
+        pc = pd;
+        pd = support(n, active);
+        if (!separate(Dot(pd, n) < V(0), n))
+            break;
+    }
+
+    return finish();
+}
+
+ColliderManager::ContactTest ColliderManager::ClassifyPair(const Collider& a, const Collider& b, const GJKCache* cache)
+{
+    if (a.GetComponent<RigidBody>().inverseMass == 0 && b.GetComponent<RigidBody>().inverseMass == 0)
+        return ContactTest::Separated;
+
+    const ColliderPose& aTr = GetPose(a);
+    const ColliderPose& bTr = GetPose(b);
+
+    rvec3 distance = bTr.position - aTr.position;
+    if (glm::dot(distance, distance) >= pow(a.boundingSphereRadius + b.boundingSphereRadius, 2))
+        return ContactTest::Separated;
+
+    // Kula opisana na prostopadłościanie jest dużo większa od niego, prostopadłościany otaczające odrzucają więcej par.
+    if (!aTr.box.Overlaps(bTr.box))
+        return ContactTest::Separated;
+
+    // Testy analityczne odrzucają rozdzielone prostopadłościany taniej niż GJKBatch, a zapamiętany wynik GJK jest sprawdzany jednym
+    // punktem funkcji wspomagającej lub simpleksem.
+    if ((a.type == Collider::Type::Sphere && b.type == Collider::Type::Sphere) || analyticContacts || (cache && cache->state != GJKCache::State::Empty))
+        return ContactTest::Contacts;
+
+    return ContactTest::Batch;
+}
+
+// Najbliższy początkowi układu punkt odcinka lub trójkąta z points, w points zostają tylko wierzchołki najmniejszej ściany, na której leży.
+// Podział na obszary wierzchołków, krawędzi i wnętrza trójkąta jak w "Real-Time Collision Detection" C. Ericsona, 5.1.5.
+static rvec3 ClosestOnSegment(rvec3* points, int* count)
+{
+    rvec3 ab = points[1] - points[0];
+    real t = -glm::dot(points[0], ab);
+    if (t <= 0)
+    {
+        *count = 1;
+        return points[0];
+    }
+
+    real length = glm::dot(ab, ab);
+    if (t >= length)
+    {
+        points[0] = points[1];
+        *count = 1;
+        return points[0];
+    }
+
+    return points[0] + ab * (t / length);
+}
+
+static rvec3 ClosestOnTriangle(rvec3* points, int* count)
+{
+    rvec3 a = points[0], b = points[1], c = points[2];
+    rvec3 ab = b - a;
+    rvec3 ac = c - a;
+
+    real d1 = -glm::dot(ab, a);
+    real d2 = -glm::dot(ac, a);
+    if (d1 <= 0 && d2 <= 0)
+    {
+        *count = 1;
+        return a;
+    }
+
+    real d3 = -glm::dot(ab, b);
+    real d4 = -glm::dot(ac, b);
+    if (d3 >= 0 && d4 <= d3)
+    {
+        points[0] = b;
+        *count = 1;
+        return b;
+    }
+
+    real vc = d1 * d4 - d3 * d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0)
+    {
+        *count = 2;
+        return a + ab * (d1 / (d1 - d3));
+    }
+
+    real d5 = -glm::dot(ab, c);
+    real d6 = -glm::dot(ac, c);
+    if (d6 >= 0 && d5 <= d6)
+    {
+        points[0] = c;
+        *count = 1;
+        return c;
+    }
+
+    real vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0)
+    {
+        points[1] = c;
+        *count = 2;
+        return a + ac * (d2 / (d2 - d6));
+    }
+
+    real va = d3 * d6 - d5 * d4;
+    if (va <= 0 && d4 - d3 >= 0 && d5 - d6 >= 0)
+    {
+        points[0] = b;
+        points[1] = c;
+        *count = 2;
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+
+    real denominator = 1 / (va + vb + vc);
+    return a + ab * (vb * denominator) + ac * (vc * denominator);
+}
+
+// Dla czworościanu sprawdzane są ściany, po których zewnętrznej stronie leży początek układu, jeżeli nie ma żadnej, zawiera go czworościan.
+static rvec3 ClosestOnSimplex(rvec3* points, int* count)
+{
+    if (*count == 1)
+        return points[0];
+    if (*count == 2)
+        return ClosestOnSegment(points, count);
+    if (*count == 3)
+        return ClosestOnTriangle(points, count);
+
+    static constexpr int faces[4][4] = { { 0, 1, 2, 3 }, { 0, 2, 3, 1 }, { 0, 3, 1, 2 }, { 1, 3, 2, 0 } };
+    rvec3 closest = { 0, 0, 0 };
+    real closestDistance = std::numeric_limits<real>::infinity();
+    rvec3 closestFace[3];
+    int closestCount = 4;
+    for (auto& face : faces)
+    {
+        rvec3 normal = glm::cross(points[face[1]] - points[face[0]], points[face[2]] - points[face[0]]);
+        if (glm::dot(normal, -points[face[0]]) * glm::dot(normal, points[face[3]] - points[face[0]]) > 0)
+            continue;
+
+        rvec3 facePoints[3] = { points[face[0]], points[face[1]], points[face[2]] };
+        int faceCount = 3;
+        rvec3 point = ClosestOnTriangle(facePoints, &faceCount);
+        real distance = glm::dot(point, point);
+        if (distance < closestDistance)
+        {
+            closest = point;
+            closestDistance = distance;
+            closestCount = faceCount;
+            std::copy(facePoints, facePoints + faceCount, closestFace);
+        }
+    }
+
+    *count = closestCount;
+    if (closestCount < 4)
+        std::copy(closestFace, closestFace + closestCount, points);
+    return closest;
+}
+
+real ColliderManager::GetDistance(const Collider& a, const ColliderPose& aPose, const Collider& b, const ColliderPose& bPose, rvec3* normal)
+{
+    static constexpr real relativeTolerance = 0.0001;
+
+    // v to najbliższy początkowi układu punkt simpleksu na różnicy Minkowskiego b - a, zaczynając od różnicy środków.
+    rvec3 points[4];
+    int count = 0;
+    rvec3 v = bPose.position - aPose.position;
+    for (int iteration = 0; iteration < 64; iteration++)
+    {
+        real lengthSquared = glm::dot(v, v);
+        if (lengthSquared < 0.000000000001)
+            return 0;
+
+        // Płaszczyzna prostopadła do v przez najdalszy punkt w kierunku -v ogranicza odległość z dołu, gdy jest blisko v algorytm kończy.
+        rvec3 w = bPose.SupportMapping(b, -v) - aPose.SupportMapping(a, v);
+        real lowerBound = glm::dot(v, w);
+        if (lengthSquared - lowerBound <= relativeTolerance * lengthSquared)
+        {
+            *normal = v / sqrt(lengthSquared);
+            return std::max<real>(lowerBound, 0) / sqrt(lengthSquared);
+        }
+
+        points[count++] = w;
+        v = ClosestOnSimplex(points, &count);
+        if (count == 4)
+            return 0;
+    }
+
+    real length = glm::length(v);
+    *normal = v / length;
+    return std::max<real>(glm::dot(v, bPose.SupportMapping(b, -v) - aPose.SupportMapping(a, v)), 0) / length;
+}
+
+bool ColliderManager::TimeOfImpact(const Collider& a, const ColliderMotion& aMotion, const Collider& b, const ColliderMotion& bMotion,
+    real maxTime, real tolerance, real* time, rvec3* normal)
+{
+    real angularBound = glm::length(aMotion.angularVelocity) * a.boundingSphereRadius + glm::length(bMotion.angularVelocity) * b.boundingSphereRadius;
+    rvec3 relativeVelocity = aMotion.velocity - bMotion.velocity;
+
+    real t = 0;
+    for (int iteration = 0; iteration < 32; iteration++)
+    {
+        real distance = GetDistance(a, aMotion.At(a, t), b, bMotion.At(b, t), normal);
+        if (distance == 0)
+        {
+            // Obiekty w kolizji na początku kroku obsługuje zwykła faza wąska.
+            if (t == 0)
+                return false;
+            break;
+        }
+
+        if (distance <= tolerance)
+            break;
+
+        real approachSpeed = glm::dot(relativeVelocity, *normal) + angularBound;
+        if (approachSpeed <= 0)
+            return false;
+
+        t += distance / approachSpeed;
+        if (t >= maxTime)
+            return false;
+    }
+
+    *time = t;
+    return true;
+}
+
 struct EPATriangle
 {
-    dvec3 normal;
-    double distance;
+    rvec3 normal;
+    real distance;
     short indices[3];
 
-    EPATriangle(Support* polytope, const short(&indices)[3])
+    EPATriangle() {}
+    EPATriangle(const Support* polytope, const short(&indices)[3])
         : indices{ indices[0],indices[1],indices[2] }
     {
-        dvec3 a = polytope[indices[0]];
-        dvec3 b = polytope[indices[1]];
-        dvec3 c = polytope[indices[2]];
-        dvec3 u = a - b;
-        dvec3 v = a - c;
+        rvec3 a = polytope[indices[0]];
+        rvec3 b = polytope[indices[1]];
+        rvec3 c = polytope[indices[2]];
+        rvec3 u = a - b;
+        rvec3 v = a - c;
 
         if (IsVectorZero(u, 0.000000001))
-            u = dvec3(0.0000001, 0.0, 0.0);
+            u = rvec3(0.0000001, 0.0, 0.0);
 
         normal = glm::cross(u, v);
         if (IsVectorZero(normal, 0.000000001))
@@ -131,16 +671,16 @@ struct EPATriangle
         return distance < rhs.distance;
     }
 
-    dvec3 GetBarycentricCoordinates(Support* polytope, dvec3 p)
+    rvec3 GetBarycentricCoordinates(const Support* polytope, rvec3 p) const
     {
-        dvec3 r1 = polytope[indices[0]];
-        dvec3 r2 = polytope[indices[1]];
-        dvec3 r3 = polytope[indices[2]];
+        rvec3 r1 = polytope[indices[0]];
+        rvec3 r2 = polytope[indices[1]];
+        rvec3 r3 = polytope[indices[2]];
 
-        double t = glm::dot(glm::cross(r1 - r3, r2 - r3), normal);
+        real t = glm::dot(glm::cross(r1 - r3, r2 - r3), normal);
 
-        dvec3 barycentricCoordinates;
-        if (-std::numeric_limits<double>::epsilon() <= t && t <= std::numeric_limits<double>::epsilon())
+        rvec3 barycentricCoordinates;
+        if (-std::numeric_limits<real>::epsilon() <= t && t <= std::numeric_limits<real>::epsilon())
         {
             barycentricCoordinates.x = 0;
             barycentricCoordinates.y = 0;
@@ -157,134 +697,729 @@ struct EPATriangle
     }
 };
 
-void ColliderManager::EPA(const Collider& a, const Collider& b, std::vector<Support>& polytope, dvec3* normal, double* depth, dvec3* p1, dvec3* p2)
+/// @brief Kopiec minimalny trójkątów politopu według odległości od początku układu współrzędnych.
+/// @details Przechowuje pozycję każdego trójkąta w kopcu, dzięki czemu usunięcie dowolnego trójkąta jest logarytmiczne.
+template <int Capacity>
+class EPATriangleHeap
 {
+    const EPATriangle* triangles;
+    short heap[Capacity];
+    short positions[Capacity];
+    int size;
+
+public:
+    EPATriangleHeap(const EPATriangle* triangles) :triangles(triangles), size(0) {}
+
+    bool Empty() const { return size == 0; }
+    short Top() const { return heap[0]; }
+
+    void Push(short triangle)
+    {
+        heap[size] = triangle;
+        positions[triangle] = size;
+        SiftUp(size++);
+    }
+
+    void Remove(short triangle)
+    {
+        int position = positions[triangle];
+        size--;
+        if (position == size)
+            return;
+
+        Set(position, heap[size]);
+        SiftUp(position);
+        SiftDown(positions[heap[position]]);
+    }
+
+private:
+    bool Less(int i, int j) const { return triangles[heap[i]].distance < triangles[heap[j]].distance; }
+
+    void Set(int position, short triangle)
+    {
+        heap[position] = triangle;
+        positions[triangle] = position;
+    }
+
+    void Swap(int i, int j)
+    {
+        short triangle = heap[i];
+        Set(i, heap[j]);
+        Set(j, triangle);
+    }
+
+    void SiftUp(int i)
+    {
+        while (i > 0 && Less(i, (i - 1) / 2))
+        {
+            Swap(i, (i - 1) / 2);
+            i = (i - 1) / 2;
+        }
+    }
+
+    void SiftDown(int i)
+    {
+        while (true)
+        {
+            int smallest = i;
+            if (2 * i + 1 < size && Less(2 * i + 1, smallest))
+                smallest = 2 * i + 1;
+            if (2 * i + 2 < size && Less(2 * i + 2, smallest))
+                smallest = 2 * i + 2;
+            if (smallest == i)
+                return;
+
+            Swap(i, smallest);
+            i = smallest;
+        }
+    }
+};
+
+void ColliderManager::EPA(const Collider& a, const Collider& b, const Support* simplex, rvec3* normal, real* depth, rvec3* p1, rvec3* p2)
+{
+    PROFILE_ZONE("ColliderManager::EPA");
+    // Cała pamięć jest na stosie, każda iteracja dodaje jeden punkt, a politop wypukły o n punktach ma najwyżej 2n - 4 trójkątów.
+    constexpr int maxIterations = 64;
+    constexpr int maxPoints = maxIterations + 4;
+    constexpr int maxTriangles = 2 * maxPoints;
+    constexpr int maxEdges = 3 * maxTriangles;
+
+    Support polytope[maxPoints];
+    EPATriangle triangles[maxTriangles];
+    short freeTriangles[maxTriangles];
+    short edges[maxEdges][2];
+    EPATriangleHeap<maxTriangles> heap(triangles);
+
+    int pointCount = 4;
+    std::copy(simplex, simplex + 4, polytope);
+
+    int freeTriangleCount = 0;
+    for (short i = maxTriangles - 1; i >= 0; i--)
+        freeTriangles[freeTriangleCount++] = i;
+
+    // Zwolnione miejsca są używane ponownie w pierwszej kolejności, więc trójkąty zajmują początek tablicy.
+    bool alive[maxTriangles] = {};
+    short usedTriangles = 0;
+    auto addTriangle = [&](short i0, short i1, short i2) {
+        short triangle = freeTriangles[--freeTriangleCount];
+        triangles[triangle] = EPATriangle(polytope, { i0, i1, i2 });
+        alive[triangle] = true;
+        usedTriangles = std::max<short>(usedTriangles, triangle + 1);
+        heap.Push(triangle);
+        };
+
     // Na początku politop składa się z 4 punktów,
     // dodaj wszystkie trójkaty tetrahedronu do listy.
-    std::vector<EPATriangle> triangles;
-    triangles.push_back(EPATriangle(polytope.data(), { 0, 2, 1 }));
-    triangles.push_back(EPATriangle(polytope.data(), { 1, 3, 0 }));
-    triangles.push_back(EPATriangle(polytope.data(), { 2, 0, 3 }));
-    triangles.push_back(EPATriangle(polytope.data(), { 3, 1, 2 }));
+    addTriangle(0, 2, 1);
+    addTriangle(1, 3, 0);
+    addTriangle(2, 0, 3);
+    addTriangle(3, 1, 2);
 
-    EPATriangle* closestTriangle = nullptr;
-    for (int i = 0; i < 64; i++)
+    for (int i = 0; i < maxIterations; i++)
     {
-        closestTriangle = &std::min_element(triangles.begin(), triangles.end())[0];
+        const EPATriangle& closestTriangle = triangles[heap.Top()];
 
         // Znajdź nowy punkt na różnicy minkowskiego,
         // Jeżeli jest dostatecznie blisko akutalnego punktu,
         // to przyjmujemy, że jest na powieszchni orginalnego krztałtu i kończymi pętle.
-        Support newSupport = Support(a, b, closestTriangle->normal);
-        double newDistance = glm::dot(closestTriangle->normal, (dvec3) newSupport);
-        if (newDistance - closestTriangle->distance <= 0.00001)
+        Support newSupport = Support(a, b, closestTriangle.normal);
+        real newDistance = glm::dot(closestTriangle.normal, (rvec3) newSupport);
+        if (newDistance - closestTriangle.distance <= epaTolerance || pointCount == maxPoints)
             break;
 
-        polytope.push_back(newSupport);
-
         // Zapewnij że politop jest wypukły,
-        // poprzez usunięcie wszystkich punktów widocznych z nowego punktu.
-        std::set<std::tuple<short, short>> uniqueEdges;
-        for (int j = triangles.size() - 1; j >= 0; j--)
+        // poprzez usunięcie wszystkich trójkątów widocznych z nowego punktu.
+        // Krawędzie usuwanych trójkątów, które nie są wspólne z innym usuwanym trójkątem tworzą horyzont.
+        short visible[maxTriangles];
+        int visibleCount = 0;
+        int edgeCount = 0;
+        bool overflow = false;
+        for (short j = 0; j < usedTriangles && !overflow; j++)
         {
             // Czy trójkąt jest widoczny z nowego punktu.
+            if (!alive[j])
+                continue;
+
             auto& entry = triangles[j];
-            if (glm::dot(entry.normal, (dvec3) polytope[entry.indices[0]]) - glm::dot(entry.normal, (dvec3) newSupport) <= std::numeric_limits<double>::epsilon())
+            if (glm::dot(entry.normal, (rvec3) polytope[entry.indices[0]]) - glm::dot(entry.normal, (rvec3) newSupport) > std::numeric_limits<real>::epsilon())
+                continue;
+
+            visible[visibleCount++] = j;
+            for (int k = 0; k < 3; k++)
             {
-                for (int k = 0; k < 3; k++)
+                short aIndex = entry.indices[k];
+                short bIndex = entry.indices[(k + 1) % 3];
+
+                int e = 0;
+                while (e < edgeCount && !(edges[e][0] == bIndex && edges[e][1] == aIndex))
+                    e++;
+
+                if (e < edgeCount)
                 {
-                    short aIndex = triangles[j].indices[k];
-                    short bIndex = triangles[j].indices[(k + 1) % 3];
-                    if (uniqueEdges.contains({ bIndex,aIndex }))
-                        uniqueEdges.erase({ bIndex,aIndex });
-                    else
-                        uniqueEdges.insert({ aIndex,bIndex });
+                    edges[e][0] = edges[edgeCount - 1][0];
+                    edges[e][1] = edges[edgeCount - 1][1];
+                    edgeCount--;
                 }
-
-                triangles[j] = triangles[triangles.size() - 1];
-                triangles.pop_back();
+                else if (edgeCount < maxEdges)
+                {
+                    edges[edgeCount][0] = aIndex;
+                    edges[edgeCount][1] = bIndex;
+                    edgeCount++;
+                }
+                else
+                    overflow = true;
             }
         }
+
+        // Brak miejsca na nowe trójkąty lub zdegenerowany horyzont, wynikiem jest dotychczasowy politop.
+        if (overflow || edgeCount == 0 || edgeCount > freeTriangleCount + visibleCount)
+            break;
+
+        for (int j = 0; j < visibleCount; j++)
+        {
+            alive[visible[j]] = false;
+            heap.Remove(visible[j]);
+            freeTriangles[freeTriangleCount++] = visible[j];
+        }
+
         // Połącz wszystkie wolne krawędzie z nowym punktem.
-        for (auto [edge1, edge2] : uniqueEdges)
-            triangles.push_back(EPATriangle(polytope.data(), { edge1,edge2,short(polytope.size() - 1) }));
+        polytope[pointCount++] = newSupport;
+        for (int e = 0; e < edgeCount; e++)
+            addTriangle(edges[e][0], edges[e][1], short(pointCount - 1));
     }
 
-    if (closestTriangle)
+    EPATriangle& closestTriangle = triangles[heap.Top()];
+    *normal = -closestTriangle.normal;
+    *depth = closestTriangle.distance;
+
+    rvec3 p = closestTriangle.distance * closestTriangle.normal;
+    rvec3 barycentricCoordinates = closestTriangle.GetBarycentricCoordinates(polytope, p);
+    *p1 =
+        barycentricCoordinates.x * polytope[closestTriangle.indices[0]].GetA() +
+        barycentricCoordinates.y * polytope[closestTriangle.indices[1]].GetA() +
+        barycentricCoordinates.z * polytope[closestTriangle.indices[2]].GetA();
+    *p2 =
+        barycentricCoordinates.x * polytope[closestTriangle.indices[0]].GetB() +
+        barycentricCoordinates.y * polytope[closestTriangle.indices[1]].GetB() +
+        barycentricCoordinates.z * polytope[closestTriangle.indices[2]].GetB();
+}
+
+bool ColliderManager::GetSphereBoxContacts(const Collider& a, const Collider& b, ContactManifold* manifold)
+{
+    bool sphereIsA = a.type == Collider::Type::Sphere;
+    const Collider& sphere = sphereIsA ? a : b;
+    const Collider& box = sphereIsA ? b : a;
+    const ColliderPose& sphereTr = GetPose(sphere);
+    const ColliderPose& boxTr = GetPose(box);
+
+    // Środek kuli w układzie prostopadłościanu i najbliższy mu punkt prostopadłościanu.
+    rvec3 center = boxTr.inverseRotationMatrix * (sphereTr.position - boxTr.position);
+    rvec3 closest = glm::clamp(center, -box.size, box.size);
+    rvec3 offset = center - closest;
+    real sqrDist = glm::dot(offset, offset);
+
+    // Normalna w układzie prostopadłościanu, skierowana od kuli do prostopadłościanu.
+    rvec3 normal;
+    real depth;
+    if (sqrDist > 0)
     {
-        *normal = -closestTriangle->normal;
-        *depth = closestTriangle->distance;
+        if (sqrDist >= sphere.radius * sphere.radius)
+            return false;
 
-        dvec3 p = closestTriangle->distance * closestTriangle->normal;
-        dvec3 barycentricCoordinates = closestTriangle->GetBarycentricCoordinates(polytope.data(), p);
-        *p1 =
-            barycentricCoordinates.x * polytope[closestTriangle->indices[0]].GetA() +
-            barycentricCoordinates.y * polytope[closestTriangle->indices[1]].GetA() +
-            barycentricCoordinates.z * polytope[closestTriangle->indices[2]].GetA();
-        *p2 =
-            barycentricCoordinates.x * polytope[closestTriangle->indices[0]].GetB() +
-            barycentricCoordinates.y * polytope[closestTriangle->indices[1]].GetB() +
-            barycentricCoordinates.z * polytope[closestTriangle->indices[2]].GetB();
+        real dist = sqrt(sqrDist);
+        normal = -offset / dist;
+        depth = sphere.radius - dist;
     }
+    else
+    {
+        // Środek kuli wewnątrz prostopadłościanu, wypychany jest przez najbliższą ścianę.
+        rvec3 faceDistances = box.size - glm::abs(center);
+        int axis = faceDistances.x < faceDistances.y ? (faceDistances.x < faceDistances.z ? 0 : 2) : (faceDistances.y < faceDistances.z ? 1 : 2);
+        real side = center[axis] < 0 ? -1.0 : 1.0;
+        normal = rvec3(0);
+        normal[axis] = -side;
+        closest[axis] = side * box.size[axis];
+        depth = faceDistances[axis] + sphere.radius;
+    }
+
+    normal = boxTr.rotationMatrix * normal;
+    rvec3 spherePoint = sphereTr.position + normal * sphere.radius;
+    rvec3 boxPoint = boxTr.rotationMatrix * closest + boxTr.position;
+
+    if (!sphereIsA)
+        normal = -normal;
+
+    const ColliderPose& aTr = GetPose(a);
+    const ColliderPose& bTr = GetPose(b);
+    rvec3 p1 = aTr.inverseRotationMatrix * ((sphereIsA ? spherePoint : boxPoint) - aTr.position);
+    rvec3 p2 = bTr.inverseRotationMatrix * ((sphereIsA ? boxPoint : spherePoint) - bTr.position);
+
+    manifold->normal = normal;
+    manifold->AddPoint(p1, p2, depth, 0);
+    return true;
 }
 
-bool ColliderManager::GetPenetration(const Collider& a, const Collider& b, PenetrationConstraint* penetration)
+/// @brief Wierzchołek wielokąta przycinanego do ściany odniesienia.
+/// @details Wierzchołek jest identyfikowany przez krawędzie, które się w nim spotykają, 0-3 to krawędzie ściany incydentnej,
+/// a 4-7 płaszczyzny boczne ściany odniesienia. Identyfikator nie zmienia się, dopóki ten sam wierzchołek wynika z przycięcia.
+struct ClipVertex
 {
-    if (a.GetComponent<RigidBody>().inverseMass == 0 && b.GetComponent<RigidBody>().inverseMass == 0)
-        return false;
+    rvec3 position;
+    uint8_t inEdge;
+    uint8_t outEdge;
+};
+
+/// @brief Przycina wielokąt do półprzestrzeni dot(p, @p normal ) <= @p offset (algorytm Sutherlanda-Hodgmana).
+/// @param plane identyfikator płaszczyzny nadawany nowym krawędziom
+/// @return liczba wierzchołków w @p output , co najwyżej o jeden więcej niż w @p input
+static int ClipPolygon(const ClipVertex* input, int count, const rvec3& normal, real offset, uint8_t plane, ClipVertex* output)
+{
+    int outputCount = 0;
+    for (int i = 0; i < count; i++)
+    {
+        const ClipVertex& current = input[i];
+        const ClipVertex& next = input[(i + 1) % count];
+        real currentDistance = glm::dot(current.position, normal) - offset;
+        real nextDistance = glm::dot(next.position, normal) - offset;
+
+        if (currentDistance <= 0)
+            output[outputCount++] = current;
+
+        if ((currentDistance <= 0) != (nextDistance <= 0))
+        {
+            ClipVertex& vertex = output[outputCount++];
+            vertex.position = current.position + (next.position - current.position) * (currentDistance / (currentDistance - nextDistance));
+            vertex.inEdge = currentDistance <= 0 ? current.outEdge : plane;
+            vertex.outEdge = currentDistance <= 0 ? plane : current.outEdge;
+        }
+    }
 
-    auto&& aTr = a.GetComponent<Transform>();
-    auto&& bTr = b.GetComponent<Transform>();
+    return outputCount;
+}
 
-    dvec3 normal = bTr.position - aTr.position;
-    double sqrDist = glm::dot(normal, normal);
+/// @brief Wybiera 4 punkty, które najlepiej podtrzymują obiekt: najgłębszy, najdalszy od niego
+/// oraz dwa tworzące z nimi trójkąty o największym polu po obu stronach.
+/// @param positions punkty styku
+/// @param depths głębokości punktów
+/// @param count liczba punktów, więcej niż 4
+/// @param normal normalna kolizji
+/// @param selected wyjściowe indeksy wybranych punktów
+static void ReduceContacts(const rvec3* positions, const real* depths, int count, const rvec3& normal, int(&selected)[4])
+{
+    int first = 0;
+    for (int i = 1; i < count; i++)
+        if (depths[i] > depths[first])
+            first = i;
 
-    if (sqrDist >= pow(a.boundingSphereRadius + b.boundingSphereRadius, 2))
+    int second = first == 0 ? 1 : 0;
+    real maxDistance = -1;
+    for (int i = 0; i < count; i++)
     {
-        return false;
+        rvec3 offset = positions[i] - positions[first];
+        real distance = glm::dot(offset, offset);
+        if (i != first && distance > maxDistance)
+        {
+            maxDistance = distance;
+            second = i;
+        }
+    }
+
+    int third = -1, fourth = -1;
+    real maxArea = -std::numeric_limits<real>::infinity();
+    real minArea = std::numeric_limits<real>::infinity();
+    rvec3 edge = positions[second] - positions[first];
+    for (int i = 0; i < count; i++)
+    {
+        if (i == first || i == second)
+            continue;
+
+        real area = glm::dot(glm::cross(edge, positions[i] - positions[first]), normal);
+        if (area > maxArea)
+        {
+            maxArea = area;
+            third = i;
+        }
+        if (area < minArea)
+        {
+            minArea = area;
+            fourth = i;
+        }
+    }
+
+    // Wszystkie punkty mogą leżeć po jednej stronie, wtedy czwartym jest drugi co do wielkości trójkąt.
+    if (fourth == third)
+    {
+        minArea = std::numeric_limits<real>::infinity();
+        for (int i = 0; i < count; i++)
+        {
+            if (i == first || i == second || i == third)
+                continue;
+
+            real area = abs(glm::dot(glm::cross(edge, positions[i] - positions[first]), normal));
+            if (area < minArea)
+            {
+                minArea = area;
+                fourth = i;
+            }
+        }
+    }
+
+    selected[0] = first;
+    selected[1] = second;
+    selected[2] = third;
+    selected[3] = fourth;
+}
+
+/// @brief Punkty styku ściany prostopadłościanu odniesienia z najbardziej przeciwną jej ścianą prostopadłościanu incydentnego.
+/// @details Ściana incydentna jest przycinana do płaszczyzn bocznych ściany odniesienia, zostają wierzchołki leżące pod ścianą odniesienia,
+/// a jeżeli jest ich więcej niż 4, wybierane są te, które rozpinają największy obszar.
+/// @param normal normalna ściany odniesienia, skierowana do prostopadłościanu incydentnego
+/// @param positions wyjściowe punkty na ścianie incydentnej, co najmniej 4 miejsca
+/// @param depths wyjściowe głębokości punktów
+/// @param features wyjściowe identyfikatory cech punktów
+/// @return liczba punktów
+static int ClipIncidentFace(const rvec3& referencePosition, const rvec3(&referenceAxes)[3], const rvec3& referenceSize, int referenceAxis,
+    const rvec3& incidentPosition, const rvec3(&incidentAxes)[3], const rvec3& incidentSize, const rvec3& normal,
+    rvec3* positions, real* depths, uint32_t* features)
+{
+    // Ściana incydentna to ta, której normalna jest najbardziej przeciwna do normalnej ściany odniesienia.
+    int incidentAxis = 0;
+    real maxCosine = -1;
+    for (int i = 0; i < 3; i++)
+    {
+        real cosine = abs(glm::dot(incidentAxes[i], normal));
+        if (cosine > maxCosine)
+        {
+            maxCosine = cosine;
+            incidentAxis = i;
+        }
+    }
+    real incidentSide = glm::dot(incidentAxes[incidentAxis], normal) > 0 ? -1.0 : 1.0;
+    int iu = (incidentAxis + 1) % 3;
+    int iv = (incidentAxis + 2) % 3;
+    rvec3 faceCenter = incidentPosition + incidentAxes[incidentAxis] * (incidentSide * incidentSize[incidentAxis]);
+    rvec3 u = incidentAxes[iu] * incidentSize[iu];
+    rvec3 v = incidentAxes[iv] * incidentSize[iv];
+
+    ClipVertex polygon[8] = {
+        { faceCenter + u + v, 3, 0 },
+        { faceCenter - u + v, 0, 1 },
+        { faceCenter - u - v, 1, 2 },
+        { faceCenter + u - v, 2, 3 },
+    };
+    ClipVertex clipped[8];
+    int count = 4;
+
+    int ru = (referenceAxis + 1) % 3;
+    int rv = (referenceAxis + 2) % 3;
+    const int sideAxes[4] = { ru, ru, rv, rv };
+    for (int plane = 0; plane < 4 && count > 0; plane++)
+    {
+        real side = plane % 2 == 0 ? 1.0 : -1.0;
+        rvec3 sideNormal = referenceAxes[sideAxes[plane]] * side;
+        real offset = glm::dot(referencePosition, sideNormal) + referenceSize[sideAxes[plane]];
+        count = ClipPolygon(polygon, count, sideNormal, offset, 4 + plane, clipped);
+        std::copy(clipped, clipped + count, polygon);
     }
 
+    real referenceSide = glm::dot(referenceAxes[referenceAxis], normal) > 0 ? 1.0 : -1.0;
+    uint32_t faceFeature = (referenceAxis * 2 + (referenceSide > 0)) << 12 | (incidentAxis * 2 + (incidentSide > 0)) << 6;
+    real plane = glm::dot(referencePosition, normal) + referenceSize[referenceAxis];
+
+    rvec3 candidatePositions[8];
+    real candidateDepths[8];
+    uint32_t candidateFeatures[8];
+    int candidateCount = 0;
+    for (int i = 0; i < count; i++)
+    {
+        real depth = plane - glm::dot(polygon[i].position, normal);
+        if (depth < 0)
+            continue;
+
+        candidatePositions[candidateCount] = polygon[i].position;
+        candidateDepths[candidateCount] = depth;
+        candidateFeatures[candidateCount] = faceFeature | polygon[i].inEdge << 3 | polygon[i].outEdge;
+        candidateCount++;
+    }
+
+    if (candidateCount <= 4)
+    {
+        std::copy(candidatePositions, candidatePositions + candidateCount, positions);
+        std::copy(candidateDepths, candidateDepths + candidateCount, depths);
+        std::copy(candidateFeatures, candidateFeatures + candidateCount, features);
+        return candidateCount;
+    }
+
+    int selected[4];
+    ReduceContacts(candidatePositions, candidateDepths, candidateCount, normal, selected);
+    for (int i = 0; i < 4; i++)
+    {
+        positions[i] = candidatePositions[selected[i]];
+        depths[i] = candidateDepths[selected[i]];
+        features[i] = candidateFeatures[selected[i]];
+    }
+    return 4;
+}
+
+bool ColliderManager::GetBoxBoxContacts(const Collider& a, const Collider& b, ContactManifold* manifold)
+{
+    const ColliderPose& aTr = GetPose(a);
+    const ColliderPose& bTr = GetPose(b);
+    const rmat3& aRotation = aTr.rotationMatrix;
+    const rmat3& bRotation = bTr.rotationMatrix;
+    const rvec3 aAxes[3] = { aRotation[0], aRotation[1], aRotation[2] };
+    const rvec3 bAxes[3] = { bRotation[0], bRotation[1], bRotation[2] };
+    rvec3 d = bTr.position - aTr.position;
+
+    // Twierdzenie o osi rozdzielającej, sprawdzane są osie ścian obu prostopadłościanów oraz iloczyny wektorowe ich krawędzi.
+    // Wybierana jest oś o najmniejszym nachodzeniu, z preferencją dla ścian, które dają stabilniejszy punkt kolizji.
+    auto getOverlap = [&](const rvec3& axis, real* overlap, rvec3* normal) {
+        real aExtent = 0, bExtent = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            aExtent += abs(glm::dot(aAxes[i], axis)) * a.size[i];
+            bExtent += abs(glm::dot(bAxes[i], axis)) * b.size[i];
+        }
+        real distance = glm::dot(d, axis);
+        *overlap = aExtent + bExtent - abs(distance);
+        *normal = distance < 0 ? -axis : axis;
+        return *overlap >= 0;
+        };
+
+    const real relativeTolerance = 0.95;
+    const real absoluteTolerance = 0.00001;
+
+    real bestOverlap = std::numeric_limits<real>::infinity();
+    rvec3 bestNormal;
+    int bestAxis = -1;
+    for (int i = 0; i < 6; i++)
+    {
+        real overlap;
+        rvec3 normal;
+        if (!getOverlap(i < 3 ? aAxes[i] : bAxes[i - 3], &overlap, &normal))
+            return false;
+
+        if (overlap < bestOverlap * (i < 3 ? 1.0 : relativeTolerance) - (i < 3 ? 0.0 : absoluteTolerance))
+        {
+            bestOverlap = overlap;
+            bestNormal = normal;
+            bestAxis = i;
+        }
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            rvec3 axis = glm::cross(aAxes[i], bAxes[j]);
+            real length = glm::length(axis);
+            if (length < 0.000001)
+                continue;
+
+            real overlap;
+            rvec3 normal;
+            if (!getOverlap(axis / length, &overlap, &normal))
+                return false;
+
+            if (overlap < bestOverlap * relativeTolerance - absoluteTolerance)
+            {
+                bestOverlap = overlap;
+                bestNormal = normal;
+                bestAxis = 6 + i * 3 + j;
+            }
+        }
+    }
+
+    manifold->normal = bestNormal;
+
+    if (bestAxis < 6)
+    {
+        // Ściana-ściana lub ściana-wierzchołek, punkty z przycięcia ściany drugiego prostopadłościanu.
+        bool referenceIsA = bestAxis < 3;
+        rvec3 positions[4];
+        real depths[4];
+        uint32_t features[4];
+        int count = referenceIsA ?
+            ClipIncidentFace(aTr.position, aAxes, a.size, bestAxis, bTr.position, bAxes, b.size, bestNormal, positions, depths, features) :
+            ClipIncidentFace(bTr.position, bAxes, b.size, bestAxis - 3, aTr.position, aAxes, a.size, -bestNormal, positions, depths, features);
+
+        // Przy nachodzeniu prawie równym zero przycięcie może nie zostawić żadnego punktu.
+        if (count == 0)
+            return false;
+
+        for (int i = 0; i < count; i++)
+        {
+            rvec3 pointA = referenceIsA ? positions[i] + bestNormal * depths[i] : positions[i];
+            rvec3 pointB = referenceIsA ? positions[i] : positions[i] - bestNormal * depths[i];
+            manifold->AddPoint(aTr.inverseRotationMatrix * (pointA - aTr.position), bTr.inverseRotationMatrix * (pointB - bTr.position), depths[i], features[i]);
+        }
+        return true;
+    }
+
+    // Krawędź-krawędź, punkty kolizji to najbliższe punkty krawędzi najbardziej wysuniętych w kierunku drugiego obiektu.
+    int i = (bestAxis - 6) / 3;
+    int j = (bestAxis - 6) % 3;
+    rvec3 aEdge = aTr.position;
+    rvec3 bEdge = bTr.position;
+    for (int k = 0; k < 3; k++)
+    {
+        if (k != i)
+            aEdge += aAxes[k] * (glm::dot(aAxes[k], bestNormal) > 0 ? a.size[k] : -a.size[k]);
+        if (k != j)
+            bEdge += bAxes[k] * (glm::dot(bAxes[k], bestNormal) > 0 ? -b.size[k] : b.size[k]);
+    }
+
+    rvec3 r = aEdge - bEdge;
+    real cosine = glm::dot(aAxes[i], bAxes[j]);
+    real c = glm::dot(aAxes[i], r);
+    real f = glm::dot(bAxes[j], r);
+    real s = glm::clamp((cosine * f - c) / (1 - cosine * cosine), -a.size[i], a.size[i]);
+    real t = glm::clamp(cosine * s + f, -b.size[j], b.size[j]);
+    s = glm::clamp(cosine * t - c, -a.size[i], a.size[i]);
+
+    rvec3 pointA = aEdge + aAxes[i] * s;
+    rvec3 pointB = bEdge + bAxes[j] * t;
+
+    // Cechą punktu jest para krawędzi, identyfikatory poza zakresem ścian.
+    manifold->AddPoint(aTr.inverseRotationMatrix * (pointA - aTr.position), bTr.inverseRotationMatrix * (pointB - bTr.position), bestOverlap, (12 + bestAxis - 6) << 12);
+    return true;
+}
+
+bool ColliderManager::GetContacts(const Collider& a, const Collider& b, ContactManifold* manifold, GJKCache* cache)
+{
+    manifold->pointCount = 0;
+
+    if (ClassifyPair(a, b, nullptr) == ContactTest::Separated)
+        return false;
+
+    const ColliderPose& aTr = GetPose(a);
+    const ColliderPose& bTr = GetPose(b);
+
     if (a.type == Collider::Type::Sphere && b.type == Collider::Type::Sphere)
     {
-        double dist = sqrt(sqrDist);
-        double depth = (a.radius + b.radius) - dist;
+        rvec3 normal = bTr.position - aTr.position;
+        real dist = glm::length(normal);
+        real depth = (a.radius + b.radius) - dist;
         normal /= dist;
 
-        dvec3 p1 = normal * a.radius;
-        dvec3 p2 = -normal * b.radius;
+        rvec3 p1 = normal * a.radius;
+        rvec3 p2 = -normal * b.radius;
 
-        p1 = glm::inverse(aTr.rotation) * p1;
-        p2 = glm::inverse(bTr.rotation) * p2;
+        p1 = aTr.inverseRotationMatrix * p1;
+        p2 = bTr.inverseRotationMatrix * p2;
 
-        *penetration = PenetrationConstraint(a.GetComponent<RigidBody>(), b.GetComponent<RigidBody>(), p1, p2, normal, depth);
+        manifold->normal = normal;
+        manifold->AddPoint(p1, p2, depth, 0);
         return true;
     }
 
+    if (analyticContacts)
+    {
+        if (a.type == Collider::Type::Box && b.type == Collider::Type::Box)
+            return GetBoxBoxContacts(a, b, manifold);
+
+        return GetSphereBoxContacts(a, b, manifold);
+    }
+
     Support simplex[4];
-    if (GJK(a, b, simplex))
+    if (GJK(a, b, simplex, cache))
     {
-        dvec3 normal;
-        double depth;
-        dvec3 p1, p2;
-        std::vector<Support> polytope;
-        polytope.assign(&simplex[0], &simplex[0] + 4);
-        EPA(a, b, polytope, &normal, &depth, &p1, &p2);
+        rvec3 normal;
+        real depth;
+        rvec3 p1, p2;
+        EPA(a, b, simplex, &normal, &depth, &p1, &p2);
 
-        p1 = dquat(glm::inverse(aTr.rotation)) * (p1 - dvec3(aTr.position));
-        p2 = dquat(glm::inverse(bTr.rotation)) * (p2 - dvec3(bTr.position));
+        p1 = aTr.inverseRotationMatrix * (p1 - aTr.position);
+        p2 = bTr.inverseRotationMatrix * (p2 - bTr.position);
 
-        *penetration = PenetrationConstraint(a.GetComponent<RigidBody>(), b.GetComponent<RigidBody>(), p1, p2, normal, depth);
+        manifold->normal = normal;
+        manifold->AddPoint(p1, p2, depth, 0);
         return true;
     }
 
     return false;
 }
+
+bool ColliderManager::GetSpeculativeContact(const Collider& a, const Collider& b, real maxDistance, ContactManifold* manifold)
+{
+    manifold->pointCount = 0;
+
+    const ColliderPose& aTr = GetPose(a);
+    const ColliderPose& bTr = GetPose(b);
+    rvec3 normal;
+    real distance = GetDistance(a, aTr, b, bTr, &normal);
+    if (distance == 0 || distance >= maxDistance)
+        return false;
+
+    rvec3 p1 = aTr.SupportMapping(a, normal);
+    rvec3 p2 = bTr.SupportMapping(b, -normal);
+
+    // Prostopadłościan zbliżający się ścianą lub krawędzią dostaje punkt w środku wierzchołków bliższych niż maxDistance od płaszczyzny
+    // przez najbliższy punkt drugiego obiektu, których rzut leży w kuli opisanej na drugim obiekcie. Punkt w jednym wierzchołku zatrzymałby
+    // tylko ten wierzchołek, a obiekt by się obrócił, a kilka punktów w jednej iteracji solwera ogranicza prędkość środka słabiej niż jeden.
+    rvec3 pointA = { 0, 0, 0 };
+    rvec3 pointB = { 0, 0, 0 };
+    real depth = -maxDistance;
+    int count = 0;
+    auto addVertices = [&](const Collider& collider, const ColliderPose& pose, const rvec3& plane, real side, const Collider& other, const ColliderPose& otherPose) {
+        if (collider.type != Collider::Type::Box)
+            return;
+
+        for (int i = 0; i < 8; i++)
+        {
+            rvec3 vertex = pose.position + pose.rotationMatrix * (collider.size * rvec3(i & 1 ? 1 : -1, i & 2 ? 1 : -1, i & 4 ? 1 : -1));
+            real vertexDepth = side * glm::dot(vertex - plane, normal);
+            if (vertexDepth <= -maxDistance)
+                continue;
+
+            rvec3 projected = vertex - side * vertexDepth * normal;
+            if (glm::distance(projected, otherPose.position) > other.boundingSphereRadius)
+                continue;
+
+            pointA += side > 0 ? vertex : projected;
+            pointB += side > 0 ? projected : vertex;
+            depth = std::max(depth, vertexDepth);
+            count++;
+        }
+    };
+    addVertices(a, aTr, p2, 1, b, bTr);
+    addVertices(b, bTr, p1, -1, a, aTr);
+    if (count == 0)
+    {
+        pointA = p1;
+        pointB = p2;
+        depth = glm::dot(p1 - p2, normal);
+        count = 1;
+    }
+
+    manifold->normal = normal;
+    manifold->AddPoint(aTr.inverseRotationMatrix * (pointA / real(count) - aTr.position), bTr.inverseRotationMatrix * (pointB / real(count) - bTr.position), depth, 0);
+    return true;
+}
+
+bool ColliderManager::GetPenetration(const Collider& a, const Collider& b, PenetrationConstraint* penetration, GJKCache* cache)
+{
+    ContactManifold manifold;
+    if (!GetContacts(a, b, &manifold, cache))
+        return false;
+
+    int deepest = 0;
+    for (int i = 1; i < manifold.pointCount; i++)
+        if (manifold.points[i].depth > manifold.points[deepest].depth)
+            deepest = i;
+
+    const ContactPoint& point = manifold.points[deepest];
+    const RigidBody* bodies = ECS::System<RigidBody>::components.data();
+    *penetration = PenetrationConstraint(&a.GetComponent<RigidBody>() - bodies, &b.GetComponent<RigidBody>() - bodies, point.pointA, point.pointB, manifold.normal, point.depth);
+    return true;
+}
+
 std::vector<PenetrationConstraint> ColliderManager::GetPenetrations()
 {
     std::vector<PenetrationConstraint> penetrations;
-    for (int i = 0; i < components.size(); i++)
+    for (size_t i = 0; i < components.size(); i++)
     {
-        for (int j = i + 1; j < components.size(); j++)
+        for (size_t j = i + 1; j < components.size(); j++)
         {
             PenetrationConstraint penetration;
             if (GetPenetration(components[i], components[j], &penetration))
@@ -297,39 +1432,320 @@ std::vector<PenetrationConstraint> ColliderManager::GetPenetrations()
 
 std::vector<PenetrationConstraint> ColliderManager::GetPenetrations(Collider* collider, const std::vector<Collider*>& colliders)
 {
-    std::unordered_set<CollisionPair, CollisionPair::Hash> collisionPairs;
+    std::unordered_set<const Collider*> collidingWith;
     std::vector<PenetrationConstraint> penetrations;
-    for (int j = 0; j < colliders.size(); j++)
+    for (size_t j = 0; j < colliders.size(); j++)
     {
-        if (colliders[j] == collider || collisionPairs.contains({ colliders[j], collider }))
+        if (colliders[j] == collider || collidingWith.contains(colliders[j]))
             continue;
 
         PenetrationConstraint penetration;
         if (GetPenetration(*collider, *colliders[j], &penetration))
         {
             penetrations.emplace_back(std::move(penetration));
-            collisionPairs.insert({ colliders[j], collider });
+            collidingWith.insert(colliders[j]);
         }
     }
 
     return penetrations;
 }
 
-void ColliderManager::QuarryInRadius(Collider& a, double radiusMultiplier, std::unordered_set<CollisionPair, CollisionPair::Hash>* pairs)
+void ColliderManager::QuarryInRadius(const Collider& a, real radiusMultiplier, CollisionPairBuffer* pairs)
 {
-    double radius = a.boundingSphereRadius * radiusMultiplier;
-    dvec3 position = a.GetComponent<Transform>().position;
-    for (auto&& i : components)
+    PROFILE_ZONE("ColliderManager::QuarryInRadius");
+    uint32_t index = &a - components.data();
+    real radius = a.boundingSphereRadius * radiusMultiplier;
+    rvec3 position = poses[index].position;
+    for (uint32_t i = 0; i < components.size(); i++)
     {
-        if (&a == &i)
+        if (i == index)
             continue;
 
-        if (glm::dot(i.GetComponent<Transform>().position - position, i.GetComponent<Transform>().position - position) >= pow(radius + i.boundingSphereRadius, 2))
+        rvec3 d = poses[i].position - position;
+        if (glm::dot(d, d) >= pow(radius + components[i].boundingSphereRadius, 2))
             continue;
 
-        if (pairs->contains(CollisionPair{ &a,&i }) || pairs->contains(CollisionPair{ &i, &a }))
-            continue;
+        pairs->Add(index, i);
+    }
+}
+
+real ColliderManager::GetQueryRadius(const Collider& collider, real deltaT, bool sweptRadius)
+{
+    // Para jest zgłaszana, gdy kula któregokolwiek obiektu sięga drugiego, więc droga obu zbliżających się obiektów to najwyżej dwie drogi szybszego.
+    real speed = glm::length(collider.GetComponent<RigidBody>().velocity);
+    if (sweptRadius)
+        return collider.boundingSphereRadius + speed * deltaT * 2;
+
+    // Kula musi obejmować co najmniej drogę w kroku, inaczej małe szybkie obiekty nie trafiłyby do par sprawdzanych przez CCD.
+    return std::max(collider.boundingSphereRadius * (1 + speed * deltaT * 2), collider.boundingSphereRadius + speed * deltaT);
+}
 
-        pairs->insert(CollisionPair{ &a,&i });
+void ColliderManager::Add(Collider&)
+{
+    poses.resize(components.size());
+}
+
+void ColliderManager::Destroy(Collider& collider)
+{
+    // Usunięcie komponentu przenosi ostatni komponent na miejsce usuniętego, co zmienia indeksy w drzewie.
+    treeInvalid = true;
+    sweepAndPruneInvalid = true;
+    staticTreeInvalid = true;
+
+    poses[&collider - components.data()] = poses.back();
+    poses.pop_back();
+}
+
+ColliderPose::ColliderPose(const Collider& collider, const rvec3& position, const rquat& rotation)
+    :position(position), rotation(rotation), rotationMatrix(glm::mat3_cast(rotation)), inverseRotationMatrix(glm::transpose(rotationMatrix))
+{
+    // Połowa rozmiaru prostopadłościanu otaczającego to suma rzutów osi obróconego prostopadłościanu na osie układu.
+    rvec3 extent;
+    if (collider.type == Collider::Type::Box)
+        extent = rmat3(glm::abs(rotationMatrix[0]), glm::abs(rotationMatrix[1]), glm::abs(rotationMatrix[2])) * collider.size;
+    else
+        extent = rvec3(collider.radius);
+    box = AABB(position - extent, position + extent);
+}
+
+ColliderPose ColliderMotion::At(const Collider& collider, real time) const
+{
+    real angle = glm::length(angularVelocity) * time;
+    if (angle == 0)
+        return ColliderPose(collider, position + velocity * time, rotation);
+
+    return ColliderPose(collider, position + velocity * time, glm::normalize(glm::angleAxis(angle, glm::normalize(angularVelocity)) * rotation));
+}
+
+void ColliderManager::UpdatePoses()
+{
+    poses.resize(components.size());
+    for (uint32_t i = 0; i < components.size(); i++)
+        UpdatePose(components[i]);
+}
+
+void ColliderManager::UpdatePose(const Collider& collider)
+{
+    const Transform& transform = collider.GetComponent<Transform>();
+    poses[&collider - components.data()] = ColliderPose(collider, transform.position, transform.rotation);
+}
+
+void ColliderManager::UpdateTree(const std::vector<rvec3>& positions, const std::vector<real>& radii)
+{
+    if (treeInvalid)
+    {
+        tree.Clear();
+        treeProxies.clear();
+        treeInvalid = false;
     }
-}
\ No newline at end of file
+
+    for (uint32_t i = 0; i < positions.size(); i++)
+    {
+        AABB box = AABB::FromSphere(positions[i], radii[i]);
+        if (i < treeProxies.size())
+            tree.MoveProxy(treeProxies[i], box, treeMargin);
+        else
+            treeProxies.push_back(tree.CreateProxy(box, i, treeMargin));
+    }
+}
+
+void ColliderManager::UpdatePartition(real deltaT, bool sweptRadius)
+{
+    std::vector<uint32_t>& dynamicList = nextDynamicColliders;
+    std::vector<uint32_t>& staticList = nextStaticColliders;
+    dynamicList.clear();
+    staticList.clear();
+    for (uint32_t i = 0; i < components.size(); i++)
+    {
+        if (components[i].GetComponent<RigidBody>().type == RigidBody::Type::Dynamic)
+            dynamicList.push_back(i);
+        else
+            staticList.push_back(i);
+    }
+
+    // Dodane obiekty trafiają na koniec list i dostają nowe liście, każda inna zmiana przesuwa indeksy w strukturach.
+    auto isExtension = [](const std::vector<uint32_t>& previous, const std::vector<uint32_t>& current) {
+        return previous.size() <= current.size() && std::equal(previous.begin(), previous.end(), current.begin());
+        };
+    if (!isExtension(dynamicColliders, dynamicList))
+    {
+        treeInvalid = true;
+        sweepAndPruneInvalid = true;
+    }
+    if (!isExtension(staticColliders, staticList))
+        staticTreeInvalid = true;
+    // Poprzednie listy zostają buforami kolejnego wywołania.
+    dynamicColliders.swap(dynamicList);
+    staticColliders.swap(staticList);
+
+    if (staticTreeInvalid)
+    {
+        staticTree.Clear();
+        staticProxies.clear();
+        staticTreeInvalid = false;
+    }
+
+    // Liście obiektów statycznych mieszczą się w swoich prostopadłościanach, więc drzewo zmieniają tylko obiekty kinematyczne i ręcznie przesunięte.
+    staticRadii.resize(staticColliders.size());
+    for (uint32_t k = 0; k < staticColliders.size(); k++)
+    {
+        uint32_t i = staticColliders[k];
+        staticRadii[k] = GetQueryRadius(components[i], deltaT, sweptRadius);
+        AABB box = AABB::FromSphere(poses[i].position, staticRadii[k]);
+        if (k < staticProxies.size())
+            staticTree.MoveProxy(staticProxies[k], box, treeMargin);
+        else
+            staticProxies.push_back(staticTree.CreateProxy(box, k, treeMargin));
+    }
+}
+
+void ColliderManager::GetPossibleCollisions(real deltaT, CollisionPairBuffer* pairs, bool sweptRadius)
+{
+    pairs->Clear();
+    UpdatePoses();
+    UpdatePartition(deltaT, sweptRadius);
+
+    // Struktury wybranego algorytmu zawierają tylko obiekty dynamiczne, indeks i w nich to obiekt dynamicColliders[i].
+    // Bufory są polami klasy, więc po pierwszych krokach resize i clear nie alokują pamięci.
+    uint32_t dynamicCount = dynamicColliders.size();
+    std::vector<rvec3>& positions = queryPositions;
+    std::vector<real>& radii = queryRadii;
+    std::vector<real>& boundingRadii = queryBoundingRadii;
+    positions.resize(dynamicCount);
+    radii.resize(dynamicCount);
+    boundingRadii.resize(dynamicCount);
+    for (uint32_t i = 0; i < dynamicCount; i++)
+    {
+        const Collider& collider = components[dynamicColliders[i]];
+        positions[i] = poses[dynamicColliders[i]].position;
+        radii[i] = GetQueryRadius(collider, deltaT, sweptRadius);
+        boundingRadii[i] = collider.boundingSphereRadius;
+    }
+
+    auto overlaps = [&](uint32_t i, uint32_t j) {
+        rvec3 d = positions[j] - positions[i];
+        real sqrDist = glm::dot(d, d);
+        return sqrDist < pow(radii[i] + boundingRadii[j], 2) || sqrDist < pow(boundingRadii[i] + radii[j], 2);
+        };
+
+    switch (broadphase)
+    {
+    case Broadphase::Radius:
+        // Test kul w obu kierunkach odpowiada QuarryInRadius wywołanemu dla obu obiektów pary.
+        for (uint32_t i = 0; i < dynamicCount; i++)
+            for (uint32_t j = i + 1; j < dynamicCount; j++)
+                if (overlaps(i, j))
+                    pairs->Add(dynamicColliders[i], dynamicColliders[j]);
+        break;
+
+    case Broadphase::DynamicTree:
+    {
+        UpdateTree(positions, radii);
+
+        leafOrder.clear();
+        tree.ForEachLeaf([&](int32_t, uint32_t i) { leafOrder.push_back(i); });
+
+        for (uint32_t i : leafOrder)
+        {
+            // Każda para jest zgłaszana tylko przez obiekt o mniejszym indeksie,
+            // a dokładny test kul odpowiada temu z QuarryInRadius wykonanemu w obu kierunkach.
+            tree.Query(AABB::FromSphere(positions[i], radii[i]), [&](int32_t, uint32_t j) {
+                if (j <= i || !overlaps(i, j))
+                    return;
+
+                pairs->Add(dynamicColliders[i], dynamicColliders[j]);
+                });
+        }
+        break;
+    }
+
+    case Broadphase::SpatialHash:
+    {
+        queryBoxes.resize(dynamicCount);
+        for (uint32_t i = 0; i < dynamicCount; i++)
+            queryBoxes[i] = AABB::FromSphere(positions[i], radii[i]);
+
+        real cellSize = gridCellSize;
+        if (cellSize <= 0 && !radii.empty())
+        {
+            sortedRadii.assign(radii.begin(), radii.end());
+            std::nth_element(sortedRadii.begin(), sortedRadii.begin() + sortedRadii.size() / 2, sortedRadii.end());
+            cellSize = 2 * sortedRadii[sortedRadii.size() / 2];
+        }
+        grid.Build(queryBoxes, cellSize);
+
+        grid.FindPairs(overlaps, gridPairs);
+
+        for (auto&& pairsFromThread : gridPairs)
+            for (auto [i, j] : pairsFromThread)
+                pairs->Add(dynamicColliders[i], dynamicColliders[j]);
+        break;
+    }
+
+    case Broadphase::SweepAndPrune:
+    {
+        queryBoxes.resize(dynamicCount);
+        for (uint32_t i = 0; i < dynamicCount; i++)
+            queryBoxes[i] = AABB::FromSphere(positions[i], radii[i]);
+
+        if (sweepAndPruneInvalid)
+        {
+            sweepAndPrune.Build(queryBoxes, treeMargin);
+            sweepAndPruneInvalid = false;
+        }
+        else
+            sweepAndPrune.Update(queryBoxes, treeMargin);
+
+        // Lista par jest utrzymywana między krokami, ale test kul zależy od aktualnych położeń, więc sprawdzane są wszystkie pary z nachodzącymi prostopadłościanami.
+        for (auto&& pair : sweepAndPrune.GetPairs())
+            if (overlaps(pair.a, pair.b))
+                pairs->Add(dynamicColliders[pair.a], dynamicColliders[pair.b]);
+        break;
+    }
+    }
+
+    // Pary statyczne-statyczne nigdy nie powstają, obiekty statyczne i kinematyczne są znajdowane tylko przez obiekty dynamiczne.
+    for (uint32_t i = 0; i < dynamicCount; i++)
+    {
+        staticTree.Query(AABB::FromSphere(positions[i], radii[i]), [&](int32_t, uint32_t k) {
+            uint32_t j = staticColliders[k];
+            rvec3 d = poses[j].position - positions[i];
+            real sqrDist = glm::dot(d, d);
+            if (sqrDist >= pow(radii[i] + components[j].boundingSphereRadius, 2) && sqrDist >= pow(boundingRadii[i] + staticRadii[k], 2))
+                return;
+
+            pairs->Add(dynamicColliders[i], j);
+            });
+    }
+
+    pairs->SortAndRemoveDuplicates();
+}
+
+ColliderManager::Broadphase ColliderManager::broadphase = ColliderManager::Broadphase::DynamicTree;
+real ColliderManager::treeMargin = 0.1;
+real ColliderManager::gridCellSize = 0;
+bool ColliderManager::analyticContacts = true;
+bool ColliderManager::batchedGJK = true;
+std::vector<ColliderPose> ColliderManager::poses;
+GJKStatistics ColliderManager::gjkStatistics;
+SpatialHashGrid ColliderManager::grid;
+SweepAndPrune ColliderManager::sweepAndPrune;
+bool ColliderManager::sweepAndPruneInvalid = false;
+DynamicAABBTree ColliderManager::tree;
+std::vector<int32_t> ColliderManager::treeProxies;
+bool ColliderManager::treeInvalid = false;
+std::vector<uint32_t> ColliderManager::dynamicColliders;
+std::vector<uint32_t> ColliderManager::staticColliders;
+DynamicAABBTree ColliderManager::staticTree;
+std::vector<int32_t> ColliderManager::staticProxies;
+std::vector<real> ColliderManager::staticRadii;
+bool ColliderManager::staticTreeInvalid = false;
+std::vector<uint32_t> ColliderManager::nextDynamicColliders;
+std::vector<uint32_t> ColliderManager::nextStaticColliders;
+std::vector<rvec3> ColliderManager::queryPositions;
+std::vector<real> ColliderManager::queryRadii;
+std::vector<real> ColliderManager::queryBoundingRadii;
+std::vector<uint32_t> ColliderManager::leafOrder;
+std::vector<AABB> ColliderManager::queryBoxes;
+std::vector<real> ColliderManager::sortedRadii;
+std::vector<std::vector<std::pair<uint32_t, uint32_t>>> ColliderManager::gridPairs;
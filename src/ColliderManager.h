@@ -1,37 +1,12 @@
 #pragma once
 #include "Components.h"
 #include "Constraints.h"
+#include "DynamicAABBTree.h"
+#include "SpatialHashGrid.h"
+#include "SweepAndPrune.h"
+#include "CollisionPairBuffer.h"
 #include <unordered_set>
-
-using dvec2 = glm::dvec2;
-using dvec3 = glm::dvec3;
-using dquat = glm::dquat;
-
-/// @brief Struktura reprezentująca parę obiektów w kolizji.
-struct CollisionPair
-{
-    const Collider* a;
-    const Collider* b;
-
-    CollisionPair() : a(nullptr), b(nullptr) {}
-    CollisionPair(const Collider* a, const Collider* b) :a(a), b(b) {}
-
-    CollisionPair Inverse() const { return CollisionPair(b, a); }
-
-    bool operator==(const CollisionPair& rhs) const
-    {
-        return a == rhs.a && b == rhs.b;
-    }
-
-    /// @brief Struktura odpowiedzialna za wyznaczanie hasha pary kolizji, potrzebne do std::unordered_set
-    struct Hash
-    {
-        size_t operator()(const CollisionPair& o) const
-        {
-            return (size_t) o.a * 1203881 + (size_t) o.b;
-        }
-    };
-};
+#include <atomic>
 
 /// @brief Klasa odpowiedzialna za tworzenie i przechowywanie punktów w różnicy Minkowskiego.
 /// @details Przechowuje dane jako punkt z obiektu A oraz punkt z obiektu B.
@@ -39,9 +14,9 @@ struct CollisionPair
 class Support
 {
     /// @brief Punkt z obiektu A
-    dvec3 a;
+    rvec3 a;
     /// @brief Punkt z obiektu B
-    dvec3 b;
+    rvec3 b;
 
 public:
     Support() {}
@@ -49,21 +24,91 @@ public:
     /// @brief Konstruktor przyjmujący punkt z obiektów A i B.
     /// @param a punkt z obiektu A
     /// @param b punkt z obiektu B
-    Support(dvec3 a, dvec3 b) :a(a), b(b) {}
+    Support(rvec3 a, rvec3 b) :a(a), b(b) {}
 
     /// @brief Konstruktor wyznaczający różnice Minkowskiego dwóch obiektów, w kierunku \p n
     /// @param a obiekt A
     /// @param b obiekt B
     /// @param n kierunek
-    Support(const Collider& a, const Collider& b, dvec3 n) : a(a.SupportMapping(-n)), b(b.SupportMapping(n)) {}
+    Support(const Collider& a, const Collider& b, rvec3 n) : a(a.SupportMapping(-n)), b(b.SupportMapping(n)) {}
 
     /// @brief Operator zwracający konkretny punkt na w różnicy Minkowskiego
-    operator dvec3() { return b - a; }
+    operator rvec3() const { return b - a; }
 
-    dvec3& GetA() { return a; }
-    const dvec3& GetA() const { return a; }
-    dvec3& GetB() { return b; }
-    const dvec3& GetB() const { return b; }
+    rvec3& GetA() { return a; }
+    const rvec3& GetA() const { return a; }
+    rvec3& GetB() { return b; }
+    const rvec3& GetB() const { return b; }
+};
+
+/// @brief Stan obiektu kolizji w układzie świata, wyznaczany raz na pod krok i czytany przez fazę wąską.
+/// @details Macierz obrotu i jej transpozycja zastępują w funkcji wspomagającej odwracanie kwaternionu i obracanie nim przy każdym wywołaniu.
+struct ColliderPose
+{
+    rvec3 position;
+    rquat rotation;
+    /// @brief Obrót z lokalnego układu obiektu do układu świata.
+    rmat3 rotationMatrix;
+    /// @brief Transpozycja rotationMatrix, obrót z układu świata do lokalnego układu obiektu.
+    rmat3 inverseRotationMatrix;
+    /// @brief Prostopadłościan otaczający obiekt w układzie świata.
+    AABB box;
+
+    ColliderPose() {}
+    /// @brief Wyznacza macierze obrotu i prostopadłościan otaczający obiekt @p collider w położeniu @p position i obrocie @p rotation .
+    ColliderPose(const Collider& collider, const rvec3& position, const rquat& rotation);
+
+    /// @brief Punkt obiektu @p collider najdalej w kierunku @p direction w układzie świata.
+    rvec3 SupportMapping(const Collider& collider, const rvec3& direction) const
+    {
+        return rotationMatrix * collider.LocalSupportMapping(inverseRotationMatrix * direction) + position;
+    }
+};
+
+/// @brief Ruch obiektu kolizji w trakcie kroku ze stałą prędkością liniową i kątową, używany przez ColliderManager::TimeOfImpact .
+struct ColliderMotion
+{
+    rvec3 position;
+    rquat rotation;
+    rvec3 velocity;
+    rvec3 angularVelocity;
+
+    /// @brief Stan obiektu @p collider po czasie @p time od początku ruchu.
+    ColliderPose At(const Collider& collider, real time) const;
+};
+
+/// @brief Wynik GJK zapamiętany dla pary obiektów, używany do rozpoczęcia kolejnego wywołania dla tej samej pary.
+struct GJKCache
+{
+    enum class State
+    {
+        Empty, Separated, Colliding
+    } state = State::Empty;
+
+    /// @brief Ostatnia oś rozdzielająca, jeżeli obiekty nie były w kolizji.
+    rvec3 separatingAxis;
+    /// @brief Ostatni simpleks zawierający początek układu, punkty w lokalnych układach obiektów.
+    Support simplex[4];
+    /// @brief Znak objętości simpleksu, od którego zależy kolejność trójkątów w EPA.
+    bool positiveVolume;
+};
+
+/// @brief Statystyki wywołań GJK, zerowane ręcznie.
+/// @details Liczniki są atomowe, bo faza wąska działa na wielu wątkach, każde wywołanie GJK dodaje do nich raz.
+struct GJKStatistics
+{
+    std::atomic<uint64_t> calls = 0;
+    /// @brief Liczba wyznaczonych punktów funkcji wspomagającej.
+    std::atomic<uint64_t> supportEvaluations = 0;
+    /// @brief Liczba wywołań zakończonych przez zapamiętaną oś lub simpleks.
+    std::atomic<uint64_t> cacheHits = 0;
+
+    void Reset()
+    {
+        calls = 0;
+        supportEvaluations = 0;
+        cacheHits = 0;
+    }
 };
 
 /// @brief System zarządzania obiektami kolizji.
@@ -72,6 +117,59 @@ public:
 class ColliderManager : public ECS::System<Collider>
 {
 public:
+    /// @brief Algorytm szerokiej fazy wykrywania kolizji.
+    enum class Broadphase
+    {
+        /// @brief Sprawdzenie każdej pary obiektów, O(n²).
+        Radius,
+        /// @brief Dynamiczne drzewo prostopadłościanów otaczających.
+        DynamicTree,
+        /// @brief Jednorodna siatka przestrzenna, najlepsza dla wielu obiektów podobnej wielkości.
+        SpatialHash,
+        /// @brief Przyrostowe sortowanie końców przedziałów na trzech osiach, koszt aktualizacji zależy od liczby poruszonych obiektów,
+        /// ale dokładny test kul wykonywany jest co krok dla wszystkich par z nachodzącymi prostopadłościanami.
+        SweepAndPrune
+    };
+
+    /// @brief Algorytm używany przez GetPossibleCollisions.
+    static Broadphase broadphase;
+
+    /// @brief O ile powiększane są prostopadłościany w drzewie i w sweep and prune, by drobny ruch nie wymagał ich aktualizacji.
+    static real treeMargin;
+
+    /// @brief Rozmiar komórki siatki przestrzennej, 0 oznacza dwukrotność mediany promieni kul opisanych na obiektach.
+    static real gridCellSize;
+
+    /// @brief Statystyki wywołań GJK.
+    static GJKStatistics gjkStatistics;
+
+    /// @brief Czy kolizje prostopadłościan-prostopadłościan i kula-prostopadłościan wyznaczane są analitycznie zamiast przez GJK i EPA.
+    static bool analyticContacts;
+
+    /// @brief Czy faza wąska przed GetContacts odrzuca rozdzielone pary wektorowym GJK, SimdReal::width par naraz, używane tylko bez analyticContacts.
+    /// @details Ścieżka wektorowa jest opcjonalna i działa tylko po ustawieniu analyticContacts = false, bo każda para kul i prostopadłościanów ma test analityczny.
+    static bool batchedGJK;
+
+    /// @brief Stan obiektów kolizji w układzie świata w kolejności components, jedyne źródło położeń dla fazy wąskiej.
+    /// @details Aktualizowany z komponentów Transform przez UpdatePoses na początku GetPossibleCollisions, a w trakcie kroku
+    /// przez Physics z BodyStore w każdym pod kroku. Po ręcznej zmianie Transform poza krokiem trzeba wywołać UpdatePoses lub UpdatePose.
+    static std::vector<ColliderPose> poses;
+
+    static const ColliderPose& GetPose(const Collider& collider)
+    {
+        return poses[&collider - components.data()];
+    }
+
+    /// @brief Wyznacza poses wszystkich obiektów z ich komponentów Transform.
+    static void UpdatePoses();
+    /// @brief Wyznacza stan jednego obiektu z jego komponentu Transform.
+    static void UpdatePose(const Collider& collider);
+
+    /// @brief Wywoływane przy dodaniu komponentu, obiekt trafia do drzewa przy następnym GetPossibleCollisions, a jego stan do poses przy następnym UpdatePoses.
+    static void Add(Collider& collider);
+    /// @brief Wywoływane przy usunięciu komponentu, oznacza drzewa i sweep and prune do przebudowy i przenosi stan ostatniego obiektu w poses tak jak komponent.
+    static void Destroy(Collider& collider);
+
     /// @brief Implementacja algorytmu Gilbert'a-Johnson'a-Keerthi'ego.
     /// @details Stwierdza czy zachodzi kolizja między dwoma obiektami na podstawie,
     /// funkcji wspomagajacej tworząc simpleks (czyli w 3D tetrahedron), który jeżeli zawiera
@@ -79,31 +177,98 @@ public:
     /// @see Support
     /// @param a obiekt A
     /// @param b obiekt B
+    /// Jeżeli podano @p cache , najpierw sprawdzana jest zapamiętana oś rozdzielająca, a następnie czy zapamiętany simpleks
+    /// po przesunięciu z obiektami dalej zawiera początek układu, dopiero gdy oba testy zawiodą wykonywany jest pełny algorytm.
     /// @param simplex Zwracany simplex, musi mieć miejsce na conajmniej 4 elementy
+    /// @param cache wynik poprzedniego wywołania dla tej pary, aktualizowany, może być nullptr
     /// @return Prawda jeżeli zachodzi kolizja, fałsz jeżeli nie ma kolizji
-    static bool GJK(const Collider& a, const Collider& b, Support* simplex);
+    static bool GJK(const Collider& a, const Collider& b, Support* simplex, GJKCache* cache = nullptr);
+
+    /// @brief GJK dla do SimdReal::width par naraz, wykonywany jednocześnie na wszystkich parach.
+    /// @details Kroki są takie jak w GJK, ale czworościan przechowywany jest jako trójkąt i ostatni punkt zamiast tablicy z indeksami,
+    /// a rozgałęzienia zastępuje wybór maską. Para kończy, gdy znajdzie oś rozdzielającą, pętla trwa dopóki jakaś para nie skończyła.
+    /// Wynikiem jest tylko rozdzielenie, pary w kolizji trzeba przekazać do GJK lub GetContacts, które wyznaczają simpleks dla EPA.
+    /// Zapamiętana oś rozdzielająca jest używana jako pierwszy kierunek, a oś znaleziona dla rozdzielonej pary zapisywana w @p caches .
+    /// @param pairs pary obiektów, kule lub prostopadłościany
+    /// @param count liczba par, najwyżej SimdReal::width
+    /// @param caches wyniki GJK dla każdej pary, tablica i jej elementy mogą być nullptr
+    /// @return maska bitowa par, dla których znaleziono oś rozdzielającą, bit i dla pary i
+    static uint32_t GJKBatch(const CollisionPair* pairs, uint32_t count, GJKCache* const* caches = nullptr);
+
+    /// @brief Wynik testów, od których zaczyna się GetContacts.
+    enum class ContactTest
+    {
+        /// @brief Oba obiekty są statyczne lub bryły otaczające są rozłączne, nie ma kolizji.
+        Separated,
+        /// @brief Potrzebny jest GJK lub test analityczny, parę można najpierw sprawdzić w GJKBatch.
+        Batch,
+        /// @brief Dwie kule, testy analityczne lub para z zapamiętanym wynikiem GJK, GetContacts rozstrzyga je taniej od GJKBatch.
+        Contacts
+    };
+
+    /// @brief Sprawdza parę testami kul i prostopadłościanów otaczających, tymi samymi, od których zaczyna GetContacts.
+    /// @param cache wynik GJK z poprzedniego wywołania dla tej pary, może być nullptr
+    static ContactTest ClassifyPair(const Collider& a, const Collider& b, const GJKCache* cache);
+
+    /// @brief Odległość dwóch obiektów w stanach @p aPose i @p bPose wyznaczana algorytmem GJK na najbliższym punkcie różnicy Minkowskiego.
+    /// @details Zwracane jest dolne ograniczenie odległości, dokładne z tolerancją względną, dzięki czemu można na nim oprzeć CCD.
+    /// @param normal wyjściowy kierunek od najbliższego punktu obiektu A do najbliższego punktu obiektu B, nieustawiany przy kolizji
+    /// @return odległość lub 0 jeżeli obiekty są w kolizji
+    static real GetDistance(const Collider& a, const ColliderPose& aPose, const Collider& b, const ColliderPose& bPose, rvec3* normal);
+
+    /// @brief Czas zderzenia dwóch poruszających się obiektów wyznaczany metodą conservative advancement.
+    /// @details W każdej iteracji czas jest przesuwany o odległość obiektów podzieloną przez górne ograniczenie prędkości, z jaką mogą się
+    /// do siebie zbliżać, czyli rzut prędkości względnej na kierunek najbliższych punktów powiększony o |ω| razy promień kuli opisanej
+    /// każdego z obiektów. Dzięki temu obiekty nigdy nie przenikają się w wyznaczonym czasie.
+    /// @param maxTime czas, po którym szukanie jest przerywane
+    /// @param tolerance odległość, przy której obiekty uznawane są za stykające się
+    /// @param time wyjściowy czas zderzenia
+    /// @param normal wyjściowy kierunek od obiektu A do obiektu B w chwili zderzenia
+    /// @return Prawda jeżeli obiekty zbliżą się na @p tolerance przed @p maxTime , fałsz jeżeli nie lub jeżeli są w kolizji już na początku
+    static bool TimeOfImpact(const Collider& a, const ColliderMotion& aMotion, const Collider& b, const ColliderMotion& bMotion,
+        real maxTime, real tolerance, real* time, rvec3* normal);
 
     /// @brief Implementacja algorytmu Expanding Polytope Algorythm,
     /// @details Działa na simpleksie z algorytmu GJK, oblicza normalną, głębokość oraz punkty kolizji.
     /// Działa przez dodawanie punktów z funkcji wspomagającej w kierunku normalnej trójkąta, który jest najbliżej początku układu współrzędnych
     /// i łączenie istniejących punktów w trójkąty, zachowując wypukłość utworzonego politopu.
+    /// Nie alokuje pamięci, politop, trójkąty i horyzont przechowywane są w tablicach o stałym rozmiarze na stosie,
+    /// a najbliższy trójkąt wybierany jest z kopca.
     /// @see Support
     /// @see GJK
     /// @param a obiekt A
     /// @param b obietk B
-    /// @param polytope politop, początkowo muszą się wewnątrz znajdywać punkty z wstępnego simpleksa z funkcji GJK
+    /// @param simplex wstępny simpleks z funkcji GJK, 4 punkty
     /// @param normal wyjściowa normalna kolizji w kierunku z obiektu B do obiektu A
     /// @param depth wyjściowa głębokość kolizji
     /// @param p1 wyjsciowy punkt kolizji na obiekcie A
     /// @param p2 wyjsciowy punkt kolizji na obiekcie B
-    static void EPA(const Collider& a, const Collider& b, std::vector<Support>& polytope, dvec3* normal, double* depth, dvec3* p1, dvec3* p2);
+    static void EPA(const Collider& a, const Collider& b, const Support* simplex, rvec3* normal, real* depth, rvec3* p1, rvec3* p2);
+
+    /// @brief Funkcja wyznaczająca punkty styku dwóch obiektów, jeżeli zachodzi kolizja.
+    /// @details Każdy punkt ma identyfikator cech obiektów, które go utworzyły, dzięki czemu można go dopasować do punktu z poprzedniego pod kroku.
+    /// @param a obiekt A
+    /// @param b obiekt B
+    /// @param manifold wyjściowa rozmaitość kontaktowa, poprzednie punkty są usuwane, mnożniki są zerowe
+    /// @param cache wynik GJK z poprzedniego wywołania dla tej pary, może być nullptr
+    /// @return Prawda jeżeli zachodzi kolizja, fałsz jeżeli nie ma kolizji
+    static bool GetContacts(const Collider& a, const Collider& b, ContactManifold* manifold, GJKCache* cache = nullptr);
+
+    /// @brief Punkt kontaktu spekulatywnego dwóch rozdzielonych obiektów, bliższych niż @p maxDistance .
+    /// @details Normalna to kierunek najbliższych punktów z GetDistance. Punkt to środek wierzchołków prostopadłościanów bliższych niż @p maxDistance
+    /// od płaszczyzny przez najbliższy punkt drugiego obiektu i leżących naprzeciw niego, a dla dwóch kul ich najbliższe punkty. Głębokość jest ujemna, to najmniejsza odległość.
+    /// @param manifold wyjściowa rozmaitość kontaktowa z jednym punktem, poprzednie punkty są usuwane
+    /// @return Prawda jeżeli obiekty są rozdzielone i bliższe niż @p maxDistance
+    static bool GetSpeculativeContact(const Collider& a, const Collider& b, real maxDistance, ContactManifold* manifold);
 
     /// @brief Funkcja zwracająca ograniczk penetracji jeżeli zachodzi kolizja, potrzebny w rozwiązywaniu kolizji.
+    /// @details Z kilku punktów styku wybierany jest najgłębszy, obiekty ogranicznika to indeksy komponentów RigidBody.
     /// @param a obiekt A
     /// @param b obiekt B
     /// @param penetration wyjściowy ogranicznik penetracji 
+    /// @param cache wynik GJK z poprzedniego wywołania dla tej pary, może być nullptr
     /// @return Prawda jeżeli zachodzi kolizja, fałsz jeżeli nie ma kolizji
-    static bool GetPenetration(const Collider& a, const Collider& b, PenetrationConstraint* penetration);
+    static bool GetPenetration(const Collider& a, const Collider& b, PenetrationConstraint* penetration, GJKCache* cache = nullptr);
     static bool AreColliding(const Collider& a, const Collider& b)
     {
         Support simplex[4];
@@ -124,6 +289,69 @@ public:
     /// @brief Funkcja zwracająca listę unikalnych par kolizji w odległości @p radiusMultiplier * średnica kuli opisanej na obiektcie @p a od pozycji obiektu @p a 
     /// @param a obiekt A
     /// @param radiusMultiplier mnożnik średnicy kuli opisanej na obiekcie @p a 
-    /// @param pairs wyjściowa lista unikalnych par kolizji, takich że pierwszy obiekt w parze to obiekt A
-    static void QuarryInRadius(Collider& a, double radiusMultiplier, std::unordered_set<CollisionPair, CollisionPair::Hash>* pairs);
-};
\ No newline at end of file
+    /// @param pairs bufor, do którego dopisywane są pary, mogą się powtarzać dopóki nie zostanie wywołane CollisionPairBuffer::SortAndRemoveDuplicates
+    static void QuarryInRadius(const Collider& a, real radiusMultiplier, CollisionPairBuffer* pairs);
+
+    /// @brief Funkcja zwracająca listę unikalnych par obiektów, które mogą wejść w kolizję w czasie @p deltaT .
+    /// @details Para jest zwracana, jeżeli kula opisana na jednym z obiektów, powiększona o 1 + |v| * @p deltaT * 2, ale nie mniej niż o drogę
+    /// |v| * @p deltaT , nachodzi na kulę opisaną na drugim.
+    /// Wynik nie zależy od wybranego algorytmu @ref broadphase, zmienia się tylko koszt. Algorytm dobiera pary obiektów dynamicznych,
+    /// a obiekty ciał statycznych i kinematycznych są w osobnym drzewie, o które pytają tylko obiekty dynamiczne, więc pary dwóch takich obiektów nie powstają.
+    /// @param deltaT krok czasowy
+    /// @param pairs wyjściowa lista unikalnych par kolizji posortowana po pierwszym obiekcie, poprzednia zawartość jest usuwana
+    /// @param sweptRadius czy kula powiększana jest tylko o dwie drogi |v| * @p deltaT , co wystarcza, gdy zbliżające się pary
+    /// zatrzymują kontakty spekulatywne, a nie zależy od rozmiaru obiektu
+    static void GetPossibleCollisions(real deltaT, CollisionPairBuffer* pairs, bool sweptRadius = false);
+
+private:
+    /// @brief Drzewo obiektów dynamicznych, liść obiektu dynamicColliders[i] to treeProxies[i].
+    static DynamicAABBTree tree;
+    static std::vector<int32_t> treeProxies;
+    static bool treeInvalid;
+    static SpatialHashGrid grid;
+    static ::SweepAndPrune sweepAndPrune;
+    static bool sweepAndPruneInvalid;
+
+    /// @brief Indeksy obiektów ciał dynamicznych oraz statycznych i kinematycznych, rosnąco.
+    static std::vector<uint32_t> dynamicColliders;
+    static std::vector<uint32_t> staticColliders;
+    /// @brief Drzewo obiektów ciał statycznych i kinematycznych, liść obiektu staticColliders[k] to staticProxies[k].
+    /// @details Przebudowywane tylko, gdy zmieni się podział obiektów, liście obiektów statycznych zwykle się nie przesuwają.
+    static DynamicAABBTree staticTree;
+    static std::vector<int32_t> staticProxies;
+    /// @brief Promienie z GetQueryRadius obiektów staticColliders.
+    static std::vector<real> staticRadii;
+    static bool staticTreeInvalid;
+
+    /// @brief Bufory UpdatePartition , po wyznaczeniu nowego podziału zamieniane z dynamicColliders i staticColliders.
+    static std::vector<uint32_t> nextDynamicColliders;
+    static std::vector<uint32_t> nextStaticColliders;
+    /// @brief Bufory GetPossibleCollisions używane ponownie w kolejnych krokach, indeks i w nich to obiekt dynamicColliders[i].
+    static std::vector<rvec3> queryPositions;
+    static std::vector<real> queryRadii;
+    static std::vector<real> queryBoundingRadii;
+    /// @brief Indeksy obiektów w kolejności liści drzewa.
+    static std::vector<uint32_t> leafOrder;
+    static std::vector<AABB> queryBoxes;
+    static std::vector<real> sortedRadii;
+    /// @brief Pary z SpatialHashGrid::FindPairs , osobna lista dla każdego wątku.
+    static std::vector<std::vector<std::pair<uint32_t, uint32_t>>> gridPairs;
+
+    /// @brief Kolizja kuli z prostopadłościanem przez najbliższy punkt prostopadłościanu do środka kuli, jeden z obiektów musi być kulą.
+    static bool GetSphereBoxContacts(const Collider& a, const Collider& b, ContactManifold* manifold);
+    /// @brief Kolizja dwóch prostopadłościanów z twierdzenia o osi rozdzielającej (SAT).
+    /// @details Dla osi ściany zwraca do 4 punktów z przycięcia ściany drugiego prostopadłościanu, dla pary krawędzi jeden punkt.
+    static bool GetBoxBoxContacts(const Collider& a, const Collider& b, ContactManifold* manifold);
+
+    /// @brief Właściwy algorytm GJK, przy braku kolizji zwraca oś rozdzielającą.
+    /// @param supportEvaluations licznik wyznaczonych punktów funkcji wspomagającej, zwiększany
+    static bool SolveGJK(const Collider& a, const Collider& b, Support* simplex, rvec3* separatingAxis, uint32_t* supportEvaluations);
+    /// @brief Czy zapamiętany simpleks, przeniesiony do aktualnych pozycji obiektów, zawiera początek układu.
+    static bool IsCachedSimplexValid(const Collider& a, const Collider& b, const GJKCache& cache, Support* simplex);
+
+    static real GetQueryRadius(const Collider& collider, real deltaT, bool sweptRadius);
+    static void UpdateTree(const std::vector<rvec3>& positions, const std::vector<real>& radii);
+    /// @brief Dzieli obiekty na dynamiczne i pozostałe, oznacza do przebudowy struktury, w których zmieniły się indeksy, i aktualizuje staticTree.
+    static void UpdatePartition(real deltaT, bool sweptRadius);
+};
+REGISTER_SYSTEMS(Collider, ColliderManager);
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "CollisionPairBuffer.h"
+#include <algorithm>
+
+void CollisionPairBuffer::RadixPass(uint32_t CollisionPair::* field, int shift)
+{
+    uint32_t counts[256] = {};
+    for (const CollisionPair& pair : pairs)
+        counts[(pair.*field >> shift) & 0xFF]++;
+
+    if (counts[(pairs[0].*field >> shift) & 0xFF] == pairs.size())
+        return;
+
+    uint32_t offsets[256];
+    uint32_t offset = 0;
+    for (int i = 0; i < 256; i++)
+    {
+        offsets[i] = offset;
+        offset += counts[i];
+    }
+
+    scratch.resize(pairs.size());
+    for (const CollisionPair& pair : pairs)
+        scratch[offsets[(pair.*field >> shift) & 0xFF]++] = pair;
+
+    pairs.swap(scratch);
+}
+
+void CollisionPairBuffer::SortAndRemoveDuplicates()
+{
+    if (pairs.size() < 2)
+        return;
+
+    // Sortowanie od najmniej znaczącego bajtu, najpierw drugi indeks, potem pierwszy,
+    // przejścia dla bajtów większych niż największy indeks są pomijane.
+    uint32_t maxIndex = 0;
+    for (const CollisionPair& pair : pairs)
+        maxIndex = std::max(maxIndex, pair.b);
+
+    for (uint32_t CollisionPair::* field : { &CollisionPair::b, &CollisionPair::a })
+        for (int shift = 0; shift < 32 && (maxIndex >> shift) != 0; shift += 8)
+            RadixPass(field, shift);
+
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/// @brief Struktura reprezentująca parę obiektów w kolizji, jako indeksy w ColliderManager::components.
+struct CollisionPair
+{
+    uint32_t a;
+    uint32_t b;
+
+    CollisionPair() : a(0), b(0) {}
+    CollisionPair(uint32_t a, uint32_t b) :a(a), b(b) {}
+
+    CollisionPair Inverse() const { return CollisionPair(b, a); }
+
+    bool operator==(const CollisionPair& rhs) const
+    {
+        return a == rhs.a && b == rhs.b;
+    }
+
+    /// @brief Struktura odpowiedzialna za wyznaczanie hasha pary kolizji, potrzebne do std::unordered_set
+    struct Hash
+    {
+        size_t operator()(const CollisionPair& o) const
+        {
+            return (size_t) o.a * 1203881 + (size_t) o.b;
+        }
+    };
+};
+
+/// @brief Ciągła tablica par kolizji, posortowana po pierwszym obiekcie i bez powtórzeń.
+/// @details Pary są dopisywane w dowolnej kolejności, a następnie sortowane sortowaniem pozycyjnym (radix sort) po obu indeksach.
+/// Pamięć nie jest zwalniana przy czyszczeniu, dzięki czemu bufor używany w kolejnych krokach nie alokuje pamięci.
+class CollisionPairBuffer
+{
+    std::vector<CollisionPair> pairs;
+    std::vector<CollisionPair> scratch;
+
+public:
+    /// @brief Usuwa wszystkie pary, zachowując zaalokowaną pamięć.
+    void Clear() { pairs.clear(); }
+
+    /// @brief Dodaje parę, kolejność obiektów nie ma znaczenia, zapisywana jest jako (mniejszy, większy) indeks.
+    void Add(uint32_t a, uint32_t b)
+    {
+        if (a > b)
+            pairs.emplace_back(b, a);
+        else
+            pairs.emplace_back(a, b);
+    }
+
+    /// @brief Sortuje pary po pierwszym, a następnie po drugim indeksie i usuwa powtórzenia.
+    void SortAndRemoveDuplicates();
+
+    /// @brief Przenosi dane przypisane do par z poprzedniego bufora do aktualnego.
+    /// @details Oba bufory muszą być posortowane, pary są łączone jednym przejściem jak w sortowaniu przez scalanie.
+    /// Pary, których nie było w poprzednim buforze dostają wartość domyślną.
+    /// @param previous poprzedni bufor
+    /// @param previousData dane par z poprzedniego bufora, w tej samej kolejności
+    /// @param data wyjściowe dane par z tego bufora
+    template <typename TData>
+    void Remap(const CollisionPairBuffer& previous, const std::vector<TData>& previousData, std::vector<TData>& data) const
+    {
+        data.resize(pairs.size());
+        size_t j = 0;
+        for (size_t i = 0; i < pairs.size(); i++)
+        {
+            const CollisionPair& pair = pairs[i];
+            while (j < previous.size() && (previous[j].a < pair.a || (previous[j].a == pair.a && previous[j].b < pair.b)))
+                j++;
+
+            if (j < previous.size() && previous[j] == pair)
+                data[i] = previousData[j];
+            else
+                data[i] = TData();
+        }
+    }
+
+    size_t size() const { return pairs.size(); }
+    bool empty() const { return pairs.empty(); }
+    const CollisionPair& operator[](size_t i) const { return pairs[i]; }
+    const CollisionPair* begin() const { return pairs.data(); }
+    const CollisionPair* end() const { return pairs.data() + pairs.size(); }
+
+private:
+    /// @brief Jedno przejście stabilnego sortowania pozycyjnego po bajcie @p shift pola @p field ,
+    /// pomijane jeżeli wszystkie pary mają ten sam bajt.
+    void RadixPass(uint32_t CollisionPair::* field, int shift);
+};
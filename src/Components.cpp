@@ -1,8 +1,9 @@
 #include "Components.h"
+#include "ColliderManager.h"
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/quaternion.hpp>
 
-Transform::Transform(const glm::dvec3& position, const glm::dvec3& scale, const glm::dquat& rotation)
+Transform::Transform(const rvec3& position, const rvec3& scale, const rquat& rotation)
     :position(position), scale(scale), rotation(rotation)
 {}
 
@@ -11,39 +12,37 @@ glm::mat4 Transform::Matrix() const
     return glm::translate(glm::mat4(1), glm::vec3(position)) * glm::mat4(glm::quat(rotation)) * glm::scale(glm::mat4(1), glm::vec3(scale));
 }
 
-glm::dvec3 Transform::Forward() const
+rvec3 Transform::Forward() const
 {
-    auto v = rotation * glm::dvec4(0, 1, 0, 0);
+    auto v = rotation * glm::vec<4, real>(0, 1, 0, 0);
     return v;
 }
 
-glm::dvec3 Transform::Up() const
+rvec3 Transform::Up() const
 {
-    auto v = rotation * glm::dvec4(0, 0, 1, 0);
+    auto v = rotation * glm::vec<4, real>(0, 0, 1, 0);
     return v;
 }
 
-glm::dvec3 Transform::Right() const
+rvec3 Transform::Right() const
 {
-    auto v = rotation * glm::dvec4(1, 0, 0, 0);
+    auto v = rotation * glm::vec<4, real>(1, 0, 0, 0);
     return v;
 }
 
 
 Collider::Collider() {}
 
-Collider::Collider(double radius) :type(Type::Sphere), radius(radius), boundingSphereRadius(GetBoundingSphereRadius()) {}
+Collider::Collider(real radius) :type(Type::Sphere), radius(radius), boundingSphereRadius(GetBoundingSphereRadius()) {}
 
-Collider::Collider(const glm::dvec3& boxSize) :type(Type::Box), size(boxSize), boundingSphereRadius(GetBoundingSphereRadius()) {}
+Collider::Collider(const rvec3& boxSize) :type(Type::Box), size(boxSize), boundingSphereRadius(GetBoundingSphereRadius()) {}
 
-glm::dvec3 Collider::SupportMapping(glm::dvec3 direction) const
+rvec3 Collider::SupportMapping(rvec3 direction) const
 {
-    auto& transform = GetComponent<Transform>();
-    direction = glm::inverse(transform.rotation) * direction;
-    return transform.rotation * LocalSupportMapping(direction) + transform.position;
+    return ColliderManager::GetPose(*this).SupportMapping(*this, direction);
 }
 
-double Collider::GetBoundingSphereRadius() const
+real Collider::GetBoundingSphereRadius() const
 {
     switch (type)
     {
@@ -58,7 +57,22 @@ double Collider::GetBoundingSphereRadius() const
     }
 }
 
-glm::dvec3 Collider::LocalSupportMapping(glm::dvec3 direction) const
+real Collider::GetInnerRadius() const
+{
+    switch (type)
+    {
+    case Collider::Type::Sphere:
+        return radius;
+
+    case Collider::Type::Box:
+        return std::min({ size.x, size.y, size.z });
+
+    default:
+        return 0;
+    }
+}
+
+rvec3 Collider::LocalSupportMapping(rvec3 direction) const
 {
     switch (type)
     {
@@ -66,34 +80,34 @@ glm::dvec3 Collider::LocalSupportMapping(glm::dvec3 direction) const
         return glm::normalize(direction) * radius;
 
     case Collider::Type::Box:
-        return glm::dvec3{ direction.x > 0 ? 1 : -1, direction.y > 0 ? 1 : -1, direction.z > 0 ? 1 : -1 } *size;
+        return rvec3{ direction.x > 0 ? 1 : -1, direction.y > 0 ? 1 : -1, direction.z > 0 ? 1 : -1 } *size;
 
     default:
         return { 0, 0, 0 };
     }
 }
 
-glm::dmat3 GetInertiaTensor(glm::dvec3 scale, Collider::Type type)
+rmat3 GetInertiaTensor(rvec3 scale, Collider::Type type)
 {
     switch (type)
     {
     case Collider::Type::Sphere:
-        return glm::dmat3(2.0 / 5.0 * pow(std::max({ scale.x,scale.y,scale.z }), 2.0));
+        return rmat3(2.0 / 5.0 * pow(std::max({ scale.x,scale.y,scale.z }), 2.0));
 
     case Collider::Type::Box:
         scale *= 2;
-        return glm::dmat3(
+        return rmat3(
             1.0 / 12.0 * (scale.x * scale.x + scale.z * scale.z), 0, 0,
             0, 1.0 / 12.0 * (scale.y * scale.y + scale.z * scale.z), 0,
             0, 0, 1.0 / 12.0 * (scale.x * scale.x + scale.y * scale.y));
 
-    default:return glm::dmat3(1.0);
+    default:return rmat3(1.0);
     }
 }
 
 RigidBody::RigidBody() {}
 
-RigidBody::RigidBody(const glm::dvec3& velocity, const glm::dvec3& angularVelocity, const glm::dvec3& centerOfMass, double mass, const glm::dmat3& inertiaTensor, double restitutionCoefficient, double staticFrictionCoefficient, double dynamicFrictionCoefficient)
+RigidBody::RigidBody(const rvec3& velocity, const rvec3& angularVelocity, const rvec3& centerOfMass, real mass, const rmat3& inertiaTensor, real restitutionCoefficient, real staticFrictionCoefficient, real dynamicFrictionCoefficient)
     :velocity(velocity), angularVelocity(angularVelocity), centerOfMass(centerOfMass),
     inertiaTensor(inertiaTensor* mass), inverseInertiaTensor(glm::inverse(inertiaTensor* mass)),
     mass(mass), inverseMass(1.0f / mass), restitutionCoefficient(restitutionCoefficient),
@@ -101,68 +115,62 @@ RigidBody::RigidBody(const glm::dvec3& velocity, const glm::dvec3& angularVeloci
 {
     if (mass == std::numeric_limits<decltype(mass)>::infinity())
     {
-        inverseInertiaTensor = glm::dmat3({ 0,0,0,0,0,0,0,0,0 });
+        inverseInertiaTensor = rmat3({ 0,0,0,0,0,0,0,0,0 });
         inverseMass = 0;
+        type = Type::Static;
     }
 }
 
-glm::dvec3& RigidBody::GetPosition()
+rvec3& RigidBody::GetPosition()
 {
     return GetComponent<Transform>().position;
 }
 
-glm::dquat& RigidBody::GetRotation()
+rquat& RigidBody::GetRotation()
 {
     return GetComponent<Transform>().rotation;
 }
 
-double RigidBody::GetMass(const glm::dvec3& point, const glm::dvec3& normal) const
+real RigidBody::GetMass(const rvec3& point, const rvec3& normal) const
 {
+    if (sleeping)
+        return 0;
+
     return inverseMass + glm::dot(glm::cross(point, normal), inverseInertiaTensor * glm::cross(point, normal));
 }
 
-void RigidBody::AddForce(const glm::dvec3& force, double deltaT)
+void RigidBody::AddForce(const rvec3& force, real deltaT)
 {
     if (inverseMass == 0)
         return;
 
+    WakeUp();
     velocity += force * deltaT;
 }
 
-void RigidBody::ApplyPositionalImpulse(const glm::dvec3& impulse, const glm::dvec3& point)
+void RigidBody::WakeUp()
 {
-    GetPosition() += impulse * inverseMass;
-    GetRotation() += 0.5 * glm::dquat(0, inverseInertiaTensor * glm::cross(point, impulse)) * GetRotation();
-}
+    if (!sleeping)
+        return;
 
-void RigidBody::ApplyVelocityImpulse(const glm::dvec3& impulse, const glm::dvec3& point)
-{
-    velocity += impulse * inverseMass;
-    angularVelocity += inverseInertiaTensor * glm::cross(point, impulse);
+    sleeping = false;
+    sleepTime = 0;
 }
 
-void RigidBody::Integrate(double deltaT)
+void RigidBody::ApplyPositionalImpulse(const rvec3& impulse, const rvec3& point)
 {
-    previousPosition = GetPosition();
-    previousRotation = GetRotation();
-    previousVelocity = velocity;
-    previousAngularVelocity = angularVelocity;
-
-    if (inverseMass == 0)
+    if (inverseMass == 0 || sleeping)
         return;
 
-    angularVelocity += deltaT * inverseInertiaTensor * -glm::cross(angularVelocity, inertiaTensor * angularVelocity);
-
-    GetPosition() += velocity * deltaT;
-    GetRotation() += deltaT * 0.5 * glm::dquat(0, angularVelocity) * GetRotation();
-    GetRotation() = glm::normalize(GetRotation());
+    GetPosition() += impulse * inverseMass;
+    GetRotation() += real(0.5) * rquat(0, inverseInertiaTensor * glm::cross(point, impulse)) * GetRotation();
 }
 
-void RigidBody::UpdateVelocities(double deltaT)
+void RigidBody::ApplyVelocityImpulse(const rvec3& impulse, const rvec3& point)
 {
-    velocity = (GetPosition() - previousPosition) / deltaT;
+    if (inverseMass == 0 || sleeping)
+        return;
 
-    glm::dquat rotationDelta = GetRotation() * glm::inverse(previousRotation);
-    angularVelocity = 2.0 * glm::dvec3(rotationDelta.x, rotationDelta.y, rotationDelta.z) / deltaT;
-    angularVelocity = rotationDelta.w >= 0 ? angularVelocity : -angularVelocity;
+    velocity += impulse * inverseMass;
+    angularVelocity += inverseInertiaTensor * glm::cross(point, impulse);
 }
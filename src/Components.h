@@ -1,8 +1,5 @@
 #pragma once
-#define GLM_FORCE_RADIANS
-#define GLM_FORCE_DEPTH_ZERO_TO_ONE
-#include <glm/glm.hpp>
-#include <glm/gtc/quaternion.hpp>
+#include "Real.h"
 #include "Mesh.h"
 #include "VG/VG.h"
 #include "ECS.h"
@@ -10,12 +7,12 @@
 /// @brief Komponent przechowujący dane do transformacji obiektów.
 struct Transform : public ECS::Component<Transform>
 {
-    glm::dvec3 position;
-    glm::dvec3 scale;
-    glm::dquat rotation;
+    rvec3 position;
+    rvec3 scale;
+    rquat rotation;
     bool updateFlag;
 
-    Transform(const glm::dvec3& position = glm::dvec3(0, 0, 0), const glm::dvec3& scale = glm::dvec3(1, 1, 1), const glm::dquat& rotation = glm::dquat(1, 0, 0, 0));
+    Transform(const rvec3& position = rvec3(0, 0, 0), const rvec3& scale = rvec3(1, 1, 1), const rquat& rotation = rquat(1, 0, 0, 0));
 
     /// @brief Oblicza macierz transformacji
     /// @return macierz transformacji
@@ -23,15 +20,15 @@ struct Transform : public ECS::Component<Transform>
 
     /// @brief Oblicza wektor  {0,1,0} w koordynatach globalnych.
     /// @return wektor
-    glm::dvec3 Forward() const;
+    rvec3 Forward() const;
 
     /// @brief Oblicza wektor  {0,0,1} w koordynatach globalnych.
     /// @return wektor
-    glm::dvec3 Up() const;
+    rvec3 Up() const;
 
     /// @brief Oblicza wektor  {1,0,0} w koordynatach globalnych.
     /// @return wektor
-    glm::dvec3 Right() const;
+    rvec3 Right() const;
 };
 
 /// @brief Komponent przechowujący informacje na temat siatki oraz materiału pewnego obiektu.
@@ -56,59 +53,81 @@ struct Collider : public ECS::Component<Collider>
     } type;
     union
     {
-        double radius;
-        glm::dvec3 size;
+        real radius;
+        rvec3 size;
     };
-    double boundingSphereRadius;
+    real boundingSphereRadius;
 
     Collider();
-    Collider(double radius);
-    Collider(const glm::dvec3& boxSize);
+    Collider(real radius);
+    Collider(const rvec3& boxSize);
 
-    glm::dvec3 SupportMapping(glm::dvec3 direction) const;
+    /// @brief Punkt obiektu najdalej w kierunku @p direction w układzie świata, ze stanu w ColliderManager::poses .
+    rvec3 SupportMapping(rvec3 direction) const;
+    /// @brief Punkt obiektu najdalej w kierunku @p direction w lokalnym układzie obiektu.
+    rvec3 LocalSupportMapping(rvec3 direction) const;
+    /// @brief Promień kuli wpisanej w obiekt, czyli połowa jego najmniejszej grubości.
+    real GetInnerRadius() const;
 
 private:
-    double GetBoundingSphereRadius() const;
-    glm::dvec3 LocalSupportMapping(glm::dvec3 direction) const;
+    real GetBoundingSphereRadius() const;
 };
 
 /// @brief Komponent przechowujacy dane ciała sztywnego.
+/// @details W trakcie Physics::Update stan obiektu jest w BodyStore, komponent jest aktualizowany na końcu kroku.
 struct RigidBody : public ECS::Component<RigidBody>
 {
-    glm::dvec3 velocity;
-    glm::dvec3 angularVelocity;
-    glm::dvec3 centerOfMass;
-
-    glm::dvec3 previousPosition;
-    glm::dvec3 previousVelocity;
-    glm::dvec3 previousAngularVelocity;
-    glm::dquat previousRotation;
-
-    glm::dmat3 inertiaTensor;
-    glm::dmat3 inverseInertiaTensor;
-
-    double mass;
-    double inverseMass;
-    double restitutionCoefficient;
-    double staticFrictionCoefficient;
-    double dynamicFrictionCoefficient;
+    /// @brief Rodzaj obiektu, od którego zależy, w której strukturze szerokiej fazy jest jego obiekt kolizji i czy jest całkowany.
+    enum class Type
+    {
+        /// @brief Obiekt poruszany przez grawitację i ograniczniki.
+        Dynamic,
+        /// @brief Obiekt o nieskończonej masie, który się nie porusza, tworzony przez konstruktor dla nieskończonej masy.
+        Static,
+        /// @brief Obiekt o nieskończonej masie, który porusza się ze swoją prędkością i prędkością kątową, ustawiany ręcznie zamiast Static.
+        Kinematic
+    } type = Type::Dynamic;
+
+    rvec3 velocity;
+    rvec3 angularVelocity;
+    rvec3 centerOfMass;
+
+    rvec3 previousPosition;
+    rvec3 previousVelocity;
+    rvec3 previousAngularVelocity;
+    rquat previousRotation;
+
+    rmat3 inertiaTensor;
+    rmat3 inverseInertiaTensor;
+
+    real mass;
+    real inverseMass;
+    real restitutionCoefficient;
+    real staticFrictionCoefficient;
+    real dynamicFrictionCoefficient;
+
+    /// @brief Czy obiekt śpi, śpiący obiekt nie jest całkowany i dla innych obiektów zachowuje się jak statyczny.
+    bool sleeping = false;
+    /// @brief Jak długo obiekt pozostaje blisko sleepPosition i sleepRotation, 0 jeżeli położenie odniesienia nie jest ustawione.
+    real sleepTime = 0;
+    /// @brief Położenie odniesienia, z którego liczona jest średnia prędkość przy usypianiu.
+    rvec3 sleepPosition;
+    /// @brief Obrót odniesienia, z którego liczona jest średnia prędkość kątowa przy usypianiu.
+    rquat sleepRotation;
 
     RigidBody();
-    RigidBody(const glm::dvec3& velocity, const glm::dvec3& angularVelocity, const glm::dvec3& centerOfMass, double mass, const glm::dmat3& inertiaTensor, double restitutionCoefficient = 1.0, double staticFrictionCoefficient = 0.9, double dynamicFrictionCoefficient = 0.68);
-
-    glm::dvec3& GetPosition();
-    glm::dquat& GetRotation();
-    double GetMass(const glm::dvec3& point, const glm::dvec3& normal) const;
-
-    void AddForce(const glm::dvec3& force, double deltaT);
-    void ApplyPositionalImpulse(const glm::dvec3& impulse, const glm::dvec3& point);
-    void ApplyVelocityImpulse(const glm::dvec3& impulse, const glm::dvec3& point);
-
-private:
-    void Integrate(double deltaT);
-    void UpdateVelocities(double deltaT);
-
-    friend class Physics;
+    RigidBody(const rvec3& velocity, const rvec3& angularVelocity, const rvec3& centerOfMass, real mass, const rmat3& inertiaTensor, real restitutionCoefficient = 1.0, real staticFrictionCoefficient = 0.9, real dynamicFrictionCoefficient = 0.68);
+
+    rvec3& GetPosition();
+    rquat& GetRotation();
+    real GetMass(const rvec3& point, const rvec3& normal) const;
+
+    /// @brief Zmienia prędkość obiektu, budzi go jeżeli spał.
+    void AddForce(const rvec3& force, real deltaT);
+    /// @brief Budzi obiekt i zeruje jego czas spoczynku.
+    void WakeUp();
+    void ApplyPositionalImpulse(const rvec3& impulse, const rvec3& point);
+    void ApplyVelocityImpulse(const rvec3& impulse, const rvec3& point);
 };
 
 ENTITY(Transform, MeshArray, Collider, RigidBody);
\ No newline at end of file
@@ -0,0 +1,46 @@
+#include "ConstraintColoring.h"
+#include <algorithm>
+#include <bit>
+
+void ConstraintColoring::Build(const std::vector<std::pair<uint32_t, uint32_t>>& bodies, uint32_t bodyCount)
+{
+    bodyColors.assign(bodyCount, 0);
+    groupColors.resize(bodies.size());
+
+    // Każdy obiekt ma maskę kolorów zajętych przez jego grupy, grupa dostaje najmniejszy kolor wolny w obu obiektach.
+    uint32_t usedColors = 0;
+    for (size_t i = 0; i < bodies.size(); i++)
+    {
+        auto [a, b] = bodies[i];
+        uint64_t used = 0;
+        if (a != staticBody)
+            used |= bodyColors[a];
+        if (b != staticBody)
+            used |= bodyColors[b];
+
+        uint32_t color = std::countr_one(used);
+        if (color < maxColors)
+        {
+            uint64_t bit = uint64_t(1) << color;
+            if (a != staticBody)
+                bodyColors[a] |= bit;
+            if (b != staticBody)
+                bodyColors[b] |= bit;
+        }
+
+        groupColors[i] = color;
+        usedColors = std::max(usedColors, color + 1);
+    }
+
+    // Sortowanie przez zliczanie po kolorze, zachowuje kolejność grup w kolorze.
+    colorStarts.assign(usedColors + 1, 0);
+    for (uint32_t color : groupColors)
+        colorStarts[color + 1]++;
+    for (uint32_t i = 0; i < usedColors; i++)
+        colorStarts[i + 1] += colorStarts[i];
+
+    order.resize(bodies.size());
+    fillOffsets.assign(colorStarts.begin(), colorStarts.end() - 1);
+    for (uint32_t i = 0; i < bodies.size(); i++)
+        order[fillOffsets[groupColors[i]]++] = i;
+}
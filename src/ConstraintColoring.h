@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+/// @brief Podział grup ograniczników na kolory, w których żadne dwie grupy nie dzielą obiektu dynamicznego.
+/// @details Grupy jednego koloru mogą być rozwiązywane równolegle, a kolory po kolei.
+/// Kolory przydzielane są zachłannie w kolejności grup, dlatego podział zależy tylko od wejścia, a nie od liczby wątków.
+/// Obiekty statyczne nie są zapisywane przez ograniczniki, więc nie tworzą konfliktów.
+class ConstraintColoring
+{
+public:
+    /// @brief Oznaczenie obiektu statycznego w Build.
+    static constexpr uint32_t staticBody = UINT32_MAX;
+    /// @brief Maksymalna liczba kolorów, grupy, które się nie zmieściły trafiają do ostatniego koloru rozwiązywanego szeregowo.
+    static constexpr uint32_t maxColors = 64;
+
+private:
+    std::vector<uint64_t> bodyColors;
+    std::vector<uint32_t> groupColors;
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> colorStarts;
+    std::vector<uint32_t> fillOffsets;
+
+public:
+    /// @brief Przydziela kolory grupom.
+    /// @param bodies indeksy dwóch obiektów każdej grupy, staticBody dla obiektów statycznych
+    /// @param bodyCount liczba obiektów
+    void Build(const std::vector<std::pair<uint32_t, uint32_t>>& bodies, uint32_t bodyCount);
+
+    /// @brief Liczba kolorów, wliczając kolor szeregowy.
+    uint32_t GetColorCount() const { return colorStarts.empty() ? 0 : colorStarts.size() - 1; }
+
+    /// @brief Czy grupy koloru @p color mogą dzielić obiekty i muszą być rozwiązane szeregowo.
+    bool IsSerial(uint32_t color) const { return color == maxColors; }
+
+    /// @brief Indeksy grup koloru @p color , w kolejności rosnącej.
+    const uint32_t* begin(uint32_t color) const { return order.data() + colorStarts[color]; }
+    const uint32_t* end(uint32_t color) const { return order.data() + colorStarts[color + 1]; }
+};
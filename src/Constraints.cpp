@@ -1,106 +1,152 @@
 #include "Constraints.h"
 
-std::tuple<dvec3, double> ApplyPositionDelta(dvec3 changeNormal, double changeMagnitude, RigidBody& a, dvec3 r1, RigidBody& b, dvec3 r2, double alpha)
+std::tuple<rvec3, real> ApplyPositionDelta(rvec3 changeNormal, real changeMagnitude, const BodyStore& bodies, uint32_t a, rvec3 r1, uint32_t b, rvec3 r2, real alpha)
 {
-    double lambda = -changeMagnitude / (a.GetMass(r1, changeNormal) + b.GetMass(r2, changeNormal) + alpha);
-    dvec3 impulse = lambda * changeNormal;
+    real lambda = -changeMagnitude / (bodies.GetMass(a, r1, changeNormal) + bodies.GetMass(b, r2, changeNormal) + alpha);
+    rvec3 impulse = lambda * changeNormal;
 
     return { impulse,lambda };
 }
 
 PenetrationConstraint::PenetrationConstraint() {}
-PenetrationConstraint::PenetrationConstraint(RigidBody& a, RigidBody& b, dvec3 pointA, dvec3 pointB, dvec3 normal, double depth)
-    :a(&a), b(&b), pointA(pointA), pointB(pointB), normal(normal), depth(depth)
+PenetrationConstraint::PenetrationConstraint(uint32_t a, uint32_t b, rvec3 pointA, rvec3 pointB, rvec3 normal, real depth, real normalLambda)
+    :a(a), b(b), pointA(pointA), pointB(pointB), normal(normal), depth(depth), normalLambda(normalLambda)
 {}
 
-dvec3 PenetrationConstraint::GetR1() const
+rvec3 PenetrationConstraint::GetR1(const BodyStore& bodies) const
 {
-    return a->GetRotation() * pointA;
+    return bodies.GetRotation(a) * pointA;
 }
 
-dvec3 PenetrationConstraint::GetR2() const
+rvec3 PenetrationConstraint::GetR2(const BodyStore& bodies) const
 {
-    return b->GetRotation() * pointB;
+    return bodies.GetRotation(b) * pointB;
 }
 
-void PenetrationConstraint::SolvePositions(double deltaT)
+void PenetrationConstraint::WarmStart(BodyStore& bodies)
+{
+    if (normalLambda == 0) return;
+
+    rvec3 impulse = normalLambda * normal;
+    bodies.ApplyPositionalImpulse(a, impulse, GetR1(bodies));
+    bodies.ApplyPositionalImpulse(b, -impulse, GetR2(bodies));
+}
+
+void PenetrationConstraint::SolvePositions(BodyStore& bodies)
 {
     // Points relative to centers of mass.
-    dvec3 r1 = GetR1();
-    dvec3 r2 = GetR2();
-    depth = glm::dot(r1 + a->GetComponent<Transform>().position - (r2 + b->GetComponent<Transform>().position), normal);
+    rvec3 r1 = GetR1(bodies);
+    rvec3 r2 = GetR2(bodies);
+    depth = glm::dot(r1 + bodies.GetPosition(a) - (r2 + bodies.GetPosition(b)), normal);
+
+    if (depth <= 0 && normalLambda == 0) return;
 
-    if (depth <= 0) return;
+    // Handle depenetration, the accumulated lambda can only push the bodies apart.
+    auto [normalImpulse, deltaLambda] = ApplyPositionDelta(normal, depth, bodies, a, r1, b, r2, 0);
+    deltaLambda = std::min(normalLambda + deltaLambda, real(0)) - normalLambda;
+    normalLambda += deltaLambda;
+    normalImpulse = deltaLambda * normal;
+    bodies.ApplyPositionalImpulse(a, normalImpulse, r1);
+    bodies.ApplyPositionalImpulse(b, -normalImpulse, r2);
 
-    // Handle depenetration.
-    auto [normalImpulse, normalLambda] = ApplyPositionDelta(normal, depth, *a, r1, *b, r2, 0);
-    a->ApplyPositionalImpulse(normalImpulse, r1);
-    b->ApplyPositionalImpulse(-normalImpulse, r2);
+    if (normalLambda == 0) return;
 
-    r1 = GetR1();
-    r2 = GetR2();
+    r1 = GetR1(bodies);
+    r2 = GetR2(bodies);
 
     // Handle static friction.
-    dvec3 P1 = r1 + a->GetComponent<Transform>().position;
-    dvec3 P2 = r2 + b->GetComponent<Transform>().position;
-    dvec3 P1_ = a->previousPosition + a->previousRotation * pointA;
-    dvec3 P2_ = b->previousPosition + b->previousRotation * pointB;
-    dvec3 deltaP = (P1 - P1_) - (P2 - P2_);
-    dvec3 deltaPTangential = deltaP - glm::dot(deltaP, normal) * normal;
-    double length = glm::length(deltaPTangential);
+    rvec3 P1 = r1 + bodies.GetPosition(a);
+    rvec3 P2 = r2 + bodies.GetPosition(b);
+    rvec3 P1_ = bodies.GetPreviousPosition(a) + bodies.GetPreviousRotation(a) * pointA;
+    rvec3 P2_ = bodies.GetPreviousPosition(b) + bodies.GetPreviousRotation(b) * pointB;
+    rvec3 deltaP = (P1 - P1_) - (P2 - P2_);
+    rvec3 deltaPTangential = deltaP - glm::dot(deltaP, normal) * normal;
+    real length = glm::length(deltaPTangential);
     if (length != 0)
         deltaPTangential /= length;
 
-    static double sum = 0;
-    static int count = 0;
-    sum += normalLambda;
-    count++;
-    auto [tangentialImpulse, tangentialLambda] = ApplyPositionDelta(deltaPTangential, length, *a, r1, *b, r2, 0);
-    double frictionCeofficient = (a->staticFrictionCoefficient + b->staticFrictionCoefficient) * 0.5;
+    auto [tangentialImpulse, tangentialLambda] = ApplyPositionDelta(deltaPTangential, length, bodies, a, r1, b, r2, 0);
+    real frictionCeofficient = (bodies.staticFriction[a] + bodies.staticFriction[b]) * 0.5;
     if (std::abs(tangentialLambda) < frictionCeofficient * std::abs(normalLambda))
     {
-        a->ApplyPositionalImpulse(tangentialImpulse, r1);
-        b->ApplyPositionalImpulse(-tangentialImpulse, r2);
+        bodies.ApplyPositionalImpulse(a, tangentialImpulse, r1);
+        bodies.ApplyPositionalImpulse(b, -tangentialImpulse, r2);
     }
 }
 
-void PenetrationConstraint::SolveVelocities(double restitutionCutoff, double deltaT)
+void PenetrationConstraint::SolveVelocities(BodyStore& bodies, real restitutionCutoff, real deltaT)
 {
-    if (depth <= 0) return;
+    if (normalLambda == 0 && (!speculative || depth >= 0)) return;
 
-    Transform& aTr = a->GetComponent<Transform>();
-    Transform& bTr = b->GetComponent<Transform>();
-    dvec3 r1 = GetR1();
-    dvec3 r2 = GetR2();
-    dvec3 velocity = (a->velocity + glm::cross(a->angularVelocity, r1)) - (b->velocity + glm::cross(b->angularVelocity, r2));
-    double normalVelocity = glm::dot(normal, velocity);
+    rvec3 r1 = GetR1(bodies);
+    rvec3 r2 = GetR2(bodies);
+    rvec3 velocity = (bodies.GetVelocity(a) + glm::cross(bodies.GetAngularVelocity(a), r1)) - (bodies.GetVelocity(b) + glm::cross(bodies.GetAngularVelocity(b), r2));
+    real normalVelocity = glm::dot(normal, velocity);
 
+    // Kontakt spekulatywny: zbliżanie ograniczone do odległości i dozwolonej głębokości w następnym pod kroku, bez tarcia i restytucji.
+    if (normalLambda == 0)
     {
-        dvec3 tangentialVelocity = velocity - normal * normalVelocity;
-        double tangentialSpeed = glm::length(tangentialVelocity);
+        real maxNormalVelocity = (allowedDepth - depth) / deltaT;
+        if (normalVelocity <= maxNormalVelocity)
+            return;
+
+        rvec3 p = normal * (maxNormalVelocity - normalVelocity) / (bodies.GetMass(a, r1, normal) + bodies.GetMass(b, r2, normal));
+        bodies.ApplyVelocityImpulse(a, p, r1);
+        bodies.ApplyVelocityImpulse(b, -p, r2);
+        return;
+    }
+
+    {
+        rvec3 tangentialVelocity = velocity - normal * normalVelocity;
+        real tangentialSpeed = glm::length(tangentialVelocity);
         if (tangentialSpeed != 0)
             tangentialVelocity /= tangentialSpeed;
-        double frictionCoefficient = (a->dynamicFrictionCoefficient + b->dynamicFrictionCoefficient) * 0.5;
-        double w1 = a->inverseMass + glm::dot(glm::cross(aTr.rotation * r1, tangentialVelocity), a->inverseInertiaTensor * glm::cross(aTr.rotation * r1, tangentialVelocity));
-        double w2 = b->inverseMass + glm::dot(glm::cross(r2, tangentialVelocity), b->inverseInertiaTensor * glm::cross(r2, tangentialVelocity));
-        dvec3 frictionDeltaV = -tangentialVelocity * std::min(frictionCoefficient * std::abs(normalLambda / (deltaT * deltaT)), tangentialSpeed);
-        dvec3 p = frictionDeltaV / (a->GetMass(r1, tangentialVelocity) + b->GetMass(r2, tangentialVelocity));
-        a->ApplyVelocityImpulse(p, r1);
-        b->ApplyVelocityImpulse(-p, r2);
+        real frictionCoefficient = (bodies.dynamicFriction[a] + bodies.dynamicFriction[b]) * 0.5;
+        rvec3 frictionDeltaV = -tangentialVelocity * std::min(frictionCoefficient * std::abs(normalLambda / (deltaT * deltaT)), tangentialSpeed);
+        rvec3 p = frictionDeltaV / (bodies.GetMass(a, r1, tangentialVelocity) + bodies.GetMass(b, r2, tangentialVelocity));
+        bodies.ApplyVelocityImpulse(a, p, r1);
+        bodies.ApplyVelocityImpulse(b, -p, r2);
     }
 
     // Handle restitution.
-    double restitution = (a->restitutionCoefficient + b->restitutionCoefficient) * 0.5;
+    real restitution = (bodies.restitution[a] + bodies.restitution[b]) * 0.5;
     if (glm::abs(normalVelocity) <= 2 * restitutionCutoff * deltaT)
         restitution = 0.0;
 
-    dvec3 previousVelocity = (a->previousVelocity + glm::cross(a->previousAngularVelocity, r1)) - (b->previousVelocity + glm::cross(b->previousAngularVelocity, r2));
-    double previousNormalVelocity = glm::dot(normal, previousVelocity);
-    dvec3 deltaV = normal * (-normalVelocity + std::min(-restitution * previousNormalVelocity, 0.0));
-    double w1 = a->inverseMass + glm::dot(glm::cross(aTr.rotation * r1, normal), a->inverseInertiaTensor * glm::cross(aTr.rotation * r1, normal));
-    double w2 = b->inverseMass + glm::dot(glm::cross(r2, normal), b->inverseInertiaTensor * glm::cross(r2, normal));
-    dvec3 p = deltaV / (w1 + w2);
+    rvec3 previousVelocity = (bodies.GetPreviousVelocity(a) + glm::cross(bodies.GetPreviousAngularVelocity(a), r1)) - (bodies.GetPreviousVelocity(b) + glm::cross(bodies.GetPreviousAngularVelocity(b), r2));
+    real previousNormalVelocity = glm::dot(normal, previousVelocity);
+    rvec3 deltaV = normal * (-normalVelocity + std::min(-restitution * previousNormalVelocity, real(0)));
+    rvec3 p = deltaV / (bodies.GetMass(a, r1, normal) + bodies.GetMass(b, r2, normal));
+
+    bodies.ApplyVelocityImpulse(a, p, r1);
+    bodies.ApplyVelocityImpulse(b, -p, r2);
+}
+
+void ContactManifold::AddPoint(rvec3 pointA, rvec3 pointB, real depth, uint32_t feature)
+{
+    if (pointCount == maxPoints) return;
+
+    points[pointCount++] = { pointA, pointB, depth, feature, 0.0 };
+}
+
+void ContactManifold::WarmStart(const ContactManifold& previous, real deltaT)
+{
+    const real minNormalCosine = 0.95;
+
+    if (previous.pointCount == 0 || previous.deltaT == 0 || glm::dot(normal, previous.normal) < minNormalCosine)
+        return;
 
-    a->ApplyVelocityImpulse(p, r1);
-    b->ApplyVelocityImpulse(-p, r2);
-}
\ No newline at end of file
+    // Mnożnik pozycyjny to siła razy kwadrat kroku czasowego.
+    real scale = (deltaT / previous.deltaT) * (deltaT / previous.deltaT);
+    for (int i = 0; i < pointCount; i++)
+    {
+        for (int j = 0; j < previous.pointCount; j++)
+        {
+            if (points[i].feature == previous.points[j].feature)
+            {
+                points[i].normalLambda = previous.points[j].normalLambda * scale;
+                break;
+            }
+        }
+    }
+}
@@ -1,39 +1,89 @@
 #pragma once
-#include <glm/glm.hpp>
-#include <glm/gtc/quaternion.hpp>
+#include "Real.h"
 #include "Components.h"
-using dvec2 = glm::dvec2;
-using dvec3 = glm::dvec3;
-using dquat = glm::dquat;
+#include "BodyStore.h"
+#include <cstdint>
 
 /// @brief Ogarnicznik penetracji, używany przy odpowiedzi na kolizje.
+/// @details Obiekty są indeksami w BodyStore, przez który ogranicznik czyta i zmienia ich stan.
 class PenetrationConstraint
 {
 public:
-    RigidBody* a;
-    RigidBody* b;
-    dvec3 pointA;
-    dvec3 pointB;
-    dvec3 normal;
-    double depth;
+    uint32_t a;
+    uint32_t b;
+    rvec3 pointA;
+    rvec3 pointB;
+    rvec3 normal;
+    real depth;
+    /// @brief Czy ogranicznik pochodzi z kontaktu spekulatywnego rozdzielonych obiektów.
+    /// @details Dopóki obiekty się nie przenikają, ogranicznik tylko zmniejsza w SolveVelocities prędkość zbliżania,
+    /// tak by w następnym pod kroku weszły w siebie najwyżej na allowedDepth.
+    bool speculative = false;
+    /// @brief Głębokość, na jaką obiekty kontaktu spekulatywnego mogą w siebie wejść w następnym pod kroku.
+    real allowedDepth = 0;
 
 private:
-    double normalLambda;
+    /// @brief Suma mnożników normalnych w pod kroku, nigdy dodatnia, bo kolizja może tylko odpychać obiekty.
+    real normalLambda;
 
 public:
     PenetrationConstraint();
-    PenetrationConstraint(RigidBody& a, RigidBody& b, dvec3 pointA, dvec3 pointB, dvec3 normal, double depth);
+    /// @param normalLambda mnożnik z poprzedniego pod kroku, nakładany przez WarmStart
+    PenetrationConstraint(uint32_t a, uint32_t b, rvec3 pointA, rvec3 pointB, rvec3 normal, real depth, real normalLambda = 0);
+
+    /// @brief Nakłada impuls pozycyjny z mnożnika poprzedniego pod kroku, wywoływane dla wszystkich ograniczników przed SolvePositions.
+    void WarmStart(BodyStore& bodies);
 
     /// @brief Rozwiązuje pozycje obiektów biorących udział.
-    /// @param deltaT zmiana w czasie
-    void SolvePositions(double deltaT);
+    /// @details Mnożnik po rozgrzaniu może zostać zmniejszony aż do zera, jeżeli obiekty zostały wypchnięte za daleko.
+    void SolvePositions(BodyStore& bodies);
+
+    real GetNormalLambda() const { return normalLambda; }
 
     /// @brief Rozwiązuje prędkości obiektów biorących udział.
     /// @param restitutionCutoff granica prędkości normalnej poniżej której restytucja jest ustawiana na 0
     /// @param deltaT zmiana w czasie
-    void SolveVelocities(double restitutionCutoff, double deltaT);
+    void SolveVelocities(BodyStore& bodies, real restitutionCutoff, real deltaT);
 
 private:
-    dvec3 GetR1() const;
-    dvec3 GetR2() const;
-};
\ No newline at end of file
+    rvec3 GetR1(const BodyStore& bodies) const;
+    rvec3 GetR2(const BodyStore& bodies) const;
+};
+
+/// @brief Punkt styku w rozmaitości kontaktowej, punkty w lokalnych układach obiektów.
+struct ContactPoint
+{
+    rvec3 pointA;
+    rvec3 pointB;
+    real depth;
+    /// @brief Identyfikator cech obiektów (ściany, krawędzi, wierzchołka), które utworzyły punkt, stały między pod krokami.
+    uint32_t feature;
+    /// @brief Mnożnik normalny z ostatniego pod kroku.
+    real normalLambda;
+};
+
+/// @brief Rozmaitość kontaktowa pary obiektów, do 4 punktów o wspólnej normalnej.
+/// @details Przechowywana między pod krokami i klatkami, punkty dopasowywane są po identyfikatorze cech,
+/// a ich mnożniki rozgrzewają rozwiązywanie pozycji w kolejnym pod kroku.
+struct ContactManifold
+{
+    static constexpr int maxPoints = 4;
+
+    /// @brief Normalna kolizji, wspólna dla wszystkich punktów, jak w PenetrationConstraint.
+    rvec3 normal;
+    ContactPoint points[maxPoints];
+    int pointCount = 0;
+    /// @brief Długość pod kroku, w którym wyznaczono mnożniki.
+    real deltaT = 0;
+    /// @brief Czy punkty są kontaktem spekulatywnym rozdzielonej pary, a nie faktycznym stykiem.
+    bool speculative = false;
+
+    /// @brief Dodaje punkt z zerowym mnożnikiem, jeżeli jest miejsce.
+    void AddPoint(rvec3 pointA, rvec3 pointB, real depth, uint32_t feature);
+
+    /// @brief Przenosi mnożniki z @p previous do punktów o tych samych cechach.
+    /// @details Mnożniki skalowane są przez kwadrat stosunku długości pod kroków, jeżeli normalna znacząco się obróciła nic nie jest przenoszone.
+    /// @param previous rozmaitość z poprzedniego pod kroku
+    /// @param deltaT długość aktualnego pod kroku
+    void WarmStart(const ContactManifold& previous, real deltaT);
+};
@@ -0,0 +1,261 @@
+#include "DynamicAABBTree.h"
+#include <algorithm>
+
+DynamicAABBTree::DynamicAABBTree() :root(nullNode), freeList(nullNode) {}
+
+int32_t DynamicAABBTree::AllocateNode()
+{
+    if (freeList == nullNode)
+    {
+        nodes.emplace_back();
+        nodes.back().next = nullNode;
+        freeList = nodes.size() - 1;
+    }
+
+    int32_t nodeID = freeList;
+    freeList = nodes[nodeID].next;
+
+    Node& node = nodes[nodeID];
+    node.parent = nullNode;
+    node.children[0] = nullNode;
+    node.children[1] = nullNode;
+    node.height = 0;
+    node.userData = 0;
+    return nodeID;
+}
+
+void DynamicAABBTree::FreeNode(int32_t nodeID)
+{
+    nodes[nodeID].next = freeList;
+    nodes[nodeID].height = -1;
+    freeList = nodeID;
+}
+
+int32_t DynamicAABBTree::CreateProxy(const AABB& box, uint32_t userData, real margin)
+{
+    int32_t proxy = AllocateNode();
+    nodes[proxy].box = box.Expanded(margin);
+    nodes[proxy].userData = userData;
+    InsertLeaf(proxy);
+
+    return proxy;
+}
+
+void DynamicAABBTree::DestroyProxy(int32_t proxy)
+{
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+}
+
+bool DynamicAABBTree::MoveProxy(int32_t proxy, const AABB& box, real margin)
+{
+    if (nodes[proxy].box.Contains(box))
+        return false;
+
+    RemoveLeaf(proxy);
+    nodes[proxy].box = box.Expanded(margin);
+    InsertLeaf(proxy);
+
+    return true;
+}
+
+void DynamicAABBTree::Clear()
+{
+    nodes.clear();
+    root = nullNode;
+    freeList = nullNode;
+}
+
+void DynamicAABBTree::InsertLeaf(int32_t leaf)
+{
+    if (root == nullNode)
+    {
+        root = leaf;
+        nodes[root].parent = nullNode;
+        return;
+    }
+
+    // Zejdź w dół drzewa wybierając dziecko, którego powiększenie najmniej zwiększa sumę pól powierzchni (SAH).
+    AABB leafBox = nodes[leaf].box;
+    int32_t index = root;
+    while (!nodes[index].IsLeaf())
+    {
+        const Node& node = nodes[index];
+        real area = node.box.SurfaceArea();
+        real combinedArea = AABB::Union(node.box, leafBox).SurfaceArea();
+
+        // Koszt stworzenia nowego rodzica dla tego węzła i liścia.
+        real cost = 2.0 * combinedArea;
+        // Minimalny koszt zejścia niżej, każdy przodek musi zostać powiększony.
+        real inheritanceCost = 2.0 * (combinedArea - area);
+
+        real childCost[2];
+        for (int i = 0; i < 2; i++)
+        {
+            const Node& child = nodes[node.children[i]];
+            real newArea = AABB::Union(child.box, leafBox).SurfaceArea();
+            childCost[i] = child.IsLeaf() ? newArea + inheritanceCost : newArea - child.box.SurfaceArea() + inheritanceCost;
+        }
+
+        if (cost < childCost[0] && cost < childCost[1])
+            break;
+
+        index = childCost[0] < childCost[1] ? node.children[0] : node.children[1];
+    }
+
+    // Stwórz nowego rodzica dla znalezionego rodzeństwa i liścia.
+    int32_t sibling = index;
+    int32_t oldParent = nodes[sibling].parent;
+    int32_t newParent = AllocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].box = AABB::Union(leafBox, nodes[sibling].box);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].children[0] = sibling;
+    nodes[newParent].children[1] = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent == nullNode)
+        root = newParent;
+    else if (nodes[oldParent].children[0] == sibling)
+        nodes[oldParent].children[0] = newParent;
+    else
+        nodes[oldParent].children[1] = newParent;
+
+    Refit(nodes[leaf].parent);
+}
+
+void DynamicAABBTree::RemoveLeaf(int32_t leaf)
+{
+    if (leaf == root)
+    {
+        root = nullNode;
+        return;
+    }
+
+    // Rodzic liścia jest usuwany, a jego miejsce zajmuje rodzeństwo liścia.
+    int32_t parent = nodes[leaf].parent;
+    int32_t grandParent = nodes[parent].parent;
+    int32_t sibling = nodes[parent].children[0] == leaf ? nodes[parent].children[1] : nodes[parent].children[0];
+
+    if (grandParent == nullNode)
+    {
+        root = sibling;
+        nodes[sibling].parent = nullNode;
+        FreeNode(parent);
+        return;
+    }
+
+    if (nodes[grandParent].children[0] == parent)
+        nodes[grandParent].children[0] = sibling;
+    else
+        nodes[grandParent].children[1] = sibling;
+    nodes[sibling].parent = grandParent;
+    FreeNode(parent);
+
+    Refit(grandParent);
+}
+
+void DynamicAABBTree::Refit(int32_t nodeID)
+{
+    // Przejdź w górę drzewa dopasowując prostopadłościany i wysokości, po drodze wykonując rotacje.
+    while (nodeID != nullNode)
+    {
+        Rotate(nodeID);
+
+        Node& node = nodes[nodeID];
+        const Node& child1 = nodes[node.children[0]];
+        const Node& child2 = nodes[node.children[1]];
+        node.height = 1 + std::max(child1.height, child2.height);
+        node.box = AABB::Union(child1.box, child2.box);
+
+        nodeID = node.parent;
+    }
+}
+
+void DynamicAABBTree::Rotate(int32_t iA)
+{
+    // Rotacja zamienia dziecko węzła A z wnukiem z drugiego poddrzewa, jeżeli zmniejsza to sumę pól powierzchni (SAH).
+    /*       A
+           /   \
+          B     C
+         / \   / \
+        D   E F   G   */
+    Node& A = nodes[iA];
+    if (A.height < 2)
+        return;
+
+    int32_t iB = A.children[0];
+    int32_t iC = A.children[1];
+    Node& B = nodes[iB];
+    Node& C = nodes[iC];
+
+    enum class Rotation { None, BF, BG, CD, CE, DF, DG } bestRotation = Rotation::None;
+    real bestCost = 0;
+
+    if (!C.IsLeaf())
+    {
+        // Zamiana B z F lub G zmienia tylko węzeł C.
+        real areaC = C.box.SurfaceArea();
+        real costBF = AABB::Union(B.box, nodes[C.children[1]].box).SurfaceArea() - areaC;
+        real costBG = AABB::Union(B.box, nodes[C.children[0]].box).SurfaceArea() - areaC;
+        if (costBF < bestCost) { bestCost = costBF; bestRotation = Rotation::BF; }
+        if (costBG < bestCost) { bestCost = costBG; bestRotation = Rotation::BG; }
+    }
+
+    if (!B.IsLeaf())
+    {
+        // Zamiana C z D lub E zmienia tylko węzeł B.
+        real areaB = B.box.SurfaceArea();
+        real costCD = AABB::Union(C.box, nodes[B.children[1]].box).SurfaceArea() - areaB;
+        real costCE = AABB::Union(C.box, nodes[B.children[0]].box).SurfaceArea() - areaB;
+        if (costCD < bestCost) { bestCost = costCD; bestRotation = Rotation::CD; }
+        if (costCE < bestCost) { bestCost = costCE; bestRotation = Rotation::CE; }
+    }
+
+    if (!B.IsLeaf() && !C.IsLeaf())
+    {
+        // Zamiana wnuków zmienia oba węzły B i C.
+        const AABB& D = nodes[B.children[0]].box;
+        const AABB& E = nodes[B.children[1]].box;
+        const AABB& F = nodes[C.children[0]].box;
+        const AABB& G = nodes[C.children[1]].box;
+        real area = B.box.SurfaceArea() + C.box.SurfaceArea();
+        real costDF = AABB::Union(F, E).SurfaceArea() + AABB::Union(D, G).SurfaceArea() - area;
+        real costDG = AABB::Union(G, E).SurfaceArea() + AABB::Union(F, D).SurfaceArea() - area;
+        if (costDF < bestCost) { bestCost = costDF; bestRotation = Rotation::DF; }
+        if (costDG < bestCost) { bestCost = costDG; bestRotation = Rotation::DG; }
+    }
+
+    switch (bestRotation)
+    {
+    case Rotation::None: return;
+    case Rotation::BF: SwapNodes(iA, 0, iC, 0); break;
+    case Rotation::BG: SwapNodes(iA, 0, iC, 1); break;
+    case Rotation::CD: SwapNodes(iA, 1, iB, 0); break;
+    case Rotation::CE: SwapNodes(iA, 1, iB, 1); break;
+    case Rotation::DF: SwapNodes(iB, 0, iC, 0); break;
+    case Rotation::DG: SwapNodes(iB, 0, iC, 1); break;
+    }
+
+    // Dopasuj węzły B i C, A zostanie dopasowany przez wywołującego.
+    for (int32_t nodeID : { iB, iC })
+    {
+        Node& node = nodes[nodeID];
+        if (node.IsLeaf())
+            continue;
+
+        node.box = AABB::Union(nodes[node.children[0]].box, nodes[node.children[1]].box);
+        node.height = 1 + std::max(nodes[node.children[0]].height, nodes[node.children[1]].height);
+    }
+}
+
+void DynamicAABBTree::SwapNodes(int32_t parent1, int child1, int32_t parent2, int child2)
+{
+    int32_t a = nodes[parent1].children[child1];
+    int32_t b = nodes[parent2].children[child2];
+    nodes[parent1].children[child1] = b;
+    nodes[parent2].children[child2] = a;
+    nodes[a].parent = parent2;
+    nodes[b].parent = parent1;
+}
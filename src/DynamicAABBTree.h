@@ -0,0 +1,186 @@
+#pragma once
+#include "Real.h"
+#include <vector>
+#include <cstdint>
+
+/// @brief Prostopadłościan otaczający wyrównany do osi układu współrzędnych.
+struct AABB
+{
+    rvec3 min;
+    rvec3 max;
+
+    AABB() {}
+    AABB(const rvec3& min, const rvec3& max) :min(min), max(max) {}
+
+    /// @brief Tworzy prostopadłościan otaczający kulę.
+    /// @param center środek kuli
+    /// @param radius promień kuli
+    static AABB FromSphere(const rvec3& center, real radius)
+    {
+        return AABB(center - rvec3(radius), center + rvec3(radius));
+    }
+
+    /// @brief Najmniejszy prostopadłościan zawierający @p a oraz @p b .
+    static AABB Union(const AABB& a, const AABB& b)
+    {
+        return AABB(glm::min(a.min, b.min), glm::max(a.max, b.max));
+    }
+
+    /// @brief Powiększa prostopadłościan o @p margin w każdym kierunku.
+    AABB Expanded(real margin) const
+    {
+        return AABB(min - rvec3(margin), max + rvec3(margin));
+    }
+
+    bool Contains(const AABB& other) const
+    {
+        return
+            min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+            other.max.x <= max.x && other.max.y <= max.y && other.max.z <= max.z;
+    }
+
+    bool Overlaps(const AABB& other) const
+    {
+        return
+            min.x <= other.max.x && other.min.x <= max.x &&
+            min.y <= other.max.y && other.min.y <= max.y &&
+            min.z <= other.max.z && other.min.z <= max.z;
+    }
+
+    /// @brief Pole powierzchni, używane jako koszt węzła w heurystyce SAH.
+    real SurfaceArea() const
+    {
+        rvec3 d = max - min;
+        return 2.0 * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+};
+
+/// @brief Dynamiczne drzewo prostopadłościanów otaczających (BVH) używane w szerokiej fazie wykrywania kolizji.
+/// @details Liście przechowują powiększone prostopadłościany, dzięki czemu niewielki ruch obiektu nie wymaga zmiany drzewa.
+/// Gdy obiekt wyjdzie poza swój prostopadłościan, liść jest przenoszony w najtańsze miejsce według heurystyki SAH,
+/// a przodkowie są dopasowywani i poprawiani rotacjami zmniejszającymi sumę pól powierzchni węzłów.
+class DynamicAABBTree
+{
+public:
+    static constexpr int32_t nullNode = -1;
+
+private:
+    struct Node
+    {
+        AABB box;
+        union
+        {
+            int32_t parent;
+            int32_t next;
+        };
+        int32_t children[2];
+        int32_t height;
+        uint32_t userData;
+
+        bool IsLeaf() const { return children[0] == nullNode; }
+    };
+
+    std::vector<Node> nodes;
+    int32_t root;
+    int32_t freeList;
+    mutable std::vector<int32_t> stack;
+
+public:
+    DynamicAABBTree();
+
+    /// @brief Dodaje liść do drzewa.
+    /// @param box prostopadłościan obiektu
+    /// @param userData dane użytkownika, np. indeks obiektu
+    /// @param margin o ile powiększyć prostopadłościan zapisany w liściu
+    /// @return identyfikator liścia
+    int32_t CreateProxy(const AABB& box, uint32_t userData, real margin);
+
+    /// @brief Usuwa liść z drzewa.
+    /// @param proxy identyfikator liścia
+    void DestroyProxy(int32_t proxy);
+
+    /// @brief Aktualizuje położenie liścia.
+    /// @details Jeżeli @p box mieści się w zapisanym prostopadłościanie nic się nie dzieje,
+    /// w przeciwnym wypadku liść dostaje nowy powiększony prostopadłościan i jest wstawiany na nowo.
+    /// @param proxy identyfikator liścia
+    /// @param box aktualny prostopadłościan obiektu
+    /// @param margin o ile powiększyć nowy prostopadłościan
+    /// @return Prawda jeżeli liść został przeniesiony
+    bool MoveProxy(int32_t proxy, const AABB& box, real margin);
+
+    const AABB& GetFatAABB(int32_t proxy) const { return nodes[proxy].box; }
+    uint32_t GetUserData(int32_t proxy) const { return nodes[proxy].userData; }
+    void SetUserData(int32_t proxy, uint32_t userData) { nodes[proxy].userData = userData; }
+
+    /// @brief Usuwa wszystkie liście.
+    void Clear();
+
+    /// @brief Wysokość drzewa, 0 dla pustego drzewa.
+    int GetHeight() const { return root == nullNode ? 0 : nodes[root].height + 1; }
+
+    /// @brief Wywołuje @p callback dla każdego liścia, którego prostopadłościan nachodzi na @p box .
+    /// @param box prostopadłościan zapytania
+    /// @param callback funkcja przyjmująca identyfikator liścia oraz jego dane użytkownika
+    template <typename TCallback>
+    void Query(const AABB& box, TCallback&& callback) const
+    {
+        if (root == nullNode)
+            return;
+
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty())
+        {
+            int32_t nodeID = stack.back();
+            stack.pop_back();
+
+            const Node& node = nodes[nodeID];
+            if (!node.box.Overlaps(box))
+                continue;
+
+            if (node.IsLeaf())
+                callback(nodeID, node.userData);
+            else
+            {
+                stack.push_back(node.children[0]);
+                stack.push_back(node.children[1]);
+            }
+        }
+    }
+
+    /// @brief Wywołuje @p callback dla każdego liścia w kolejności przejścia drzewa w głąb.
+    /// @details Kolejne liście leżą blisko siebie w przestrzeni, więc zapytania w tej kolejności lepiej wykorzystują pamięć podręczną.
+    /// @param callback funkcja przyjmująca identyfikator liścia oraz jego dane użytkownika
+    template <typename TCallback>
+    void ForEachLeaf(TCallback&& callback) const
+    {
+        if (root == nullNode)
+            return;
+
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty())
+        {
+            int32_t nodeID = stack.back();
+            stack.pop_back();
+
+            const Node& node = nodes[nodeID];
+            if (node.IsLeaf())
+                callback(nodeID, node.userData);
+            else
+            {
+                stack.push_back(node.children[1]);
+                stack.push_back(node.children[0]);
+            }
+        }
+    }
+
+private:
+    int32_t AllocateNode();
+    void FreeNode(int32_t nodeID);
+    void InsertLeaf(int32_t leaf);
+    void RemoveLeaf(int32_t leaf);
+    void Refit(int32_t nodeID);
+    void Rotate(int32_t nodeID);
+    void SwapNodes(int32_t parent1, int child1, int32_t parent2, int child2);
+};
@@ -247,7 +247,7 @@ namespace ECS
     template <ComponentDerived UComponent, typename TEntity>
     bool Component<TComponent>::HasComponent() const
     {
-        return TEntity::entities[entityIndex].template HasComponent<UComponent>();
+        return System<UComponent>::IsValid(TEntity::entities[entityIndex].template GetIndex<UComponent>());
     }
 
     template <typename TComponent>
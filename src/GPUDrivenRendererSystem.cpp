@@ -1,5 +1,7 @@
 #include <unordered_map>
 #include "GPUDrivenRendererSystem.h"
+#include "ThreadPool.h"
+#include "Profiler.h"
 #include <string>
 
 vg::RenderPass GPUDrivenRendererSystem::renderPass;
@@ -7,6 +9,7 @@ vg::RenderPass GPUDrivenRendererSystem::depthPrepass;
 vg::ComputePipeline GPUDrivenRendererSystem::computeRenderer;
 vg::ComputePipeline GPUDrivenRendererSystem::clearInstructions;
 const vg::Queue* GPUDrivenRendererSystem::queue = nullptr;
+glm::mat4(*GPUDrivenRendererSystem::instanceMatrix)(const Transform& transform) = [](const Transform& transform) { return transform.Matrix(); };
 int objectCount = 0;
 
 std::tuple<vg::Subpass, vg::SubpassDependency> CreateSubpass(Material&& material, int childrenCount)
@@ -348,6 +351,7 @@ void GPUDrivenRendererSystem::RemoveRenderObject(uint32_t id)
 
 void GPUDrivenRendererSystem::GetRenderCommands(const vg::Image& depthImage, const vg::ImageView& depthView, vg::CmdBuffer& buffer, const glm::mat4& cameraView, const glm::mat4& cameraProjection, const vg::Framebuffer& framebuffer, uint32_t width, uint32_t height)
 {
+    PROFILE_ZONE("GPUDrivenRendererSystem::GetRenderCommands");
     if (objectsBuffer.size() == 0)
         return;
 
@@ -370,11 +374,14 @@ void GPUDrivenRendererSystem::GetRenderCommands(const vg::Image& depthImage, con
     renderDescriptor.AttachBuffer(vg::DescriptorType::StorageBuffer, instanceBuffer, 0, instanceBuffer.byte_size(), 1, 0);
     renderDescriptor.AttachBuffer(vg::DescriptorType::StorageBuffer, objectsBuffer, 0, objectsBuffer.byte_size(), 2, 0);
     renderDescriptor.AttachBuffer(vg::DescriptorType::StorageBuffer, batchMaterial, 0, batchMaterial.byte_size(), 3, 0);
-    for (int i = 0; i < ECS::System<Transform>::components.size(); i++)
-    {
-        auto& mesh = ECS::System<Transform>::components[i].GetComponent<MeshArray>();
-        instanceBuffer[&mesh - &components[0]] = ECS::System<Transform>::components[i].Matrix();
-    }
+    // Macierze obiektów są niezależne, więc liczone są równolegle, przy interpolacji stanów fizyki to większość czasu przygotowania klatki.
+    ThreadPool::ParallelFor(ECS::System<Transform>::components.size(), 1024, [&](uint32_t begin, uint32_t end, uint32_t thread) {
+        for (uint32_t i = begin; i < end; i++)
+        {
+            auto& mesh = ECS::System<Transform>::components[i].GetComponent<MeshArray>();
+            instanceBuffer[&mesh - &components[0]] = instanceMatrix(ECS::System<Transform>::components[i]);
+        }
+        });
 
     cameraMatrices[0] = cameraProjection;
     cameraMatrices[1] = cameraView;
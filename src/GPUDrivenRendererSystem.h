@@ -50,6 +50,9 @@ class GPUDrivenRendererSystem : public ECS::System<MeshArray>
 
 public:
     static vg::RenderPass renderPass;
+    /// @brief Wyznacza macierz instancji obiektu z jego transformacji, domyślnie Transform::Matrix .
+    /// @details Pozwala rysować obiekty w położeniu innym niż stan symulacji, na przykład interpolowanym między krokami fizyki.
+    static glm::mat4 (*instanceMatrix)(const Transform& transform);
 
 private:
     enum class BufferUpdate
@@ -74,4 +74,12 @@ bool LoadMesh(const char* meshPath, std::vector<glm::vec3>* vertices, std::vecto
         meshFile >> prefix;
     }
     return true;
+}
+
+ThreadPool::TaskHandle LoadMeshAsync(const char* meshPath, std::vector<glm::vec3>* vertices, std::vector<glm::vec3>* normals, std::vector<unsigned int>* triangles)
+{
+    return ThreadPool::Submit([path = std::string(meshPath), vertices, normals, triangles]() {
+        if (!LoadMesh(path.c_str(), vertices, normals, triangles))
+            std::cout << "Unable to load " << path << '\n';
+        });
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <glm/glm.hpp>
+#include "ThreadPool.h"
 
 /// @brief Funkcja wczytująca dane z pliku .obj, wspiera siatki złożone tylko z trójkątów, by uzyskać twarde normalne trzeba zduplikować punkty siatki.
 /// @param meshPath 
@@ -9,4 +10,9 @@
 /// @param triangles 
 /// @return 
 bool LoadMesh(const char* meshPath, std::vector<glm::vec3>* vertices, std::vector<glm::vec3>* normals, std::vector<unsigned int>* triangles);
-std::tuple<std::vector<glm::vec3>, std::vector<glm::vec3>, std::vector<unsigned int>> LoadMesh(const char* meshPath);
\ No newline at end of file
+std::tuple<std::vector<glm::vec3>, std::vector<glm::vec3>, std::vector<unsigned int>> LoadMesh(const char* meshPath);
+
+/// @brief Wczytuje plik .obj w zadaniu ThreadPool, wiele plików może być wczytywanych jednocześnie.
+/// @details Wektory wyjściowe muszą istnieć do zakończenia zadania, przy błędzie wypisywany jest komunikat, a wektory zostają puste.
+/// @return uchwyt zadania, na które należy poczekać ThreadPool::Wait przed użyciem danych
+ThreadPool::TaskHandle LoadMeshAsync(const char* meshPath, std::vector<glm::vec3>* vertices, std::vector<glm::vec3>* normals, std::vector<unsigned int>* triangles);
\ No newline at end of file
@@ -1,97 +1,908 @@
 #pragma once
 #include "Components.h"
+#include "BodyStore.h"
 #include "ColliderManager.h"
+#include "ConstraintColoring.h"
+#include "SimulationIslands.h"
+#include "ThreadPool.h"
+#include "Profiler.h"
 #include <math.h>
 #include <queue>
-
-using dvec2 = glm::dvec2;
-using dvec3 = glm::dvec3;
-using dquat = glm::dquat;
+#include <limits>
+#include <algorithm>
+#include <chrono>
 
 /// @brief System zajmujący się dynamiką obiektów sztywnych.
 /// @details Działa na podstawie metody XPBD(Extended Position Based Dynamics), kolizje wykrywane są z pomocą klasy ColliderManager.
+/// Ograniczniki są dzielone na kolory bez wspólnych obiektów dynamicznych i rozwiązywane równolegle w ThreadPool.
+/// Krok wykonywany jest na kopii stanu obiektów w BodyStore, zapisywanej do komponentów Transform i RigidBody raz na koniec kroku.
+/// Wyspy obiektów, które długo spoczywają, są usypiane i pomijane aż do kontaktu z obudzonym obiektem lub wywołania AddForce.
+/// Szybkie obiekty są zatrzymywane w chwili zderzenia wyznaczonej przed pod krokami, dzięki czemu nie przelatują przez cienkie obiekty.
+/// Rozdzielone pary, które zbliżają się szybciej niż pozwala faza wąska, dostają kontakty spekulatywne ograniczające prędkość zbliżania.
+/// W trybie adaptacyjnym liczba pod kroków wybierana jest w każdym kroku na podstawie ruchu par i kontaktów z poprzedniego kroku.
+/// Advance wykonuje kroki o stałej długości deltaT niezależnie od czasu klatki, a GetInterpolatedTransform podaje położenie do rysowania.
 /// @ref ColliderManager
 class Physics : public ECS::System<RigidBody>
 {
 public:
-    static dvec3 gravity;
-    static double deltaT;
+    static rvec3 gravity;
+    static real deltaT;
     static int subStepCount;
-    static double restitutionMult;
-    static double dynamicFrictionMult;
-    static double staticFrictionMult;
+    static real restitutionMult;
+    static real dynamicFrictionMult;
+    static real staticFrictionMult;
+
+    /// @brief Pary z szerokiej fazy, bufor jest używany ponownie w kolejnych krokach.
+    static CollisionPairBuffer possibleColliders;
+    /// @brief Wyniki GJK dla każdej pary z possibleColliders, w tej samej kolejności.
+    static std::vector<GJKCache> gjkCaches;
+    /// @brief Rozmaitości kontaktowe dla każdej pary z possibleColliders, przechowywane między pod krokami i klatkami.
+    static std::vector<ContactManifold> manifolds;
+    /// @brief Czy mnożniki z poprzedniego pod kroku są nakładane przed rozwiązywaniem pozycji.
+    static bool warmStarting;
+
+    /// @brief Czy spoczywające wyspy obiektów są usypiane.
+    static bool allowSleeping;
+    /// @brief Średnia prędkość liniowa w oknie timeToSleep, poniżej której obiekt uznawany jest za spoczywający.
+    static real sleepLinearVelocity;
+    /// @brief Średnia prędkość kątowa w oknie timeToSleep, poniżej której obiekt uznawany jest za spoczywający.
+    static real sleepAngularVelocity;
+    /// @brief Jak długo wszystkie obiekty wyspy muszą spoczywać, by została uśpiona.
+    static real timeToSleep;
+
+    /// @brief Czy szybkie pary są sprawdzane przez ColliderManager::TimeOfImpact i zatrzymywane w chwili zderzenia (CCD).
+    static bool continuousCollisions;
+    /// @brief Część sumy promieni kul wpisanych w obiekty pary, o którą muszą się zbliżyć w jednym pod kroku, by para była sprawdzana przez CCD.
+    static real ccdMotionThreshold;
+    /// @brief Odległość, na którą CCD zbliża obiekty, jako część promienia kuli wpisanej w cieńszy z nich, obiekty wchodzą w siebie na tyle samo.
+    static real ccdTolerance;
+
+    /// @brief Czy rozdzielone, szybko zbliżające się pary dostają kontakty spekulatywne z ujemną głębokością.
+    /// @details Kula w szerokiej fazie jest wtedy powiększana tylko o drogę obiektu w kroku, a nie proporcjonalnie do jego rozmiaru.
+    static bool speculativeContacts;
+    /// @brief Część sumy promieni kul wpisanych, na jaką obiekty pary mogą w siebie wejść w jednym pod kroku bez kontaktu spekulatywnego.
+    static real speculativeDepth;
+
+    /// @brief Czy liczba pod kroków jest wybierana w każdym kroku przez ChooseSubStepCount zamiast brana z subStepCount.
+    static bool adaptiveSubSteps;
+    /// @brief Najmniejsza liczba pod kroków w trybie adaptacyjnym.
+    static int minSubStepCount;
+    /// @brief Największa liczba pod kroków w trybie adaptacyjnym.
+    static int maxSubStepCount;
+    /// @brief Część sumy promieni kul wpisanych w obiekty pary, o którą para może się zbliżyć w jednym pod kroku w trybie adaptacyjnym.
+    static real adaptiveMotion;
+    /// @brief Głębokość penetracji, powyżej której tryb adaptacyjny proporcjonalnie zwiększa liczbę pod kroków.
+    static real adaptiveDepth;
+    /// @brief Liczba ograniczników, przy której tryb adaptacyjny dodaje pod krok, każde kolejne podwojenie dodaje następny.
+    static uint32_t adaptiveConstraintCount;
+
+    /// @brief Dane o ostatnim kroku, z których tryb adaptacyjny wybiera liczbę pod kroków kolejnego, oraz czasy jego faz.
+    struct StepStats
+    {
+        /// @brief Liczba pod kroków wykonanych w kroku.
+        int subStepCount = 0;
+        /// @brief Największe zbliżenie pary w kroku jako część sumy promieni kul wpisanych, wyznaczane tylko w trybie adaptacyjnym.
+        real maxMotion = 0;
+        /// @brief Największa głębokość penetracji we wszystkich pod krokach kroku.
+        real maxDepth = 0;
+        /// @brief Liczba ograniczników penetracji z ostatniego pod kroku, bez spekulatywnych.
+        uint32_t constraintCount = 0;
+        /// @brief Czas całego kroku Update w milisekundach.
+        double stepTime = 0;
+        /// @brief Czas szerokiej fazy w milisekundach, razem z przeniesieniem danych par z poprzedniego kroku.
+        double broadphaseTime = 0;
+        /// @brief Czas fazy wąskiej w milisekundach, sumowany po pod krokach.
+        double narrowphaseTime = 0;
+        /// @brief Czas kolorowania i rozwiązywania ograniczników w milisekundach, sumowany po pod krokach.
+        double solveTime = 0;
+        /// @brief Czas całkowania położeń i prędkości oraz aktualizacji pozycji w ColliderManager w milisekundach, sumowany po pod krokach.
+        double integrateTime = 0;
+    };
+
+    /// @brief Największa liczba kroków wykonywanych w jednym wywołaniu Advance.
+    /// @details Czas, którego nie dało się nadrobić, jest odrzucany i symulacja zwalnia, zamiast wydłużać kolejne klatki coraz większą liczbą kroków.
+    static int maxTicksPerFrame;
+
+    /// @brief Dodaje @p frameTime do akumulatora i wykonuje tyle kroków Update o długości deltaT, ile się w nim mieści, najwyżej maxTicksPerFrame.
+    /// @details Przed ostatnim krokiem zapisywane jest położenie obiektów, z którego GetInterpolatedTransform przechodzi do położenia po kroku
+    /// w miarę zbierania się czasu w akumulatorze.
+    /// @param frameTime czas od poprzedniego wywołania
+    /// @return liczba wykonanych kroków, może być 0
+    static int Advance(real frameTime)
+    {
+        Accumulate(frameTime);
+        int ticks = (int)std::floor(accumulator / deltaT);
+        for (int i = 0; i < ticks; i++)
+        {
+            if (i == ticks - 1)
+                StoreTickStart();
+            Update();
+            accumulator -= deltaT;
+        }
+        accumulator = std::max<real>(accumulator, 0);
+        return ticks;
+    }
+
+    /// @brief Dodaje @p frameTime do akumulatora, odrzucając czas ponad maxTicksPerFrame kroków, bez wykonywania kroków.
+    static void Accumulate(real frameTime)
+    {
+        accumulator += frameTime;
+        if (accumulator > maxTicksPerFrame * deltaT)
+        {
+            droppedTime += accumulator - maxTicksPerFrame * deltaT;
+            accumulator = maxTicksPerFrame * deltaT;
+        }
+    }
+
+    /// @brief Wykonuje jeden krok z akumulatora, jeżeli zebrało się w nim co najmniej deltaT, razem z zapisem położenia sprzed kroku jak w Advance.
+    /// @return czy krok został wykonany
+    static bool Tick()
+    {
+        if (accumulator < deltaT)
+            return false;
+
+        StoreTickStart();
+        Update();
+        accumulator = std::max<real>(accumulator - deltaT, 0);
+        return true;
+    }
+
+    /// @brief Wykonuje dokładnie jeden krok z zapisem położenia sprzed kroku jak w Tick, niezależnie od akumulatora, który jest opróżniany.
+    /// @details Służy do krokowania wstrzymanej symulacji, dopełnienie akumulatora do deltaT przez zaokrąglenia mogłoby nie wystarczyć na krok.
+    static void ForceTick()
+    {
+        StoreTickStart();
+        Update();
+        accumulator = 0;
+    }
+
+    /// @brief Część kroku zebrana w akumulatorze, w jakiej GetInterpolatedTransform łączy położenia sprzed i po ostatnim kroku.
+    static real GetInterpolationAlpha() { return std::min<real>(accumulator / deltaT, 1); }
+
+    /// @brief Łączny czas odrzucony przez Advance po przekroczeniu maxTicksPerFrame.
+    static real GetDroppedTime() { return droppedTime; }
+
+    /// @brief Położenia obiektów z początku ostatniego kroku Advance, indeksy jak w components, obiekty dodane później nie mają położenia.
+    static const std::vector<rvec3>& GetTickStartPositions() { return tickStartPositions; }
+    /// @brief Obroty obiektów z początku ostatniego kroku Advance, jak GetTickStartPositions .
+    static const std::vector<rquat>& GetTickStartRotations() { return tickStartRotations; }
+
+    /// @brief Położenie obiektu między początkiem i końcem ostatniego kroku Advance, według GetInterpolationAlpha .
+    /// @details Obiekty bez ciała sztywnego lub bez zapisanego położenia z początku kroku, na przykład dodane po nim, zwracane są bez zmian.
+    static Transform GetInterpolatedTransform(const Transform& transform)
+    {
+        uint32_t i = transform.HasComponent<RigidBody>() ? &transform.GetComponent<RigidBody>() - components.data() : tickStartPositions.size();
+        if (i >= tickStartPositions.size())
+            return Transform(transform.position, transform.scale, transform.rotation);
+
+        real alpha = GetInterpolationAlpha();
+        return Transform(glm::mix(tickStartPositions[i], transform.position, alpha), transform.scale, glm::slerp(tickStartRotations[i], transform.rotation, alpha));
+    }
 
     static void Update()
     {
-        double subDeltaT = deltaT / subStepCount;
+        PROFILE_ZONE("Physics::Update");
+        auto start = std::chrono::steady_clock::now();
+        auto lap = start;
+        stepStats.narrowphaseTime = stepStats.solveTime = stepStats.integrateTime = 0;
+        LoadBodies();
 
-        std::unordered_set<CollisionPair, CollisionPair::Hash> possibleColliders;
-        for (auto&& i : components)
-            ColliderManager::QuarryInRadius(i.GetComponent<Collider>(), 1 + glm::length(i.velocity) * deltaT * 2, &possibleColliders);
+        // Poprzednie pary i ich dane są zachowywane, by przenieść wyniki GJK do par, które dalej są blisko.
+        static CollisionPairBuffer previousColliders;
+        static std::vector<GJKCache> previousGJKCaches;
+        static std::vector<ContactManifold> previousManifolds;
+        std::swap(possibleColliders, previousColliders);
+        std::swap(gjkCaches, previousGJKCaches);
+        std::swap(manifolds, previousManifolds);
 
-        for (int i = 0; i < subStepCount; i++)
+        ColliderManager::GetPossibleCollisions(deltaT, &possibleColliders, speculativeContacts);
+        possibleColliders.Remap(previousColliders, previousGJKCaches, gjkCaches);
+        possibleColliders.Remap(previousColliders, previousManifolds, manifolds);
+        stepStats.broadphaseTime = Lap(lap);
+
+        int count = adaptiveSubSteps ? ChooseSubStepCount() : subStepCount;
+        real subDeltaT = deltaT / count;
+        if (continuousCollisions)
+            FindImpacts(subDeltaT);
+
+        real maxDepth = 0;
+        for (int i = 0; i < count; i++)
         {
-            Substep(subDeltaT, possibleColliders);
+            Substep(subDeltaT, possibleColliders, gjkCaches.data(), manifolds.data());
+            for (auto&& penetration : penetrations)
+                maxDepth = std::max(maxDepth, penetration.depth);
         }
+
+        stepStats.subStepCount = count;
+        stepStats.maxDepth = maxDepth;
+        stepStats.constraintCount = 0;
+        for (auto&& penetration : penetrations)
+            stepStats.constraintCount += !penetration.speculative;
+
+        impacts.clear();
+        impactTimes.clear();
+        StoreBodies();
+        UpdateSleeping();
+        stepStats.stepTime = Lap(start);
     }
 
-    static void Substep(double subDeltaT, std::unordered_set<CollisionPair, CollisionPair::Hash>& possibleColliders)
+    /// @brief Kopiuje stan komponentów do BodyStore, wywoływane przed Substep.
+    static void LoadBodies()
     {
-        std::vector<double> originalRestitution(components.size());
-        std::vector<double> originalStaticFriction(components.size());
-        std::vector<double> originalDynamicFriction(components.size());
+        bodies.Load(components, restitutionMult, staticFrictionMult, dynamicFrictionMult);
+
+        colliderBodies.resize(ColliderManager::components.size());
+        for (uint32_t j = 0; j < colliderBodies.size(); j++)
+            colliderBodies[j] = &ColliderManager::components[j].GetComponent<RigidBody>() - components.data();
+    }
+
+    /// @brief Zapisuje stan z BodyStore do komponentów Transform i RigidBody oraz do ColliderManager::poses , wywoływane po ostatnim Substep.
+    static void StoreBodies()
+    {
+        bodies.Store(components);
+        UpdatePoses();
+    }
+
+    /// @brief Wyspy z ostatniego kroku.
+    static const SimulationIslands& GetIslands() { return islands; }
 
-        for (int j = 0; j < components.size(); j++)
+    /// @brief Kolory grup ograniczników z ostatniego pod kroku.
+    static const ConstraintColoring& GetColoring() { return coloring; }
+
+    /// @brief Ograniczniki penetracji z ostatniego pod kroku, razem ze spekulatywnymi.
+    static const std::vector<PenetrationConstraint>& GetPenetrations() { return penetrations; }
+
+    /// @brief Dane o ostatnim kroku, razem z wybraną w nim liczbą pod kroków.
+    static const StepStats& GetStepStats() { return stepStats; }
+
+    /// @brief Faza wąska, wyznacza ograniczniki penetracji dla wszystkich par z @p possibleColliders .
+    /// @details Pary są dzielone na fragmenty przetwarzane równolegle, każdy wątek zapisuje ograniczniki do własnego bufora,
+    /// a bufory są łączone w kolejności fragmentów, dzięki czemu wynik jest taki sam jak przy jednym wątku.
+    /// Ograniczniki jednej pary tworzą grupę, która przy rozwiązywaniu trafia w całości do jednego wątku.
+    /// Pary są najpierw sprawdzane blokami przez ClassifyPairs, punkty styku wyznaczane są tylko dla tych, których nie odrzuciła.
+    /// Pary bez kolizji mogą dostać kontakt spekulatywny z GetSpeculativeContact.
+    /// @param caches wyniki GJK dla każdej pary z @p possibleColliders , może być nullptr
+    /// @param manifolds rozmaitości kontaktowe dla każdej pary z @p possibleColliders , zastępowane nowymi, może być nullptr
+    static void Narrowphase(real subDeltaT, const CollisionPairBuffer& possibleColliders, GJKCache* caches = nullptr, ContactManifold* manifolds = nullptr)
+    {
+        uint32_t pairCount = possibleColliders.size();
+        threadContacts.resize(ThreadPool::GetThreadSlotCount());
+        for (auto&& buffer : threadContacts)
+            buffer.Clear();
+        contactChunks.assign((pairCount + pairGrainSize - 1) / pairGrainSize, ContactChunk());
+
+        ThreadPool::ParallelFor(pairCount, pairGrainSize, [&](uint32_t begin, uint32_t end, uint32_t thread) {
+            ContactBuffer& buffer = threadContacts[thread];
+            ContactChunk& chunk = contactChunks[begin / pairGrainSize];
+            chunk.thread = thread;
+            chunk.penetrationBegin = buffer.penetrations.size();
+            chunk.groupBegin = buffer.groupStarts.size();
+            PairState states[classifyBlockSize];
+
+            for (uint32_t j = begin; j < end; j++)
+            {
+                if ((j - begin) % classifyBlockSize == 0)
+                    ClassifyPairs(possibleColliders, j, std::min(end, j + classifyBlockSize), caches, states);
+
+                // Pary bez obudzonego obiektu dynamicznego nie mogą się zmienić, ich rozmaitości zostają do obudzenia.
+                PairState state = states[(j - begin) % classifyBlockSize];
+                if (state == PairState::Inactive)
+                    continue;
+
+                const CollisionPair& pair = possibleColliders[j];
+                uint32_t aBody = colliderBodies[pair.a];
+                uint32_t bBody = colliderBodies[pair.b];
+                ContactManifold manifold;
+                bool colliding = state == PairState::Contacts
+                    && ColliderManager::GetContacts(ColliderManager::components[pair.a], ColliderManager::components[pair.b], &manifold, caches ? &caches[j] : nullptr);
+
+                real allowedDepth = 0;
+                bool speculative = !colliding && speculativeContacts && GetSpeculativeContact(pair, aBody, bBody, subDeltaT, &manifold, &allowedDepth);
+                manifold.deltaT = subDeltaT;
+                manifold.speculative = speculative;
+                if (manifolds)
+                {
+                    // Mnożniki kontaktu nie mogą przejść na kontakt spekulatywny, rozepchnęłyby rozdzielone obiekty.
+                    if (warmStarting && colliding)
+                        manifold.WarmStart(manifolds[j], subDeltaT);
+                    manifolds[j] = manifold;
+                }
+
+                if ((!colliding && !speculative) || manifold.pointCount == 0)
+                    continue;
+
+                buffer.groupStarts.push_back(buffer.penetrations.size());
+                buffer.groupBodies.emplace_back(GetColoringIndex(aBody), GetColoringIndex(bBody));
+                for (int k = 0; k < manifold.pointCount; k++)
+                {
+                    const ContactPoint& point = manifold.points[k];
+                    PenetrationConstraint& penetration = buffer.penetrations.emplace_back(aBody, bBody, point.pointA, point.pointB, manifold.normal, point.depth, point.normalLambda);
+                    penetration.speculative = speculative;
+                    penetration.allowedDepth = allowedDepth;
+                    buffer.contactPoints.push_back(manifolds ? &manifolds[j].points[k] : nullptr);
+                }
+            }
+
+            chunk.penetrationEnd = buffer.penetrations.size();
+            chunk.groupEnd = buffer.groupStarts.size();
+            });
+
+        penetrations.clear();
+        contactPoints.clear();
+        groupStarts.clear();
+        groupBodies.clear();
+        for (const ContactChunk& chunk : contactChunks)
         {
-            originalRestitution[j] = components[j].restitutionCoefficient;
-            originalStaticFriction[j] = components[j].staticFrictionCoefficient;
-            originalDynamicFriction[j] = components[j].dynamicFrictionCoefficient;
+            const ContactBuffer& buffer = threadContacts[chunk.thread];
+            uint32_t base = penetrations.size();
+            for (uint32_t j = chunk.groupBegin; j < chunk.groupEnd; j++)
+                groupStarts.push_back(base + buffer.groupStarts[j] - chunk.penetrationBegin);
 
-            components[j].restitutionCoefficient *= restitutionMult;
-            components[j].staticFrictionCoefficient *= staticFrictionMult;
-            components[j].dynamicFrictionCoefficient *= dynamicFrictionMult;
+            penetrations.insert(penetrations.end(), buffer.penetrations.begin() + chunk.penetrationBegin, buffer.penetrations.begin() + chunk.penetrationEnd);
+            contactPoints.insert(contactPoints.end(), buffer.contactPoints.begin() + chunk.penetrationBegin, buffer.contactPoints.begin() + chunk.penetrationEnd);
+            groupBodies.insert(groupBodies.end(), buffer.groupBodies.begin() + chunk.groupBegin, buffer.groupBodies.begin() + chunk.groupEnd);
         }
+        groupStarts.push_back(penetrations.size());
+    }
 
+    /// @brief Pod krok na stanie w BodyStore, wywoływany między LoadBodies i StoreBodies.
+    /// @param caches wyniki GJK dla każdej pary z @p possibleColliders , może być nullptr
+    /// @param manifolds rozmaitości kontaktowe dla każdej pary z @p possibleColliders , zastępowane nowymi, może być nullptr
+    static void Substep(real subDeltaT, const CollisionPairBuffer& possibleColliders, GJKCache* caches = nullptr, ContactManifold* manifolds = nullptr)
+    {
+        PROFILE_ZONE("Physics::Substep");
+        auto lap = std::chrono::steady_clock::now();
 
         // Integration
-        for (int j = 0; j < components.size(); j++)
+        ThreadPool::ParallelFor(bodies.movingBlocks.size(), bodyGrainSize / BodyStore::padding, [&](uint32_t begin, uint32_t end, uint32_t) {
+            for (uint32_t k = begin; k < end; k++)
+                bodies.Integrate(bodies.movingBlocks[k], bodies.movingBlocks[k] + BodyStore::padding, gravity, subDeltaT);
+            });
+
+        if (!impacts.empty())
+            ClampImpacts(subDeltaT);
+
+        UpdatePoses();
+        stepStats.integrateTime += Lap(lap);
+        Narrowphase(subDeltaT, possibleColliders, caches, manifolds);
+        stepStats.narrowphaseTime += Lap(lap);
+        coloring.Build(groupBodies, components.size());
+
+        // Position Solve.
+        SolveColored([&](PenetrationConstraint& penetration) { penetration.WarmStart(bodies); });
         {
-            components[j].AddForce(gravity, subDeltaT);
-            components[j].Integrate(subDeltaT);
+            PROFILE_ZONE("SolvePositions");
+            SolveColored([&](PenetrationConstraint& penetration) { penetration.SolvePositions(bodies); });
         }
 
+        for (size_t j = 0; j < penetrations.size(); j++)
+            if (contactPoints[j])
+                contactPoints[j]->normalLambda = penetrations[j].GetNormalLambda();
+        stepStats.solveTime += Lap(lap);
+
+        // Velocity update.
+        ThreadPool::ParallelFor(bodies.movingBlocks.size(), bodyGrainSize / BodyStore::padding, [&](uint32_t begin, uint32_t end, uint32_t) {
+            for (uint32_t k = begin; k < end; k++)
+                bodies.UpdateVelocities(bodies.movingBlocks[k], bodies.movingBlocks[k] + BodyStore::padding, subDeltaT);
+            });
+        stepStats.integrateTime += Lap(lap);
+
+        // Velocity Solve.
+        real restitutionCutoff = glm::length(gravity);
+        SolveColored([&](PenetrationConstraint& penetration) { penetration.SolveVelocities(bodies, restitutionCutoff, subDeltaT); });
+        stepStats.solveTime += Lap(lap);
+
+        substepTime += subDeltaT;
+    }
+
+private:
+    /// @brief Ograniczniki wyznaczone przez jeden wątek w fazie wąskiej.
+    struct ContactBuffer
+    {
         std::vector<PenetrationConstraint> penetrations;
-        for (auto&& j : possibleColliders)
+        std::vector<ContactPoint*> contactPoints;
+        std::vector<uint32_t> groupStarts;
+        std::vector<std::pair<uint32_t, uint32_t>> groupBodies;
+
+        void Clear()
         {
-            PenetrationConstraint t;
-            if (ColliderManager::GetPenetration(*j.a, *j.b, &t))
-                penetrations.emplace_back(std::move(t));
+            penetrations.clear();
+            contactPoints.clear();
+            groupStarts.clear();
+            groupBodies.clear();
         }
+    };
 
-        // Position Solve.
-        for (auto&& penetration : penetrations)
-            penetration.SolvePositions(subDeltaT);
+    /// @brief Fragment par fazy wąskiej, przedziały w buforze wątku, który go przetworzył.
+    struct ContactChunk
+    {
+        uint32_t thread = 0;
+        uint32_t penetrationBegin = 0;
+        uint32_t penetrationEnd = 0;
+        uint32_t groupBegin = 0;
+        uint32_t groupEnd = 0;
+    };
 
-        // Velocity update.
-        for (int j = 0; j < components.size(); j++)
-            components[j].UpdateVelocities(subDeltaT);
+    /// @brief Wynik wstępnego sprawdzenia pary w fazie wąskiej.
+    enum class PairState : uint8_t
+    {
+        /// @brief Para bez obudzonego obiektu dynamicznego i obiektu kinematycznego.
+        Inactive,
+        /// @brief Para na pewno nie jest w kolizji.
+        Separated,
+        /// @brief Punkty styku wyznacza ColliderManager::GetContacts .
+        Contacts
+    };
 
-        // Velocity Solve.
-        for (int j = 0; j < penetrations.size(); j++)
-            penetrations[j].SolveVelocities(glm::length(gravity), subDeltaT);
+    /// @brief Liczba par przetwarzanych przez jeden wątek naraz w fazie wąskiej.
+    static constexpr uint32_t pairGrainSize = 64;
+    /// @brief Liczba par sprawdzanych naraz przez ClassifyPairs, zanim faza wąska wyznaczy ich punkty styku.
+    static constexpr uint32_t classifyBlockSize = 64;
+    /// @brief Liczba obiektów przetwarzanych przez jeden wątek naraz przy całkowaniu i aktualizacji prędkości.
+    static constexpr uint32_t bodyGrainSize = 256;
+    /// @brief Liczba grup ograniczników jednego koloru rozwiązywanych przez jeden wątek naraz.
+    static constexpr uint32_t groupGrainSize = 32;
+
+    static std::vector<ContactBuffer> threadContacts;
+    static std::vector<ContactChunk> contactChunks;
+
+    /// @brief Ograniczniki z fazy wąskiej i punkty rozmaitości, do których zapisywane są ich mnożniki,
+    /// bufory używane ponownie w kolejnych pod krokach.
+    static std::vector<PenetrationConstraint> penetrations;
+    static std::vector<ContactPoint*> contactPoints;
+    /// @brief Początki grup w penetrations, ostatni element to liczba ograniczników.
+    static std::vector<uint32_t> groupStarts;
+    /// @brief Indeksy obiektów grup do kolorowania.
+    static std::vector<std::pair<uint32_t, uint32_t>> groupBodies;
+    static ConstraintColoring coloring;
+
+    static SimulationIslands islands;
+    static std::vector<std::pair<uint32_t, uint32_t>> islandEdges;
+
+    /// @brief Stan obiektów w trakcie kroku, indeksy jak w components.
+    static BodyStore bodies;
+    /// @brief Indeks obiektu sztywnego każdego obiektu kolizji.
+    static std::vector<uint32_t> colliderBodies;
 
+    /// @brief Obiekt zatrzymywany przez CCD w bieżącym kroku.
+    struct Impact
+    {
+        uint32_t body;
+        /// @brief Czas od początku kroku, po którym obiekt przestaje się przesuwać do końca pod kroku.
+        real time;
+    };
+
+    static std::vector<Impact> impacts;
+    /// @brief Najwcześniejszy czas zderzenia każdego obiektu, bufor używany ponownie w kolejnych krokach.
+    static std::vector<real> impactTimes;
+    /// @brief Czas od początku kroku do początku bieżącego pod kroku.
+    static real substepTime;
+    static StepStats stepStats;
+
+    /// @brief Czas zebrany przez Advance, jeszcze nie wykonany jako krok.
+    static real accumulator;
+    static real droppedTime;
+    static std::vector<rvec3> tickStartPositions;
+    static std::vector<rquat> tickStartRotations;
 
-        for (int j = 0; j < components.size(); j++)
+    /// @brief Zapisuje tickStartPositions i tickStartRotations z komponentów, wywoływane przed ostatnim krokiem Advance.
+    static void StoreTickStart()
+    {
+        tickStartPositions.resize(components.size());
+        tickStartRotations.resize(components.size());
+        for (uint32_t i = 0; i < components.size(); i++)
         {
-            components[j].restitutionCoefficient = originalRestitution[j];
-            components[j].staticFrictionCoefficient = originalStaticFriction[j];
-            components[j].dynamicFrictionCoefficient = originalDynamicFriction[j];
+            tickStartPositions[i] = components[i].GetPosition();
+            tickStartRotations[i] = components[i].GetRotation();
+        }
+    }
+
+    /// @brief Wybiera liczbę pod kroków kroku w trybie adaptacyjnym, wywoływane po szerokiej fazie.
+    /// @details Liczba jest największą z trzech: takiej, by żadna para z possibleColliders nie zbliżyła się w pod kroku o więcej niż adaptiveMotion
+    /// sumy promieni kul wpisanych, liczby z poprzedniego kroku zwiększonej proporcjonalnie do przekroczenia adaptiveDepth przez największą
+    /// głębokość penetracji i liczby rosnącej z logarytmem liczby ograniczników. Wynik ograniczany jest do [minSubStepCount, maxSubStepCount],
+    /// a między krokami może zmaleć najwyżej o jeden, żeby liczba nie oscylowała, gdy mniejsza liczba pod kroków znowu zwiększa penetracje.
+    static int ChooseSubStepCount()
+    {
+        real maxMotion = 0;
+        for (auto&& pair : possibleColliders)
+        {
+            uint32_t aBody = colliderBodies[pair.a];
+            uint32_t bBody = colliderBodies[pair.b];
+            if (!bodies.IsMoving(aBody) && !bodies.IsMoving(bBody))
+                continue;
+
+            const Collider& a = ColliderManager::components[pair.a];
+            const Collider& b = ColliderManager::components[pair.b];
+            real motion = GetApproachSpeed(a, GetMotion(aBody), b, GetMotion(bBody)) * deltaT / (a.GetInnerRadius() + b.GetInnerRadius());
+            maxMotion = std::max(maxMotion, motion);
+        }
+        stepStats.maxMotion = maxMotion;
+
+        real count = maxMotion / adaptiveMotion;
+        if (stepStats.subStepCount != 0 && stepStats.maxDepth > adaptiveDepth)
+            count = std::max(count, stepStats.subStepCount * stepStats.maxDepth / adaptiveDepth);
+        count = std::max(count, 1 + std::floor(std::log2(1 + stepStats.constraintCount / real(adaptiveConstraintCount))));
+
+        int maxCount = std::max(minSubStepCount, maxSubStepCount);
+        int chosen = (int)std::min<real>(std::ceil(count), maxCount);
+        if (stepStats.subStepCount != 0)
+            chosen = std::max(chosen, stepStats.subStepCount - 1);
+        return std::clamp(chosen, std::max(minSubStepCount, 1), maxCount);
+    }
+
+    /// @brief Czas od @p start w milisekundach, @p start jest przesuwany na bieżącą chwilę.
+    static double Lap(std::chrono::steady_clock::time_point& start)
+    {
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double, std::milli>(now - start).count();
+        start = now;
+        return elapsed;
+    }
+
+    /// @brief Ruch obiektu z BodyStore ze stałą prędkością, statyczne i śpiące obiekty stoją w miejscu.
+    static ColliderMotion GetMotion(uint32_t body)
+    {
+        if (!bodies.IsMoving(body))
+            return { bodies.GetPosition(body), bodies.GetRotation(body), rvec3(0), rvec3(0) };
+
+        return { bodies.GetPosition(body), bodies.GetRotation(body), bodies.GetVelocity(body), bodies.GetAngularVelocity(body) };
+    }
+
+    /// @brief Górne ograniczenie prędkości, z jaką zbliżają się obiekty, jak w ColliderManager::TimeOfImpact .
+    static real GetApproachSpeed(const Collider& a, const ColliderMotion& aMotion, const Collider& b, const ColliderMotion& bMotion)
+    {
+        return glm::length(aMotion.velocity - bMotion.velocity) + glm::length(aMotion.angularVelocity) * a.boundingSphereRadius
+            + glm::length(bMotion.angularVelocity) * b.boundingSphereRadius;
+    }
+
+    /// @brief Wyznacza kontakt spekulatywny rozdzielonej pary, jeżeli w następnym pod kroku obiekty mogą wejść w siebie głębiej niż @p allowedDepth .
+    /// @details Wolniejsze pary rozwiązuje zwykła faza wąska, a pary z obiektem zatrzymywanym w tym kroku przez CCD są pomijane,
+    /// bo ograniczenie prędkości przed zderzeniem przesunęłoby czas, w którym CCD go zatrzyma.
+    /// @param allowedDepth wyjściowa dozwolona głębokość, speculativeDepth sumy promieni kul wpisanych w obiekty
+    static bool GetSpeculativeContact(const CollisionPair& pair, uint32_t aBody, uint32_t bBody, real subDeltaT, ContactManifold* manifold, real* allowedDepth)
+    {
+        if (!impactTimes.empty() && (impactTimes[aBody] < deltaT || impactTimes[bBody] < deltaT))
+            return false;
+
+        const Collider& a = ColliderManager::components[pair.a];
+        const Collider& b = ColliderManager::components[pair.b];
+        real motion = GetApproachSpeed(a, GetMotion(aBody), b, GetMotion(bBody)) * subDeltaT;
+        *allowedDepth = speculativeDepth * (a.GetInnerRadius() + b.GetInnerRadius());
+        if (motion <= *allowedDepth)
+            return false;
+
+        return ColliderManager::GetSpeculativeContact(a, b, motion - *allowedDepth, manifold);
+    }
+
+    /// @brief Wyznacza impacts dla par z possibleColliders, wywoływane między szeroką fazą i pierwszym pod krokiem.
+    /// @details Czas zderzenia liczony jest tylko dla par, które w jednym pod kroku mogą się zbliżyć o więcej niż ccdMotionThreshold sumy
+    /// promieni kul wpisanych, pozostałe wykrywa zwykła faza wąska. Obiekt dostaje najwcześniejszy czas ze swoich par.
+    static void FindImpacts(real subDeltaT)
+    {
+        impacts.clear();
+        substepTime = 0;
+        impactTimes.assign(bodies.size(), std::numeric_limits<real>::infinity());
+
+        for (uint32_t j = 0; j < possibleColliders.size(); j++)
+        {
+            const CollisionPair& pair = possibleColliders[j];
+            uint32_t aBody = colliderBodies[pair.a];
+            uint32_t bBody = colliderBodies[pair.b];
+            if (bodies.active[aBody] == 0 && bodies.active[bBody] == 0)
+                continue;
+
+            const Collider& a = ColliderManager::components[pair.a];
+            const Collider& b = ColliderManager::components[pair.b];
+            ColliderMotion aMotion = GetMotion(aBody);
+            ColliderMotion bMotion = GetMotion(bBody);
+            if (GetApproachSpeed(a, aMotion, b, bMotion) * subDeltaT <= ccdMotionThreshold * (a.GetInnerRadius() + b.GetInnerRadius()))
+                continue;
+
+            real tolerance = ccdTolerance * std::min(a.GetInnerRadius(), b.GetInnerRadius());
+            real time;
+            rvec3 normal;
+            if (!ColliderManager::TimeOfImpact(a, aMotion, b, bMotion, deltaT, tolerance, &time, &normal))
+                continue;
+
+            // Obiekty zatrzymane w odległości tolerance nie są w kolizji, więc przesuwane są dalej, aż wejdą w siebie na tolerance.
+            real approachSpeed = glm::dot(aMotion.velocity - bMotion.velocity, normal);
+            if (approachSpeed > 0)
+                time += 2 * tolerance / approachSpeed;
+
+            if (bodies.active[aBody] != 0)
+                impactTimes[aBody] = std::min(impactTimes[aBody], time);
+            if (bodies.active[bBody] != 0)
+                impactTimes[bBody] = std::min(impactTimes[bBody], time);
+        }
+
+        for (uint32_t i = 0; i < bodies.size(); i++)
+            if (impactTimes[i] < deltaT)
+                impacts.push_back({ i, impactTimes[i] });
+    }
+
+    /// @brief Cofa obiekty z impacts, których czas przypada na bieżący pod krok, do stanu z tego czasu, wywoływane po całkowaniu.
+    /// @details Prędkość z początku pod kroku zostaje w BodyStore, więc restytucja i tarcie działają tak, jakby obiekt nie był zatrzymany.
+    /// Obiekt jest zatrzymywany raz, w kolejnych pod krokach zderzenie rozwiązują ograniczniki penetracji.
+    static void ClampImpacts(real subDeltaT)
+    {
+        for (size_t k = 0; k < impacts.size();)
+        {
+            Impact impact = impacts[k];
+            if (impact.time >= substepTime + subDeltaT)
+            {
+                k++;
+                continue;
+            }
+
+            uint32_t i = impact.body;
+            real time = std::max<real>(impact.time - substepTime, 0);
+            rvec3 position = bodies.GetPreviousPosition(i) + bodies.GetVelocity(i) * time;
+            rquat rotation = bodies.GetPreviousRotation(i);
+            rotation = glm::normalize(rotation + real(0.5) * time * rquat(0, bodies.GetAngularVelocity(i)) * rotation);
+            bodies.positionX[i] = position.x;
+            bodies.positionY[i] = position.y;
+            bodies.positionZ[i] = position.z;
+            bodies.rotationW[i] = rotation.w;
+            bodies.rotationX[i] = rotation.x;
+            bodies.rotationY[i] = rotation.y;
+            bodies.rotationZ[i] = rotation.z;
+
+            impacts[k] = impacts.back();
+            impacts.pop_back();
+        }
+    }
+
+    /// @brief Wyznacza ColliderManager::poses obiektów poruszanych w kroku z BodyStore, faza wąska czyta tylko je.
+    /// @details Statyczne i śpiące obiekty nie zmieniają się w trakcie kroku, ich stan pochodzi z GetPossibleCollisions.
+    static void UpdatePoses()
+    {
+        ThreadPool::ParallelFor(colliderBodies.size(), bodyGrainSize, [&](uint32_t begin, uint32_t end, uint32_t) {
+            for (uint32_t j = begin; j < end; j++)
+            {
+                uint32_t body = colliderBodies[j];
+                if (bodies.IsMoving(body))
+                    ColliderManager::poses[j] = ColliderPose(ColliderManager::components[j], bodies.GetPosition(body), bodies.GetRotation(body));
+            }
+            });
+    }
+
+    /// @brief Czy obiekt jest statyczny lub śpi, czyli nie jest zmieniany przez ograniczniki.
+    static bool IsInactive(const RigidBody& body)
+    {
+        return body.inverseMass == 0 || body.sleeping;
+    }
+
+    /// @brief Indeks obiektu w kolorowaniu, obiekty statyczne i śpiące nie są zapisywane przez ograniczniki i nie tworzą konfliktów.
+    static uint32_t GetColoringIndex(uint32_t body)
+    {
+        return bodies.active[body] == 0 ? ConstraintColoring::staticBody : body;
+    }
+
+    /// @brief Sprawdza pary z przedziału [@p begin , @p end ) fazy wąskiej przed wyznaczaniem punktów styku.
+    /// @details Pary odrzucone przez ColliderManager::ClassifyPair nie trafiają do GetContacts, a przy ColliderManager::batchedGJK
+    /// pary wymagające GJK są najpierw sprawdzane w ColliderManager::GJKBatch , po SimdReal::width naraz. Wynik pary nie zależy od tego,
+    /// z jakimi parami trafiła do GJKBatch, więc nie zależy od podziału na wątki.
+    /// Ścieżka wektorowa jest opcjonalna i działa tylko po ustawieniu ColliderManager::analyticContacts = false.
+    /// @param end najwyżej @p begin + classifyBlockSize
+    /// @param states wyjściowy stan każdej pary, indeks j - @p begin dla pary j
+    static void ClassifyPairs(const CollisionPairBuffer& possibleColliders, uint32_t begin, uint32_t end, GJKCache* caches, PairState* states)
+    {
+        constexpr uint32_t width = SimdReal::width;
+        CollisionPair batch[width];
+        GJKCache* batchCaches[width];
+        uint32_t batchIndices[width];
+        uint32_t count = 0;
+
+        auto flush = [&]() {
+            uint32_t separated = ColliderManager::GJKBatch(batch, count, batchCaches);
+            for (uint32_t k = 0; k < count; k++)
+                states[batchIndices[k] - begin] = (separated >> k & 1) ? PairState::Separated : PairState::Contacts;
+            count = 0;
+            };
+
+        for (uint32_t j = begin; j < end; j++)
+        {
+            const CollisionPair& pair = possibleColliders[j];
+            if (!bodies.IsMoving(colliderBodies[pair.a]) && !bodies.IsMoving(colliderBodies[pair.b]))
+            {
+                states[j - begin] = PairState::Inactive;
+                continue;
+            }
+
+            GJKCache* cache = caches ? &caches[j] : nullptr;
+            ColliderManager::ContactTest test = ColliderManager::ClassifyPair(ColliderManager::components[pair.a], ColliderManager::components[pair.b], cache);
+            if (test == ColliderManager::ContactTest::Separated)
+            {
+                states[j - begin] = PairState::Separated;
+                continue;
+            }
+            if (test == ColliderManager::ContactTest::Contacts || !ColliderManager::batchedGJK)
+            {
+                states[j - begin] = PairState::Contacts;
+                continue;
+            }
+
+            batch[count] = pair;
+            batchCaches[count] = cache;
+            batchIndices[count] = j;
+            if (++count == width)
+                flush();
+        }
+        if (count > 0)
+            flush();
+    }
+
+    /// @brief Aktualizuje czasy spoczynku obiektów, wyznacza wyspy z kontaktów ostatniego pod kroku, usypia wyspy, które spoczywają
+    /// dość długo i budzi wyspy, w których śpiący obiekt dotyka obudzonego.
+    static void UpdateSleeping()
+    {
+        if (!allowSleeping)
+        {
+            for (auto&& body : components)
+                body.WakeUp();
+            return;
+        }
+
+        // Progi dotyczą średniej prędkości w oknie timeToSleep, a nie chwilowej, dzięki czemu drgania stosów
+        // wokół położenia równowagi nie przeszkadzają w usypianiu.
+        real maxDistance = sleepLinearVelocity * timeToSleep;
+        real maxAngle = sleepAngularVelocity * timeToSleep;
+        for (auto&& body : components)
+        {
+            if (IsInactive(body))
+                continue;
+
+            rvec3 position = body.GetPosition();
+            rquat rotation = body.GetRotation();
+            real angle = 2.0 * std::acos(std::min(std::abs(glm::dot(rotation, body.sleepRotation)), real(1)));
+            if (body.sleepTime > 0 && glm::distance(position, body.sleepPosition) <= maxDistance && angle <= maxAngle)
+            {
+                body.sleepTime += deltaT;
+            }
+            else
+            {
+                body.sleepPosition = position;
+                body.sleepRotation = rotation;
+                body.sleepTime = deltaT;
+            }
+        }
+
+        // Krawędzie to pary obiektów dynamicznych w kontakcie, obiekty statyczne i kinematyczne nie łączą wysp,
+        // ale obiekt kinematyczny budzi śpiące obiekty, których dotyka. Kontakty spekulatywne nie są stykiem i są pomijane.
+        islandEdges.clear();
+        for (size_t j = 0; j < possibleColliders.size(); j++)
+        {
+            if (manifolds[j].pointCount == 0 || manifolds[j].speculative)
+                continue;
+
+            RigidBody& a = ColliderManager::components[possibleColliders[j].a].GetComponent<RigidBody>();
+            RigidBody& b = ColliderManager::components[possibleColliders[j].b].GetComponent<RigidBody>();
+            if (a.type == RigidBody::Type::Kinematic)
+                b.WakeUp();
+            if (b.type == RigidBody::Type::Kinematic)
+                a.WakeUp();
+            if (a.inverseMass == 0 || b.inverseMass == 0)
+                continue;
+
+            islandEdges.emplace_back(&a - components.data(), &b - components.data());
+        }
+        islands.Build(components.size(), islandEdges);
+
+        for (uint32_t island = 0; island < islands.GetIslandCount(); island++)
+        {
+            bool anyAwake = false;
+            bool anySleeping = false;
+            real minSleepTime = std::numeric_limits<real>::infinity();
+            for (const uint32_t* body = islands.begin(island); body != islands.end(island); body++)
+            {
+                const RigidBody& rigidBody = components[*body];
+                if (rigidBody.inverseMass == 0)
+                    continue;
+
+                if (rigidBody.sleeping)
+                    anySleeping = true;
+                else
+                {
+                    anyAwake = true;
+                    minSleepTime = std::min(minSleepTime, rigidBody.sleepTime);
+                }
+            }
+
+            if (!anyAwake)
+                continue;
+
+            // Obudzony obiekt dotyka śpiących, więc budzona jest cała wyspa.
+            if (anySleeping)
+            {
+                for (const uint32_t* body = islands.begin(island); body != islands.end(island); body++)
+                    components[*body].WakeUp();
+            }
+            else if (minSleepTime >= timeToSleep)
+            {
+                for (const uint32_t* body = islands.begin(island); body != islands.end(island); body++)
+                {
+                    RigidBody& rigidBody = components[*body];
+                    if (rigidBody.inverseMass == 0)
+                        continue;
+
+                    rigidBody.sleeping = true;
+                    rigidBody.velocity = rvec3(0);
+                    rigidBody.angularVelocity = rvec3(0);
+                }
+            }
+        }
+    }
+
+    /// @brief Wywołuje @p function dla każdego ogranicznika z penetrations, kolor po kolorze, grupy jednego koloru równolegle.
+    /// @details Grupy w kolorze nie dzielą obiektów dynamicznych, więc wynik nie zależy od liczby wątków.
+    template <typename TFunction>
+    static void SolveColored(TFunction&& function)
+    {
+        auto solveGroups = [&](const uint32_t* begin, const uint32_t* end) {
+            for (const uint32_t* group = begin; group != end; group++)
+                for (uint32_t j = groupStarts[*group]; j < groupStarts[*group + 1]; j++)
+                    function(penetrations[j]);
+            };
+
+        for (uint32_t color = 0; color < coloring.GetColorCount(); color++)
+        {
+            const uint32_t* begin = coloring.begin(color);
+            const uint32_t* end = coloring.end(color);
+            if (coloring.IsSerial(color))
+            {
+                solveGroups(begin, end);
+                continue;
+            }
+
+            ThreadPool::ParallelFor(end - begin, groupGrainSize, [&](uint32_t first, uint32_t last, uint32_t) {
+                solveGroups(begin + first, begin + last);
+                });
         }
     }
 };
-dvec3 Physics::gravity = { 0,0,-9.81 };
-double Physics::deltaT = 1.0 / 70.0;
-int Physics::subStepCount = 8;
-double Physics::restitutionMult = 1.0;
-double Physics::dynamicFrictionMult = 1.0;
-double Physics::staticFrictionMult = 1.0;
\ No newline at end of file
+rvec3 Physics::gravity = { 0,0,-9.81 };
+real Physics::deltaT = 1.0 / 70.0;
+int Physics::subStepCount = 4;
+real Physics::restitutionMult = 1.0;
+real Physics::dynamicFrictionMult = 1.0;
+real Physics::staticFrictionMult = 1.0;
+CollisionPairBuffer Physics::possibleColliders;
+std::vector<GJKCache> Physics::gjkCaches;
+std::vector<ContactManifold> Physics::manifolds;
+bool Physics::warmStarting = true;
+bool Physics::allowSleeping = true;
+real Physics::sleepLinearVelocity = 0.05;
+real Physics::sleepAngularVelocity = 0.05;
+real Physics::timeToSleep = 0.5;
+bool Physics::continuousCollisions = true;
+real Physics::ccdMotionThreshold = 0.5;
+real Physics::ccdTolerance = 0.05;
+bool Physics::speculativeContacts = true;
+real Physics::speculativeDepth = 0.25;
+bool Physics::adaptiveSubSteps = false;
+int Physics::minSubStepCount = 1;
+int Physics::maxSubStepCount = 16;
+real Physics::adaptiveMotion = 0.25;
+real Physics::adaptiveDepth = 0.02;
+uint32_t Physics::adaptiveConstraintCount = 4096;
+int Physics::maxTicksPerFrame = 4;
+SimulationIslands Physics::islands;
+BodyStore Physics::bodies;
+std::vector<uint32_t> Physics::colliderBodies;
+std::vector<Physics::Impact> Physics::impacts;
+std::vector<real> Physics::impactTimes;
+real Physics::substepTime = 0;
+Physics::StepStats Physics::stepStats;
+real Physics::accumulator = 0;
+real Physics::droppedTime = 0;
+std::vector<rvec3> Physics::tickStartPositions;
+std::vector<rquat> Physics::tickStartRotations;
+std::vector<std::pair<uint32_t, uint32_t>> Physics::islandEdges;
+std::vector<Physics::ContactBuffer> Physics::threadContacts;
+std::vector<Physics::ContactChunk> Physics::contactChunks;
+std::vector<PenetrationConstraint> Physics::penetrations;
+std::vector<ContactPoint*> Physics::contactPoints;
+std::vector<uint32_t> Physics::groupStarts;
+std::vector<std::pair<uint32_t, uint32_t>> Physics::groupBodies;
+ConstraintColoring Physics::coloring;
\ No newline at end of file
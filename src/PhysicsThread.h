@@ -0,0 +1,200 @@
+#pragma once
+#include "Physics.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+/// @brief Wątek wykonujący kroki Physics::Advance niezależnie od pętli rysowania.
+/// @details Wątek zbiera czas w akumulatorze Physics i wykonuje z niego po jednym kroku Physics::Tick naraz, po każdym kroku
+/// położenia obiektów z jego początku i końca zapisywane są do migawki w potrójnym buforze, z którego wątek rysujący czyta bez blokad. Pozostałe zmiany świata, jak dodawanie obiektów,
+/// ustawienia i interfejs, wątek główny wykonuje w Synchronize, między krokami. Czas klatki to wtedy większy z czasów kroku i rysowania,
+/// a nie ich suma. Wątek fizyki korzysta z ThreadPool razem z innymi wątkami, np. przy wczytywaniu zasobów.
+/// @ref Physics
+class PhysicsThread
+{
+public:
+    /// @brief Położenia obiektów sztywnych z początku i końca ostatniego kroku, indeksy jak w Physics::components .
+    struct Snapshot
+    {
+        std::vector<rvec3> startPositions;
+        std::vector<rquat> startRotations;
+        std::vector<rvec3> endPositions;
+        std::vector<rquat> endRotations;
+        /// @brief Chwila, w której akumulator Physics był pusty, przez kolejne deltaT rysowanie przechodzi od początku do końca kroku.
+        std::chrono::steady_clock::time_point endTime;
+        /// @brief Liczba kroków wykonanych przez PhysicsThread do zapisu migawki.
+        uint64_t tickCount = 0;
+    };
+
+    /// @brief Czy wątek wstrzymuje wykonywanie kroków, czas wstrzymania nie jest nadrabiany.
+    static std::atomic<bool> paused;
+
+    /// @brief Zapisuje pierwszą migawkę i uruchamia wątek fizyki.
+    static void Start()
+    {
+        Stop();
+        Publish(std::chrono::steady_clock::now());
+        running = true;
+        thread = std::thread(Loop);
+    }
+
+    /// @brief Zatrzymuje i łączy wątek fizyki, kolejne kroki trzeba wykonywać wywołując Physics::Advance bezpośrednio.
+    static void Stop()
+    {
+        if (!thread.joinable())
+            return;
+
+        {
+            std::lock_guard lock(mutex);
+            running = false;
+        }
+        syncCondition.notify_one();
+        thread.join();
+    }
+
+    /// @brief Wykonuje @p function między krokami wątku fizyki, czekając najwyżej na koniec bieżącego kroku.
+    /// @details Wątek fizyki nie zaczyna kolejnego kroku, dopóki czekają wywołania Synchronize. Na koniec zapisywana jest migawka,
+    /// żeby obiekty dodane w @p function były od razu widoczne dla wątku rysującego.
+    template <typename TFunction>
+    static void Synchronize(TFunction&& function)
+    {
+        syncRequests++;
+        {
+            std::lock_guard lock(mutex);
+            function();
+            Publish(endTime);
+            syncRequests--;
+        }
+        syncCondition.notify_one();
+    }
+
+    /// @brief Wykonuje dokładnie jeden krok i zapisuje migawkę, wywoływane w Synchronize, zwykle gdy wątek jest wstrzymany.
+    static void Step()
+    {
+        Physics::ForceTick();
+        tickCount++;
+        endTime = std::chrono::steady_clock::now();
+        Publish(endTime);
+    }
+
+    /// @brief Przełącza wątek rysujący na najnowszą zapisaną migawkę i wyznacza dla niej współczynnik interpolacji.
+    /// @details Wywoływane raz na klatkę przed rysowaniem, migawka pozostaje niezmieniona do kolejnego wywołania.
+    static const Snapshot& AcquireSnapshot()
+    {
+        if (middle.load(std::memory_order_acquire) & freshBit)
+            front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+
+        const Snapshot& snapshot = snapshots[front];
+        real elapsed = std::chrono::duration<real>(std::chrono::steady_clock::now() - snapshot.endTime).count();
+        alpha = paused ? 1 : std::clamp<real>(elapsed / Physics::deltaT, 0, 1);
+        return snapshot;
+    }
+
+    /// @brief Położenie obiektu z migawki wybranej przez AcquireSnapshot , rysowane z opóźnieniem jednego kroku.
+    /// @details Obiekty bez ciała sztywnego nie są zmieniane przez wątek fizyki i zwracane są bez zmian.
+    static Transform GetInterpolatedTransform(const Transform& transform)
+    {
+        const Snapshot& snapshot = snapshots[front];
+        uint32_t i = transform.HasComponent<RigidBody>() ? &transform.GetComponent<RigidBody>() - Physics::components.data() : snapshot.endPositions.size();
+        if (i >= snapshot.endPositions.size())
+            return Transform(transform.position, transform.scale, transform.rotation);
+
+        return Transform(glm::mix(snapshot.startPositions[i], snapshot.endPositions[i], alpha), transform.scale,
+            glm::slerp(snapshot.startRotations[i], snapshot.endRotations[i], alpha));
+    }
+
+private:
+    static constexpr uint32_t indexMask = 3;
+    static constexpr uint32_t freshBit = 4;
+
+    static std::thread thread;
+    static std::mutex mutex;
+    static std::condition_variable syncCondition;
+    static std::atomic<uint32_t> syncRequests;
+    static bool running;
+
+    /// @brief Migawki potrójnego bufora, front czyta wątek rysujący, back zapisuje wątek trzymający mutex,
+    /// a middle z bitem freshBit, jeżeli nie została jeszcze odczytana, jest wymieniana atomowo.
+    static Snapshot snapshots[3];
+    static uint32_t front;
+    static std::atomic<uint32_t> middle;
+    static uint32_t back;
+    /// @brief Współczynnik interpolacji wyznaczony przez AcquireSnapshot .
+    static real alpha;
+    /// @brief Chwila, w której akumulator Physics był pusty po ostatnim kroku, jak Snapshot::endTime .
+    static std::chrono::steady_clock::time_point endTime;
+    static uint64_t tickCount;
+
+    /// @brief Zapisuje położenia z Physics do migawki back i udostępnia ją wątkowi rysującemu, wywoływane z zablokowanym mutex.
+    static void Publish(std::chrono::steady_clock::time_point time)
+    {
+        Snapshot& snapshot = snapshots[back];
+        const std::vector<rvec3>& startPositions = Physics::GetTickStartPositions();
+        const std::vector<rquat>& startRotations = Physics::GetTickStartRotations();
+        size_t count = Physics::components.size();
+        snapshot.startPositions.resize(count);
+        snapshot.startRotations.resize(count);
+        snapshot.endPositions.resize(count);
+        snapshot.endRotations.resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            snapshot.endPositions[i] = Physics::components[i].GetPosition();
+            snapshot.endRotations[i] = Physics::components[i].GetRotation();
+            bool hasStart = i < startPositions.size();
+            snapshot.startPositions[i] = hasStart ? startPositions[i] : snapshot.endPositions[i];
+            snapshot.startRotations[i] = hasStart ? startRotations[i] : snapshot.endRotations[i];
+        }
+        snapshot.endTime = time;
+        snapshot.tickCount = tickCount;
+
+        back = middle.exchange(back | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    /// @brief Pętla wątku fizyki, dodaje do akumulatora czas od poprzedniego obiegu, wykonuje najwyżej jeden krok i czeka do chwili kolejnego.
+    /// @details Mutex zwalniany jest po każdym kroku, więc Synchronize czeka najwyżej na jeden krok, nawet gdy fizyka nadrabia opóźnienie.
+    static void Loop()
+    {
+        auto last = std::chrono::steady_clock::now();
+        while (true)
+        {
+            real wait;
+            {
+                std::unique_lock lock(mutex);
+                syncCondition.wait(lock, []() { return syncRequests == 0 || !running; });
+                if (!running)
+                    return;
+
+                auto now = std::chrono::steady_clock::now();
+                real frameTime = std::chrono::duration<real>(now - last).count();
+                last = now;
+                if (!paused)
+                {
+                    Physics::Accumulate(frameTime);
+                    if (Physics::Tick())
+                    {
+                        tickCount++;
+                        endTime = now - std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<real>(Physics::GetInterpolationAlpha() * Physics::deltaT));
+                        Publish(endTime);
+                    }
+                }
+                wait = (1 - Physics::GetInterpolationAlpha()) * Physics::deltaT;
+            }
+            std::this_thread::sleep_for(std::chrono::duration<real>(wait));
+        }
+    }
+};
+std::atomic<bool> PhysicsThread::paused = false;
+std::thread PhysicsThread::thread;
+std::mutex PhysicsThread::mutex;
+std::condition_variable PhysicsThread::syncCondition;
+std::atomic<uint32_t> PhysicsThread::syncRequests = 0;
+bool PhysicsThread::running = false;
+PhysicsThread::Snapshot PhysicsThread::snapshots[3];
+uint32_t PhysicsThread::front = 0;
+std::atomic<uint32_t> PhysicsThread::middle = 1;
+uint32_t PhysicsThread::back = 2;
+real PhysicsThread::alpha = 1;
+std::chrono::steady_clock::time_point PhysicsThread::endTime;
+uint64_t PhysicsThread::tickCount = 0;
@@ -0,0 +1,84 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+void Profiler::Clear()
+{
+    clearTime = Now();
+}
+
+bool Profiler::WriteChromeTrace(const char* path)
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+        return false;
+
+    struct ThreadEvents
+    {
+        uint32_t threadId;
+        std::vector<Event> events;
+    };
+
+    std::vector<ThreadEvents> threads;
+    {
+        std::lock_guard lock(mutex);
+        for (auto&& buffer : buffers)
+        {
+            uint64_t head = buffer->head.load(std::memory_order_acquire);
+            uint64_t first = head - std::min<uint64_t>(head, bufferSize);
+            std::vector<Event> events;
+            for (uint64_t i = first; i < head; i++)
+                events.push_back(buffer->events[i % bufferSize]);
+
+            // Strefy, których miejsce mógł w czasie kopiowania zająć wątek zapisujący, są odrzucane.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t newHead = buffer->head.load(std::memory_order_relaxed);
+            if (newHead >= bufferSize && newHead - bufferSize + 1 > first)
+                events.erase(events.begin(), events.begin() + std::min<uint64_t>(newHead - bufferSize + 1 - first, events.size()));
+            threads.push_back({ buffer->threadId, std::move(events) });
+        }
+    }
+
+    uint64_t since = clearTime;
+    uint64_t origin = std::numeric_limits<uint64_t>::max();
+    for (auto&& thread : threads)
+        for (auto&& event : thread.events)
+            if (event.start >= since)
+                origin = std::min(origin, event.start);
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (auto&& thread : threads)
+    {
+        file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.threadId
+            << ",\"args\":{\"name\":\"thread " << thread.threadId << "\"}}";
+        first = false;
+        for (auto&& event : thread.events)
+        {
+            if (event.start < since)
+                continue;
+
+            file << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread.threadId
+                << ",\"ts\":" << (event.start - origin) / 1000.0 << ",\"dur\":" << (event.end - event.start) / 1000.0 << "}";
+        }
+    }
+    file << "\n]}\n";
+    return file.good();
+}
+
+Profiler::ThreadBuffer* Profiler::RegisterThread()
+{
+    std::lock_guard lock(mutex);
+    buffers.push_back(std::make_unique<ThreadBuffer>());
+    buffers.back()->threadId = buffers.size() - 1;
+    threadBuffer = buffers.back().get();
+    return threadBuffer;
+}
+
+std::mutex Profiler::mutex;
+std::vector<std::unique_ptr<Profiler::ThreadBuffer>> Profiler::buffers;
+std::atomic<uint64_t> Profiler::clearTime = 0;
+thread_local Profiler::ThreadBuffer* Profiler::threadBuffer = nullptr;
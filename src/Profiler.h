@@ -0,0 +1,94 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/// @brief Mierzy czas od miejsca wywołania do końca zakresu, @p name musi być stałym napisem.
+/// @details Bez PHYSICS_PROFILER makro nie generuje żadnego kodu.
+#ifdef PHYSICS_PROFILER
+#define PROFILE_ZONE_CONCAT_INNER(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b) PROFILE_ZONE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) Profiler::Zone PROFILE_ZONE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#endif
+
+/// @brief Zapisuje czasy stref PROFILE_ZONE i eksportuje je do formatu śladu Chrome (chrome://tracing, Perfetto).
+/// @details Każdy wątek zapisuje strefy do własnego bufora cyklicznego bez blokad, przechowywanych jest ostatnie @ref bufferSize stref wątku.
+/// Blokada używana jest tylko przy pierwszej strefie wątku, do rejestracji jego bufora. Bufory nie są zwalniane, więc strefy zakończonych
+/// wątków też trafiają do śladu. WriteChromeTrace może być wywołane w trakcie zapisu, strefy nadpisane podczas kopiowania są pomijane.
+class Profiler
+{
+public:
+    /// @brief Liczba stref przechowywanych dla jednego wątku.
+    static constexpr uint32_t bufferSize = 1 << 17;
+
+    /// @brief Strefa zapisywana przy zniszczeniu, tworzona przez PROFILE_ZONE.
+    class Zone
+    {
+    public:
+        explicit Zone(const char* name) : name(name), start(Now()) {}
+        ~Zone() { Record(name, start, Now()); }
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    private:
+        const char* name;
+        uint64_t start;
+    };
+
+    /// @brief Czas w nanosekundach, w jakim zapisywane są strefy.
+    static uint64_t Now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /// @brief Zapisuje strefę do bufora aktualnego wątku.
+    static void Record(const char* name, uint64_t start, uint64_t end)
+    {
+        ThreadBuffer* buffer = threadBuffer ? threadBuffer : RegisterThread();
+        uint64_t head = buffer->head.load(std::memory_order_relaxed);
+        buffer->events[head % bufferSize] = { name, start, end };
+        buffer->head.store(head + 1, std::memory_order_release);
+    }
+
+    /// @brief Tworzy bufor aktualnego wątku, jeżeli jeszcze go nie ma, inaczej tworzy go pierwsza strefa wątku, alokując pamięć.
+    static void InitThread()
+    {
+        if (!threadBuffer)
+            RegisterThread();
+    }
+
+    /// @brief Pomija w kolejnych śladach strefy rozpoczęte przed wywołaniem.
+    static void Clear();
+
+    /// @brief Zapisuje strefy ze wszystkich wątków do pliku JSON w formacie śladu Chrome.
+    /// @return fałsz jeżeli nie udało się otworzyć pliku
+    static bool WriteChromeTrace(const char* path);
+
+private:
+    struct Event
+    {
+        const char* name;
+        uint64_t start;
+        uint64_t end;
+    };
+
+    /// @brief Bufor cykliczny jednego wątku, zapisywany tylko przez ten wątek, head to liczba wszystkich zapisanych stref.
+    struct ThreadBuffer
+    {
+        std::unique_ptr<Event[]> events = std::make_unique<Event[]>(bufferSize);
+        std::atomic<uint64_t> head = 0;
+        uint32_t threadId;
+    };
+
+    static std::mutex mutex;
+    static std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    static std::atomic<uint64_t> clearTime;
+    static thread_local ThreadBuffer* threadBuffer;
+
+    static ThreadBuffer* RegisterThread();
+};
@@ -0,0 +1,20 @@
+#pragma once
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+/// @brief Typ zmiennoprzecinkowy, na którym liczy fizyka, wybierany przy kompilacji.
+/// @details float, jeżeli zdefiniowano PHYSICS_SINGLE_PRECISION, w przeciwnym razie double.
+/// Pojedyncza precyzja podwaja liczbę obiektów przetwarzanych przez SimdReal i zmniejsza o połowę ruch pamięci,
+/// kosztem dokładności daleko od początku układu współrzędnych.
+#ifdef PHYSICS_SINGLE_PRECISION
+using real = float;
+#else
+using real = double;
+#endif
+
+using rvec2 = glm::vec<2, real>;
+using rvec3 = glm::vec<3, real>;
+using rquat = glm::qua<real>;
+using rmat3 = glm::mat<3, 3, real>;
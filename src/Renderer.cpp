@@ -1,5 +1,6 @@
 #include "Renderer.h"
 #include "GLFW/glfw3.h"
+#include "Profiler.h"
 #include <unordered_map>
 void Renderer::Init(void* window, vg::SurfaceHandle windowSurface, int width, int height)
 {
@@ -48,6 +49,7 @@ void Renderer::Destroy(MeshArray& component)
 
 void Renderer::DrawFrame(Transform cameraTransform, float fov)
 {
+    PROFILE_ZONE("Renderer::DrawFrame");
     vg::currentDevice->WaitUntilIdle();
     inFlightFence[frameIndex].Await(true);
 
@@ -0,0 +1,253 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include "Real.h"
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#define PHYSICS_SIMD_AVX512
+#elif defined(__AVX__)
+#include <immintrin.h>
+#define PHYSICS_SIMD_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PHYSICS_SIMD_SSE2
+#endif
+
+/// @brief Maska wyniku porównania SimdReal, jeden bit lub jedno słowo na linię.
+struct SimdMask
+{
+#if defined(PHYSICS_SIMD_AVX512) && defined(PHYSICS_SINGLE_PRECISION)
+    __mmask16 v;
+
+    friend SimdMask operator&(SimdMask a, SimdMask b) { return { __mmask16(a.v & b.v) }; }
+    friend SimdMask operator|(SimdMask a, SimdMask b) { return { __mmask16(a.v | b.v) }; }
+    /// @brief Linie ustawione w @p a i nieustawione w @p b .
+    friend SimdMask AndNot(SimdMask a, SimdMask b) { return { __mmask16(a.v & ~b.v) }; }
+    uint32_t Bits() const { return v; }
+#elif defined(PHYSICS_SIMD_AVX512)
+    __mmask8 v;
+
+    friend SimdMask operator&(SimdMask a, SimdMask b) { return { __mmask8(a.v & b.v) }; }
+    friend SimdMask operator|(SimdMask a, SimdMask b) { return { __mmask8(a.v | b.v) }; }
+    /// @brief Linie ustawione w @p a i nieustawione w @p b .
+    friend SimdMask AndNot(SimdMask a, SimdMask b) { return { __mmask8(a.v & ~b.v) }; }
+    uint32_t Bits() const { return v; }
+#elif defined(PHYSICS_SIMD_AVX) && defined(PHYSICS_SINGLE_PRECISION)
+    __m256 v;
+
+    friend SimdMask operator&(SimdMask a, SimdMask b) { return { _mm256_and_ps(a.v, b.v) }; }
+    friend SimdMask operator|(SimdMask a, SimdMask b) { return { _mm256_or_ps(a.v, b.v) }; }
+    /// @brief Linie ustawione w @p a i nieustawione w @p b .
+    friend SimdMask AndNot(SimdMask a, SimdMask b) { return { _mm256_andnot_ps(b.v, a.v) }; }
+    uint32_t Bits() const { return _mm256_movemask_ps(v); }
+#elif defined(PHYSICS_SIMD_AVX)
+    __m256d v;
+
+    friend SimdMask operator&(SimdMask a, SimdMask b) { return { _mm256_and_pd(a.v, b.v) }; }
+    friend SimdMask operator|(SimdMask a, SimdMask b) { return { _mm256_or_pd(a.v, b.v) }; }
+    /// @brief Linie ustawione w @p a i nieustawione w @p b .
+    friend SimdMask AndNot(SimdMask a, SimdMask b) { return { _mm256_andnot_pd(b.v, a.v) }; }
+    uint32_t Bits() const { return _mm256_movemask_pd(v); }
+#elif defined(PHYSICS_SIMD_SSE2) && defined(PHYSICS_SINGLE_PRECISION)
+    __m128 v;
+
+    friend SimdMask operator&(SimdMask a, SimdMask b) { return { _mm_and_ps(a.v, b.v) }; }
+    friend SimdMask operator|(SimdMask a, SimdMask b) { return { _mm_or_ps(a.v, b.v) }; }
+    /// @brief Linie ustawione w @p a i nieustawione w @p b .
+    friend SimdMask AndNot(SimdMask a, SimdMask b) { return { _mm_andnot_ps(b.v, a.v) }; }
+    uint32_t Bits() const { return _mm_movemask_ps(v); }
+#elif defined(PHYSICS_SIMD_SSE2)
+    __m128d v;
+
+    friend SimdMask operator&(SimdMask a, SimdMask b) { return { _mm_and_pd(a.v, b.v) }; }
+    friend SimdMask operator|(SimdMask a, SimdMask b) { return { _mm_or_pd(a.v, b.v) }; }
+    /// @brief Linie ustawione w @p a i nieustawione w @p b .
+    friend SimdMask AndNot(SimdMask a, SimdMask b) { return { _mm_andnot_pd(b.v, a.v) }; }
+    uint32_t Bits() const { return _mm_movemask_pd(v); }
+#else
+    bool v;
+
+    friend SimdMask operator&(SimdMask a, SimdMask b) { return { a.v && b.v }; }
+    friend SimdMask operator|(SimdMask a, SimdMask b) { return { a.v || b.v }; }
+    /// @brief Linie ustawione w @p a i nieustawione w @p b .
+    friend SimdMask AndNot(SimdMask a, SimdMask b) { return { a.v && !b.v }; }
+    uint32_t Bits() const { return v; }
+#endif
+
+    /// @brief Czy ustawiona jest jakakolwiek linia.
+    bool Any() const { return Bits() != 0; }
+};
+
+/// @brief Wektor liczb typu real o szerokości rejestru wybranego przy kompilacji.
+/// @details Szerokość to 8 (16 dla float) dla AVX-512, 4 (8) dla AVX i AVX2, 2 (4) dla SSE2 i 1 bez instrukcji wektorowych,
+/// kod używający tej struktury przetwarza @ref width obiektów naraz i nie zależy od zestawu instrukcji ani precyzji.
+/// Load i Store wymagają adresów wyrównanych do @ref alignment .
+struct SimdReal
+{
+#if defined(PHYSICS_SIMD_AVX512) && defined(PHYSICS_SINGLE_PRECISION)
+    static constexpr size_t width = 16;
+    __m512 v;
+
+    SimdReal(__m512 v) :v(v) {}
+    SimdReal(real value) :v(_mm512_set1_ps(value)) {}
+    static SimdReal Load(const real* address) { return _mm512_load_ps(address); }
+    void Store(real* address) const { _mm512_store_ps(address, v); }
+
+    friend SimdReal operator+(SimdReal a, SimdReal b) { return _mm512_add_ps(a.v, b.v); }
+    friend SimdReal operator-(SimdReal a, SimdReal b) { return _mm512_sub_ps(a.v, b.v); }
+    friend SimdReal operator*(SimdReal a, SimdReal b) { return _mm512_mul_ps(a.v, b.v); }
+    friend SimdReal operator/(SimdReal a, SimdReal b) { return _mm512_div_ps(a.v, b.v); }
+    friend SimdReal Sqrt(SimdReal a) { return _mm512_sqrt_ps(a.v); }
+    friend SimdReal Abs(SimdReal a) { return _mm512_abs_ps(a.v); }
+    friend SimdMask operator>=(SimdReal a, SimdReal b) { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_GE_OQ) }; }
+    friend SimdMask operator>(SimdReal a, SimdReal b) { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ) }; }
+    friend SimdMask operator<(SimdReal a, SimdReal b) { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ) }; }
+    friend SimdMask operator<=(SimdReal a, SimdReal b) { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_LE_OQ) }; }
+    friend SimdMask operator!=(SimdReal a, SimdReal b) { return { _mm512_cmp_ps_mask(a.v, b.v, _CMP_NEQ_UQ) }; }
+    /// @brief Linie z @p a tam, gdzie maska jest ustawiona, z @p b w pozostałych.
+    friend SimdReal Select(SimdMask mask, SimdReal a, SimdReal b) { return _mm512_mask_blend_ps(mask.v, b.v, a.v); }
+#elif defined(PHYSICS_SIMD_AVX512)
+    static constexpr size_t width = 8;
+    __m512d v;
+
+    SimdReal(__m512d v) :v(v) {}
+    SimdReal(real value) :v(_mm512_set1_pd(value)) {}
+    static SimdReal Load(const real* address) { return _mm512_load_pd(address); }
+    void Store(real* address) const { _mm512_store_pd(address, v); }
+
+    friend SimdReal operator+(SimdReal a, SimdReal b) { return _mm512_add_pd(a.v, b.v); }
+    friend SimdReal operator-(SimdReal a, SimdReal b) { return _mm512_sub_pd(a.v, b.v); }
+    friend SimdReal operator*(SimdReal a, SimdReal b) { return _mm512_mul_pd(a.v, b.v); }
+    friend SimdReal operator/(SimdReal a, SimdReal b) { return _mm512_div_pd(a.v, b.v); }
+    friend SimdReal Sqrt(SimdReal a) { return _mm512_sqrt_pd(a.v); }
+    friend SimdReal Abs(SimdReal a) { return _mm512_abs_pd(a.v); }
+    friend SimdMask operator>=(SimdReal a, SimdReal b) { return { _mm512_cmp_pd_mask(a.v, b.v, _CMP_GE_OQ) }; }
+    friend SimdMask operator>(SimdReal a, SimdReal b) { return { _mm512_cmp_pd_mask(a.v, b.v, _CMP_GT_OQ) }; }
+    friend SimdMask operator<(SimdReal a, SimdReal b) { return { _mm512_cmp_pd_mask(a.v, b.v, _CMP_LT_OQ) }; }
+    friend SimdMask operator<=(SimdReal a, SimdReal b) { return { _mm512_cmp_pd_mask(a.v, b.v, _CMP_LE_OQ) }; }
+    friend SimdMask operator!=(SimdReal a, SimdReal b) { return { _mm512_cmp_pd_mask(a.v, b.v, _CMP_NEQ_UQ) }; }
+    /// @brief Linie z @p a tam, gdzie maska jest ustawiona, z @p b w pozostałych.
+    friend SimdReal Select(SimdMask mask, SimdReal a, SimdReal b) { return _mm512_mask_blend_pd(mask.v, b.v, a.v); }
+#elif defined(PHYSICS_SIMD_AVX) && defined(PHYSICS_SINGLE_PRECISION)
+    static constexpr size_t width = 8;
+    __m256 v;
+
+    SimdReal(__m256 v) :v(v) {}
+    SimdReal(real value) :v(_mm256_set1_ps(value)) {}
+    static SimdReal Load(const real* address) { return _mm256_load_ps(address); }
+    void Store(real* address) const { _mm256_store_ps(address, v); }
+
+    friend SimdReal operator+(SimdReal a, SimdReal b) { return _mm256_add_ps(a.v, b.v); }
+    friend SimdReal operator-(SimdReal a, SimdReal b) { return _mm256_sub_ps(a.v, b.v); }
+    friend SimdReal operator*(SimdReal a, SimdReal b) { return _mm256_mul_ps(a.v, b.v); }
+    friend SimdReal operator/(SimdReal a, SimdReal b) { return _mm256_div_ps(a.v, b.v); }
+    friend SimdReal Sqrt(SimdReal a) { return _mm256_sqrt_ps(a.v); }
+    friend SimdReal Abs(SimdReal a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v); }
+    friend SimdMask operator>=(SimdReal a, SimdReal b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ) }; }
+    friend SimdMask operator>(SimdReal a, SimdReal b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+    friend SimdMask operator<(SimdReal a, SimdReal b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+    friend SimdMask operator<=(SimdReal a, SimdReal b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+    friend SimdMask operator!=(SimdReal a, SimdReal b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_NEQ_UQ) }; }
+    /// @brief Linie z @p a tam, gdzie maska jest ustawiona, z @p b w pozostałych.
+    friend SimdReal Select(SimdMask mask, SimdReal a, SimdReal b) { return _mm256_blendv_ps(b.v, a.v, mask.v); }
+#elif defined(PHYSICS_SIMD_AVX)
+    static constexpr size_t width = 4;
+    __m256d v;
+
+    SimdReal(__m256d v) :v(v) {}
+    SimdReal(real value) :v(_mm256_set1_pd(value)) {}
+    static SimdReal Load(const real* address) { return _mm256_load_pd(address); }
+    void Store(real* address) const { _mm256_store_pd(address, v); }
+
+    friend SimdReal operator+(SimdReal a, SimdReal b) { return _mm256_add_pd(a.v, b.v); }
+    friend SimdReal operator-(SimdReal a, SimdReal b) { return _mm256_sub_pd(a.v, b.v); }
+    friend SimdReal operator*(SimdReal a, SimdReal b) { return _mm256_mul_pd(a.v, b.v); }
+    friend SimdReal operator/(SimdReal a, SimdReal b) { return _mm256_div_pd(a.v, b.v); }
+    friend SimdReal Sqrt(SimdReal a) { return _mm256_sqrt_pd(a.v); }
+    friend SimdReal Abs(SimdReal a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v); }
+    friend SimdMask operator>=(SimdReal a, SimdReal b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_GE_OQ) }; }
+    friend SimdMask operator>(SimdReal a, SimdReal b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ) }; }
+    friend SimdMask operator<(SimdReal a, SimdReal b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ) }; }
+    friend SimdMask operator<=(SimdReal a, SimdReal b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_LE_OQ) }; }
+    friend SimdMask operator!=(SimdReal a, SimdReal b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_NEQ_UQ) }; }
+    /// @brief Linie z @p a tam, gdzie maska jest ustawiona, z @p b w pozostałych.
+    friend SimdReal Select(SimdMask mask, SimdReal a, SimdReal b) { return _mm256_blendv_pd(b.v, a.v, mask.v); }
+#elif defined(PHYSICS_SIMD_SSE2) && defined(PHYSICS_SINGLE_PRECISION)
+    static constexpr size_t width = 4;
+    __m128 v;
+
+    SimdReal(__m128 v) :v(v) {}
+    SimdReal(real value) :v(_mm_set1_ps(value)) {}
+    static SimdReal Load(const real* address) { return _mm_load_ps(address); }
+    void Store(real* address) const { _mm_store_ps(address, v); }
+
+    friend SimdReal operator+(SimdReal a, SimdReal b) { return _mm_add_ps(a.v, b.v); }
+    friend SimdReal operator-(SimdReal a, SimdReal b) { return _mm_sub_ps(a.v, b.v); }
+    friend SimdReal operator*(SimdReal a, SimdReal b) { return _mm_mul_ps(a.v, b.v); }
+    friend SimdReal operator/(SimdReal a, SimdReal b) { return _mm_div_ps(a.v, b.v); }
+    friend SimdReal Sqrt(SimdReal a) { return _mm_sqrt_ps(a.v); }
+    friend SimdReal Abs(SimdReal a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+    friend SimdMask operator>=(SimdReal a, SimdReal b) { return { _mm_cmpge_ps(a.v, b.v) }; }
+    friend SimdMask operator>(SimdReal a, SimdReal b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+    friend SimdMask operator<(SimdReal a, SimdReal b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+    friend SimdMask operator<=(SimdReal a, SimdReal b) { return { _mm_cmple_ps(a.v, b.v) }; }
+    friend SimdMask operator!=(SimdReal a, SimdReal b) { return { _mm_cmpneq_ps(a.v, b.v) }; }
+    /// @brief Linie z @p a tam, gdzie maska jest ustawiona, z @p b w pozostałych.
+    friend SimdReal Select(SimdMask mask, SimdReal a, SimdReal b) { return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)); }
+#elif defined(PHYSICS_SIMD_SSE2)
+    static constexpr size_t width = 2;
+    __m128d v;
+
+    SimdReal(__m128d v) :v(v) {}
+    SimdReal(real value) :v(_mm_set1_pd(value)) {}
+    static SimdReal Load(const real* address) { return _mm_load_pd(address); }
+    void Store(real* address) const { _mm_store_pd(address, v); }
+
+    friend SimdReal operator+(SimdReal a, SimdReal b) { return _mm_add_pd(a.v, b.v); }
+    friend SimdReal operator-(SimdReal a, SimdReal b) { return _mm_sub_pd(a.v, b.v); }
+    friend SimdReal operator*(SimdReal a, SimdReal b) { return _mm_mul_pd(a.v, b.v); }
+    friend SimdReal operator/(SimdReal a, SimdReal b) { return _mm_div_pd(a.v, b.v); }
+    friend SimdReal Sqrt(SimdReal a) { return _mm_sqrt_pd(a.v); }
+    friend SimdReal Abs(SimdReal a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a.v); }
+    friend SimdMask operator>=(SimdReal a, SimdReal b) { return { _mm_cmpge_pd(a.v, b.v) }; }
+    friend SimdMask operator>(SimdReal a, SimdReal b) { return { _mm_cmpgt_pd(a.v, b.v) }; }
+    friend SimdMask operator<(SimdReal a, SimdReal b) { return { _mm_cmplt_pd(a.v, b.v) }; }
+    friend SimdMask operator<=(SimdReal a, SimdReal b) { return { _mm_cmple_pd(a.v, b.v) }; }
+    friend SimdMask operator!=(SimdReal a, SimdReal b) { return { _mm_cmpneq_pd(a.v, b.v) }; }
+    /// @brief Linie z @p a tam, gdzie maska jest ustawiona, z @p b w pozostałych.
+    friend SimdReal Select(SimdMask mask, SimdReal a, SimdReal b) { return _mm_or_pd(_mm_and_pd(mask.v, a.v), _mm_andnot_pd(mask.v, b.v)); }
+#else
+    static constexpr size_t width = 1;
+    real v;
+
+    SimdReal(real value) :v(value) {}
+    static SimdReal Load(const real* address) { return *address; }
+    void Store(real* address) const { *address = v; }
+
+    friend SimdReal operator+(SimdReal a, SimdReal b) { return a.v + b.v; }
+    friend SimdReal operator-(SimdReal a, SimdReal b) { return a.v - b.v; }
+    friend SimdReal operator*(SimdReal a, SimdReal b) { return a.v * b.v; }
+    friend SimdReal operator/(SimdReal a, SimdReal b) { return a.v / b.v; }
+    friend SimdReal Sqrt(SimdReal a) { return std::sqrt(a.v); }
+    friend SimdReal Abs(SimdReal a) { return std::abs(a.v); }
+    friend SimdMask operator>=(SimdReal a, SimdReal b) { return { a.v >= b.v }; }
+    friend SimdMask operator>(SimdReal a, SimdReal b) { return { a.v > b.v }; }
+    friend SimdMask operator<(SimdReal a, SimdReal b) { return { a.v < b.v }; }
+    friend SimdMask operator<=(SimdReal a, SimdReal b) { return { a.v <= b.v }; }
+    friend SimdMask operator!=(SimdReal a, SimdReal b) { return { a.v != b.v }; }
+    /// @brief Linie z @p a tam, gdzie maska jest ustawiona, z @p b w pozostałych.
+    friend SimdReal Select(SimdMask mask, SimdReal a, SimdReal b) { return mask.v ? a : b; }
+#endif
+
+    /// @brief Wyrównanie tablic czytanych przez Load, szerokość rejestru AVX-512 niezależnie od wybranej szerokości.
+    static constexpr size_t alignment = 64;
+
+    SimdReal() {}
+
+    friend SimdReal operator-(SimdReal a) { return SimdReal(real(0)) - a; }
+    SimdReal& operator+=(SimdReal b) { return *this = *this + b; }
+    SimdReal& operator-=(SimdReal b) { return *this = *this - b; }
+    SimdReal& operator*=(SimdReal b) { return *this = *this * b; }
+};
@@ -0,0 +1,57 @@
+#include "SimulationIslands.h"
+
+uint32_t SimulationIslands::Find(uint32_t body)
+{
+    // Skracanie ścieżki przez połowienie.
+    while (parents[body] != body)
+    {
+        parents[body] = parents[parents[body]];
+        body = parents[body];
+    }
+    return body;
+}
+
+void SimulationIslands::Build(uint32_t bodyCount, const std::vector<std::pair<uint32_t, uint32_t>>& edges)
+{
+    parents.resize(bodyCount);
+    for (uint32_t i = 0; i < bodyCount; i++)
+        parents[i] = i;
+
+    // Korzeniem zbioru zostaje mniejszy indeks, dzięki czemu numeracja wysp nie zależy od kolejności krawędzi.
+    for (auto [a, b] : edges)
+    {
+        uint32_t rootA = Find(a);
+        uint32_t rootB = Find(b);
+        if (rootA < rootB)
+            parents[rootB] = rootA;
+        else if (rootB < rootA)
+            parents[rootA] = rootB;
+    }
+
+    // Wyspy numerowane są w kolejności najmniejszego obiektu, który do nich należy.
+    bodyIslands.resize(bodyCount);
+    islandStarts.assign(1, 0);
+    for (uint32_t i = 0; i < bodyCount; i++)
+    {
+        uint32_t root = Find(i);
+        if (root == i)
+        {
+            bodyIslands[i] = islandStarts.size() - 1;
+            islandStarts.push_back(0);
+        }
+        else
+            bodyIslands[i] = bodyIslands[root];
+
+        islandStarts[bodyIslands[i] + 1]++;
+    }
+
+    for (size_t i = 1; i < islandStarts.size(); i++)
+        islandStarts[i] += islandStarts[i - 1];
+
+    // Rozkładanie obiektów do przedziałów wysp, parents nie jest już potrzebne i służy za liczniki.
+    members.resize(bodyCount);
+    for (size_t i = 0; i + 1 < islandStarts.size(); i++)
+        parents[i] = islandStarts[i];
+    for (uint32_t i = 0; i < bodyCount; i++)
+        members[parents[bodyIslands[i]]++] = i;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/// @brief Podział obiektów na wyspy, czyli spójne składowe grafu kontaktów.
+/// @details Wyspy wyznaczane są przez zbiory rozłączne (union-find), a obiekty jednej wyspy przechowywane są w ciągłym przedziale tablicy,
+/// w kolejności rosnących indeksów. Obiekty statyczne nie powinny być podawane w krawędziach, bo łączyłyby wszystko, co na nich leży.
+class SimulationIslands
+{
+    std::vector<uint32_t> parents;
+    std::vector<uint32_t> bodyIslands;
+    std::vector<uint32_t> islandStarts;
+    std::vector<uint32_t> members;
+
+public:
+    /// @brief Wyznacza wyspy.
+    /// @param bodyCount liczba obiektów, każdy obiekt bez krawędzi tworzy własną wyspę
+    /// @param edges pary indeksów obiektów w kontakcie
+    void Build(uint32_t bodyCount, const std::vector<std::pair<uint32_t, uint32_t>>& edges);
+
+    uint32_t GetIslandCount() const { return islandStarts.empty() ? 0 : islandStarts.size() - 1; }
+
+    /// @brief Wyspa, do której należy obiekt @p body .
+    uint32_t GetIsland(uint32_t body) const { return bodyIslands[body]; }
+
+    /// @brief Indeksy obiektów wyspy @p island .
+    const uint32_t* begin(uint32_t island) const { return members.data() + islandStarts[island]; }
+    const uint32_t* end(uint32_t island) const { return members.data() + islandStarts[island + 1]; }
+
+private:
+    uint32_t Find(uint32_t body);
+};
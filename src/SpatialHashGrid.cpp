@@ -0,0 +1,56 @@
+#include "SpatialHashGrid.h"
+#include <algorithm>
+
+glm::ivec3 SpatialHashGrid::GetCell(const rvec3& point) const
+{
+    return glm::ivec3(glm::floor(point / cellSize));
+}
+
+uint64_t SpatialHashGrid::GetKey(const rvec3& point) const
+{
+    return GetKey(GetCell(point));
+}
+
+uint64_t SpatialHashGrid::GetKey(const glm::ivec3& cell)
+{
+    // Po 21 bitów na oś, sąsiednie komórki w osi z mają sąsiednie klucze.
+    const uint64_t mask = (1ull << 21) - 1;
+    return ((uint64_t(cell.x) & mask) << 42) | ((uint64_t(cell.y) & mask) << 21) | (uint64_t(cell.z) & mask);
+}
+
+void SpatialHashGrid::Build(const std::vector<AABB>& boxes, real cellSize)
+{
+    this->boxes = boxes;
+    // Zerowy rozmiar, np. mediana promieni samych punktów, oznaczałby dzielenie przez zero w GetCell.
+    this->cellSize = cellSize > minCellSize ? cellSize : minCellSize;
+    entries.clear();
+    oversized.clear();
+    regular.clear();
+
+    for (uint32_t i = 0; i < boxes.size(); i++)
+    {
+        glm::ivec3 min = GetCell(boxes[i].min);
+        glm::ivec3 max = GetCell(boxes[i].max);
+        glm::ivec3 span = max - min + 1;
+        if (span.x > maxCellsPerAxis || span.y > maxCellsPerAxis || span.z > maxCellsPerAxis)
+        {
+            oversized.push_back(i);
+            continue;
+        }
+
+        regular.push_back(i);
+        for (int x = min.x; x <= max.x; x++)
+            for (int y = min.y; y <= max.y; y++)
+                for (int z = min.z; z <= max.z; z++)
+                    entries.push_back(Entry{ GetKey(glm::ivec3(x, y, z)), i });
+    }
+
+    std::sort(entries.begin(), entries.end());
+
+    // Początek każdej komórki w posortowanej tablicy wpisów, ostatni element to koniec tablicy.
+    cellStarts.clear();
+    for (uint32_t i = 0; i < entries.size(); i++)
+        if (i == 0 || entries[i].key != entries[i - 1].key)
+            cellStarts.push_back(i);
+    cellStarts.push_back(entries.size());
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include "Real.h"
+#include <vector>
+#include <cstdint>
+#include "DynamicAABBTree.h"
+#include "ThreadPool.h"
+
+/// @brief Jednorodna siatka przestrzenna używana w szerokiej fazie wykrywania kolizji dla wielu obiektów podobnej wielkości.
+/// @details Każdy obiekt jest wpisywany do wszystkich komórek, na które nachodzi jego prostopadłościan.
+/// Wpisy przechowywane są w jednej tablicy posortowanej po kluczu komórki, a komórka to przedział tej tablicy,
+/// dzięki czemu przechodzenie po komórkach jest liniowe w pamięci i łatwo dzieli się między wątki.
+/// Obiekty dużo większe od komórki są trzymane osobno i sprawdzane z wszystkimi pozostałymi.
+class SpatialHashGrid
+{
+    struct Entry
+    {
+        uint64_t key;
+        uint32_t index;
+
+        bool operator<(const Entry& rhs) const { return key < rhs.key || (key == rhs.key && index < rhs.index); }
+    };
+
+    std::vector<AABB> boxes;
+    std::vector<Entry> entries;
+    std::vector<uint32_t> cellStarts;
+    std::vector<uint32_t> oversized;
+    std::vector<uint32_t> regular;
+    real cellSize;
+
+public:
+    /// @brief Maksymalna liczba komórek na oś, na które może nachodzić obiekt, większe obiekty trafiają na osobną listę.
+    static constexpr int maxCellsPerAxis = 4;
+    /// @brief Najmniejszy rozmiar komórki, mniejsze, zerowe i nieokreślone rozmiary są do niego zwiększane.
+    static constexpr real minCellSize = 1e-3;
+
+    SpatialHashGrid() :cellSize(1) {}
+
+    /// @brief Rozmiar komórki siatki.
+    real GetCellSize() const { return cellSize; }
+
+    /// @brief Liczba niepustych komórek.
+    uint32_t GetCellCount() const { return cellStarts.empty() ? 0 : cellStarts.size() - 1; }
+
+    /// @brief Buduje siatkę od nowa.
+    /// @param boxes prostopadłościany obiektów, indeks w tablicy jest identyfikatorem obiektu
+    /// @param cellSize rozmiar komórki, mniejszy od @ref minCellSize jest do niego zwiększany
+    void Build(const std::vector<AABB>& boxes, real cellSize);
+
+    /// @brief Znajduje wszystkie pary obiektów, których prostopadłościany na siebie nachodzą.
+    /// @details Komórki są przetwarzane równolegle, para leżąca w kilku komórkach jest zgłaszana tylko przez komórkę,
+    /// w której leży minimalny narożnik części wspólnej ich prostopadłościanów.
+    /// @param filter funkcja przyjmująca indeksy obiektów i < j, zwracająca czy para ma zostać zapisana, wywoływana z wielu wątków
+    /// @param threadPairs wyjściowe pary, osobna lista dla każdego wątku
+    template <typename TFilter>
+    void FindPairs(TFilter&& filter, std::vector<std::vector<std::pair<uint32_t, uint32_t>>>& threadPairs) const
+    {
+        threadPairs.resize(ThreadPool::GetThreadSlotCount());
+        for (auto&& pairs : threadPairs)
+            pairs.clear();
+
+        auto report = [&](uint32_t a, uint32_t b, uint32_t thread) {
+            if (a > b)
+                std::swap(a, b);
+            if (filter(a, b))
+                threadPairs[thread].emplace_back(a, b);
+            };
+
+        ThreadPool::ParallelFor(GetCellCount(), 64, [&](uint32_t begin, uint32_t end, uint32_t thread) {
+            for (uint32_t cell = begin; cell < end; cell++)
+            {
+                uint64_t key = entries[cellStarts[cell]].key;
+                for (uint32_t i = cellStarts[cell]; i < cellStarts[cell + 1]; i++)
+                {
+                    const AABB& a = boxes[entries[i].index];
+                    for (uint32_t j = i + 1; j < cellStarts[cell + 1]; j++)
+                    {
+                        const AABB& b = boxes[entries[j].index];
+                        if (!a.Overlaps(b))
+                            continue;
+
+                        if (GetKey(glm::max(a.min, b.min)) != key)
+                            continue;
+
+                        report(entries[i].index, entries[j].index, thread);
+                    }
+                }
+            }
+            });
+
+        // Duże obiekty są sprawdzane ze wszystkimi obiektami z siatki oraz między sobą.
+        ThreadPool::ParallelFor(regular.size(), 1024, [&](uint32_t begin, uint32_t end, uint32_t thread) {
+            for (uint32_t big : oversized)
+                for (uint32_t i = begin; i < end; i++)
+                    if (boxes[big].Overlaps(boxes[regular[i]]))
+                        report(big, regular[i], thread);
+            });
+
+        for (uint32_t i = 0; i < oversized.size(); i++)
+            for (uint32_t j = i + 1; j < oversized.size(); j++)
+                if (boxes[oversized[i]].Overlaps(boxes[oversized[j]]))
+                    report(oversized[i], oversized[j], 0);
+    }
+
+private:
+    glm::ivec3 GetCell(const rvec3& point) const;
+    uint64_t GetKey(const rvec3& point) const;
+    static uint64_t GetKey(const glm::ivec3& cell);
+};
@@ -0,0 +1,217 @@
+#include "SweepAndPrune.h"
+#include <algorithm>
+
+uint64_t SweepAndPrune::GetPairKey(uint32_t a, uint32_t b)
+{
+    if (a > b)
+        std::swap(a, b);
+    return (uint64_t(a) << 32) | b;
+}
+
+void SweepAndPrune::Build(const std::vector<AABB>& boxes, real margin)
+{
+    proxies.resize(boxes.size());
+    pairs.clear();
+    pairIndices.clear();
+    touchedPairs.clear();
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        auto& axisEndpoints = endpoints[axis];
+        axisEndpoints.resize(boxes.size() * 2);
+        for (uint32_t i = 0; i < boxes.size(); i++)
+        {
+            proxies[i].box = boxes[i].Expanded(margin);
+            axisEndpoints[i * 2] = Endpoint{ proxies[i].box.min[axis], i << 1 };
+            axisEndpoints[i * 2 + 1] = Endpoint{ proxies[i].box.max[axis], (i << 1) | 1 };
+        }
+
+        // Przy równych wartościach początki są przed końcami, tak samo jak w AABB::Overlaps stykające się przedziały nachodzą na siebie.
+        std::sort(axisEndpoints.begin(), axisEndpoints.end(), [](const Endpoint& a, const Endpoint& b) {
+            return a.value < b.value || (a.value == b.value && a.IsMax() < b.IsMax());
+            });
+
+        for (uint32_t i = 0; i < axisEndpoints.size(); i++)
+            proxies[axisEndpoints[i].GetProxy()].endpoints[axis][axisEndpoints[i].IsMax()] = i;
+    }
+
+    // Początkowe pary wyznaczane są jednym przejściem po osi x, z listą otwartych przedziałów.
+    std::vector<uint32_t> active;
+    std::vector<uint32_t> activeIndices(boxes.size());
+    for (const Endpoint& endpoint : endpoints[0])
+    {
+        uint32_t proxy = endpoint.GetProxy();
+        if (endpoint.IsMax())
+        {
+            uint32_t last = active.back();
+            active[activeIndices[proxy]] = last;
+            activeIndices[last] = activeIndices[proxy];
+            active.pop_back();
+            continue;
+        }
+
+        for (uint32_t other : active)
+            if (proxies[proxy].box.Overlaps(proxies[other].box))
+                AddPair(proxy, other);
+
+        activeIndices[proxy] = active.size();
+        active.push_back(proxy);
+    }
+
+    FinishUpdate();
+}
+
+void SweepAndPrune::Update(const std::vector<AABB>& boxes, real margin)
+{
+    if (boxes.size() != proxies.size())
+    {
+        Build(boxes, margin);
+        return;
+    }
+
+    for (uint32_t i = 0; i < boxes.size(); i++)
+        MoveProxy(i, boxes[i], margin);
+
+    FinishUpdate();
+}
+
+bool SweepAndPrune::MoveProxy(uint32_t proxy, const AABB& box, real margin)
+{
+    Proxy& p = proxies[proxy];
+    if (p.box.Contains(box))
+        return false;
+
+    AABB oldBox = p.box;
+    p.box = box.Expanded(margin);
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        auto& axisEndpoints = endpoints[axis];
+        axisEndpoints[p.endpoints[axis][0]].value = p.box.min[axis];
+        axisEndpoints[p.endpoints[axis][1]].value = p.box.max[axis];
+
+        // Najpierw przesuwane są końce powiększające przedział, początek nigdy nie mija końca tego samego przedziału.
+        if (p.box.min[axis] < oldBox.min[axis])
+            ShiftDown(axis, p.endpoints[axis][0]);
+        if (p.box.max[axis] > oldBox.max[axis])
+            ShiftUp(axis, p.endpoints[axis][1]);
+        if (p.box.min[axis] > oldBox.min[axis])
+            ShiftUp(axis, p.endpoints[axis][0]);
+        if (p.box.max[axis] < oldBox.max[axis])
+            ShiftDown(axis, p.endpoints[axis][1]);
+    }
+
+    return true;
+}
+
+void SweepAndPrune::ShiftDown(int axis, uint32_t index)
+{
+    auto& axisEndpoints = endpoints[axis];
+    Endpoint endpoint = axisEndpoints[index];
+    uint32_t proxy = endpoint.GetProxy();
+
+    while (index > 0 && axisEndpoints[index - 1].value > endpoint.value)
+    {
+        const Endpoint& previous = axisEndpoints[index - 1];
+        uint32_t other = previous.GetProxy();
+
+        // Początek mijający koniec innego przedziału oznacza możliwe nowe nachodzenie,
+        // koniec mijający początek oznacza, że przedziały się rozłączyły.
+        if (!endpoint.IsMax() && previous.IsMax())
+        {
+            if (proxies[proxy].box.Overlaps(proxies[other].box))
+                AddPair(proxy, other);
+        }
+        else if (endpoint.IsMax() && !previous.IsMax())
+            RemovePair(proxy, other);
+
+        proxies[other].endpoints[axis][previous.IsMax()] = index;
+        axisEndpoints[index] = previous;
+        index--;
+    }
+
+    axisEndpoints[index] = endpoint;
+    proxies[proxy].endpoints[axis][endpoint.IsMax()] = index;
+}
+
+void SweepAndPrune::ShiftUp(int axis, uint32_t index)
+{
+    auto& axisEndpoints = endpoints[axis];
+    Endpoint endpoint = axisEndpoints[index];
+    uint32_t proxy = endpoint.GetProxy();
+
+    while (index + 1 < axisEndpoints.size() && axisEndpoints[index + 1].value < endpoint.value)
+    {
+        const Endpoint& next = axisEndpoints[index + 1];
+        uint32_t other = next.GetProxy();
+
+        if (endpoint.IsMax() && !next.IsMax())
+        {
+            if (proxies[proxy].box.Overlaps(proxies[other].box))
+                AddPair(proxy, other);
+        }
+        else if (!endpoint.IsMax() && next.IsMax())
+            RemovePair(proxy, other);
+
+        proxies[other].endpoints[axis][next.IsMax()] = index;
+        axisEndpoints[index] = next;
+        index++;
+    }
+
+    axisEndpoints[index] = endpoint;
+    proxies[proxy].endpoints[axis][endpoint.IsMax()] = index;
+}
+
+SweepAndPrune::Pair& SweepAndPrune::TouchPair(uint32_t index)
+{
+    Pair& pair = pairs[index];
+    if (!pair.touched)
+    {
+        pair.touched = true;
+        touchedPairs.push_back(GetPairKey(pair.a, pair.b));
+    }
+    return pair;
+}
+
+void SweepAndPrune::AddPair(uint32_t a, uint32_t b)
+{
+    uint64_t key = GetPairKey(a, b);
+    auto [it, inserted] = pairIndices.try_emplace(key, pairs.size());
+    if (inserted)
+    {
+        pairs.push_back(Pair{ std::min(a, b), std::max(a, b), true, true });
+        touchedPairs.push_back(key);
+        return;
+    }
+
+    TouchPair(it->second).overlapping = true;
+}
+
+void SweepAndPrune::RemovePair(uint32_t a, uint32_t b)
+{
+    auto it = pairIndices.find(GetPairKey(a, b));
+    if (it == pairIndices.end())
+        return;
+
+    TouchPair(it->second).overlapping = false;
+}
+
+void SweepAndPrune::FinishUpdate()
+{
+    // Para mogła zostać dodana i usunięta w jednej aktualizacji, liczy się tylko stan po niej.
+    for (uint64_t key : touchedPairs)
+    {
+        uint32_t index = pairIndices[key];
+        Pair& pair = pairs[index];
+        pair.touched = false;
+        if (pair.overlapping)
+            continue;
+
+        Pair& last = pairs.back();
+        pairIndices[GetPairKey(last.a, last.b)] = index;
+        pair = last;
+        pairs.pop_back();
+        pairIndices.erase(key);
+    }
+    touchedPairs.clear();
+}
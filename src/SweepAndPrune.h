@@ -0,0 +1,87 @@
+#pragma once
+#include "Real.h"
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "DynamicAABBTree.h"
+
+/// @brief Przyrostowy algorytm sortowania i przycinania (sweep and prune) używany w szerokiej fazie wykrywania kolizji.
+/// @details Dla każdej osi przechowuje posortowaną tablicę końców przedziałów prostopadłościanów.
+/// Przesunięcie obiektu przesuwa jego końce sortowaniem przez wstawianie, a każda zamiana początku z końcem innego przedziału
+/// oznacza, że para mogła zacząć lub przestać na siebie nachodzić. Dzięki temu koszt aktualizacji końców i listy par zależy od liczby obiektów,
+/// które się poruszyły, a nie od liczby wszystkich obiektów. Tak jak w drzewie prostopadłościany są powiększane, by drobny ruch nie wymagał zmian.
+/// Zmiany listy par nie są udostępniane, bo ColliderManager w każdym kroku dokładnie sprawdza wszystkie pary z GetPairs , więc ta część kosztu
+/// zależy od liczby nachodzących par.
+class SweepAndPrune
+{
+public:
+    /// @brief Para obiektów, których prostopadłościany na siebie nachodzą, a < b.
+    struct Pair
+    {
+        uint32_t a;
+        uint32_t b;
+        /// @brief Stan w trakcie aktualizacji, po jej zakończeniu zawsze prawda.
+        bool overlapping;
+        bool touched;
+    };
+
+private:
+    struct Endpoint
+    {
+        real value;
+        /// @brief Indeks obiektu przesunięty o jeden bit, najmłodszy bit oznacza koniec przedziału.
+        uint32_t data;
+
+        uint32_t GetProxy() const { return data >> 1; }
+        bool IsMax() const { return data & 1; }
+    };
+
+    struct Proxy
+    {
+        AABB box;
+        /// @brief Indeksy początku i końca przedziału w tablicach końców kolejnych osi.
+        uint32_t endpoints[3][2];
+    };
+
+    std::vector<Endpoint> endpoints[3];
+    std::vector<Proxy> proxies;
+    std::vector<Pair> pairs;
+    std::unordered_map<uint64_t, uint32_t> pairIndices;
+    std::vector<uint64_t> touchedPairs;
+
+public:
+    /// @brief Liczba obiektów.
+    uint32_t GetProxyCount() const { return proxies.size(); }
+
+    /// @brief Buduje struktury od nowa.
+    /// @param boxes prostopadłościany obiektów, indeks w tablicy jest identyfikatorem obiektu
+    /// @param margin o ile powiększyć prostopadłościany
+    void Build(const std::vector<AABB>& boxes, real margin);
+
+    /// @brief Przesuwa obiekty do nowych prostopadłościanów i aktualizuje listę par.
+    /// @details Jeżeli liczba obiektów się zmieniła, struktury są budowane od nowa.
+    /// @param boxes prostopadłościany obiektów, indeks w tablicy jest identyfikatorem obiektu
+    /// @param margin o ile powiększyć prostopadłościany, które wyszły poza swój powiększony prostopadłościan
+    void Update(const std::vector<AABB>& boxes, real margin);
+
+    /// @brief Powiększony prostopadłościan obiektu.
+    const AABB& GetFatAABB(uint32_t proxy) const { return proxies[proxy].box; }
+
+    /// @brief Wszystkie pary, których powiększone prostopadłościany na siebie nachodzą.
+    const std::vector<Pair>& GetPairs() const { return pairs; }
+
+private:
+    /// @brief Przesuwa obiekt, zwraca fałsz jeżeli @p box mieści się w dotychczasowym prostopadłościanie.
+    bool MoveProxy(uint32_t proxy, const AABB& box, real margin);
+
+    void ShiftDown(int axis, uint32_t index);
+    void ShiftUp(int axis, uint32_t index);
+
+    void AddPair(uint32_t a, uint32_t b);
+    void RemovePair(uint32_t a, uint32_t b);
+    Pair& TouchPair(uint32_t index);
+    /// @brief Usuwa pary, które przestały na siebie nachodzić.
+    void FinishUpdate();
+
+    static uint64_t GetPairKey(uint32_t a, uint32_t b);
+};
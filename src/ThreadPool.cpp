@@ -0,0 +1,320 @@
+#include "ThreadPool.h"
+#include <cstdlib>
+#include <algorithm>
+#include <bit>
+#include <iostream>
+
+/// @brief Zadanie z funkcją i listą zadań, które od niego zależą.
+struct ThreadPool::Task
+{
+    std::function<void()> function;
+    /// @brief Liczba niezakończonych zależności, do końca Submit powiększona o jeden, żeby zadanie nie trafiło do kolejki przed dodaniem wszystkich.
+    std::atomic<uint32_t> pendingDependencies = 1;
+    std::atomic<bool> done = false;
+    /// @brief Chroni successors i ustawienie done, dzięki czemu następnik dodany w Submit nie zostanie pominięty.
+    std::mutex mutex;
+    std::vector<TaskHandle> successors;
+};
+
+/// @brief Kolejka dwustronna jednego wątku, właściciel używa końca, a pozostałe wątki podkradają z początku.
+struct ThreadPool::Queue
+{
+    std::mutex mutex;
+    std::deque<TaskHandle> tasks;
+};
+
+/// @brief Stan jednego wywołania ParallelFor, współdzielony przez wątek wywołujący i zadania pomocnicze.
+/// @details Zadanie pomocnicze, które zacznie się po zakończeniu pętli, nie znajdzie już fragmentów i nie odczyta function.
+struct ThreadPool::Loop
+{
+    const std::function<void(uint32_t, uint32_t)>* function;
+    uint32_t chunkCount;
+    std::atomic<uint32_t> nextChunk = 0;
+    std::atomic<uint32_t> finishedChunks = 0;
+};
+
+/// @brief Indeks wątku spoza puli, zwalniany przy zakończeniu wątku, jeżeli pula nie została w międzyczasie utworzona od nowa.
+struct ThreadPool::ExternalSlot
+{
+    uint32_t slot = maxExternalThreads;
+    uint64_t slotGeneration = 0;
+
+    ~ExternalSlot()
+    {
+        if (slot < maxExternalThreads && slotGeneration == generation)
+            externalSlots.fetch_and(~(1u << slot));
+    }
+};
+
+/// @brief Ile razy wątek roboczy bez zadań sprawdza kolejki, zanim zaśnie, kolejne ParallelFor kroku fizyki następują szybciej niż budzenie wątku.
+static constexpr int spinCount = 256;
+
+void ThreadPool::Init(uint32_t threadCount)
+{
+    Shutdown();
+
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    static bool exitHandlerRegistered = false;
+    if (!exitHandlerRegistered)
+    {
+        std::atexit(Shutdown);
+        exitHandlerRegistered = true;
+    }
+
+    stopping = false;
+    initialized = true;
+    queues.clear();
+    for (uint32_t i = 0; i < threadCount + maxExternalThreads; i++)
+        queues.push_back(std::make_unique<Queue>());
+    queuedTasks = 0;
+    externalSlots = 0;
+
+    // Wątki spoza puli dostaną nowe indeksy przy następnym użyciu, wątek wywołujący ma indeks 0.
+    generation++;
+    threadIndex = 0;
+    threadGeneration = generation;
+
+    for (uint32_t i = 1; i < threadCount; i++)
+        workers.emplace_back(WorkerLoop, i);
+}
+
+void ThreadPool::Shutdown()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+
+    for (auto&& worker : workers)
+        worker.join();
+    workers.clear();
+}
+
+uint32_t ThreadPool::GetThreadCount()
+{
+    if (!initialized)
+        Init();
+
+    return workers.size() + 1;
+}
+
+void ThreadPool::RegisterThread()
+{
+    // Pierwsze użycie puli ją tworzy, a wątek wywołujący dostaje indeks 0.
+    if (!initialized)
+    {
+        Init();
+        return;
+    }
+
+    uint32_t used = externalSlots;
+    uint32_t slot;
+    do
+    {
+        slot = std::countr_one(used);
+        // Wspólny indeks oznaczałby wspólną kolejkę i bufory wątku, więc brak wolnego kończy program.
+        if (slot >= maxExternalThreads)
+        {
+            std::cerr << "Too many threads using ThreadPool\n";
+            std::abort();
+        }
+    } while (!externalSlots.compare_exchange_weak(used, used | (1u << slot)));
+
+    externalSlot.slot = slot;
+    externalSlot.slotGeneration = generation;
+    threadIndex = workers.size() + 1 + slot;
+    threadGeneration = generation;
+}
+
+ThreadPool::TaskHandle ThreadPool::Submit(std::function<void()> function, std::initializer_list<TaskHandle> dependencies)
+{
+    return Submit(std::move(function), std::vector<TaskHandle>(dependencies));
+}
+
+ThreadPool::TaskHandle ThreadPool::Submit(std::function<void()> function, const std::vector<TaskHandle>& dependencies)
+{
+    TaskHandle task = std::make_shared<Task>();
+    task->function = std::move(function);
+    for (auto&& dependency : dependencies)
+    {
+        std::lock_guard lock(dependency->mutex);
+        if (dependency->done)
+            continue;
+
+        dependency->successors.push_back(task);
+        task->pendingDependencies++;
+    }
+
+    if (task->pendingDependencies.fetch_sub(1) == 1)
+        Push(task);
+    return task;
+}
+
+void ThreadPool::Wait(const TaskHandle& task)
+{
+    while (!task->done.load(std::memory_order_acquire))
+    {
+        if (!RunOneTask())
+            std::this_thread::yield();
+    }
+}
+
+bool ThreadPool::IsDone(const TaskHandle& task)
+{
+    return task->done.load(std::memory_order_acquire);
+}
+
+void ThreadPool::Run(uint32_t chunks, const std::function<void(uint32_t, uint32_t)>& function)
+{
+    auto loop = std::make_shared<Loop>();
+    loop->function = &function;
+    loop->chunkCount = chunks;
+
+    uint32_t helpers = std::min(chunks, GetThreadCount()) - 1;
+    for (uint32_t i = 0; i < helpers; i++)
+        Submit([loop]() { ProcessLoop(*loop); });
+
+    ProcessLoop(*loop);
+
+    // Pozostałe fragmenty kończą pomocnicy, w tym czasie wątek wykonuje inne zadania, np. własnych pomocników, którzy nie zdążyli się zacząć.
+    while (loop->finishedChunks.load(std::memory_order_acquire) < chunks)
+    {
+        if (!RunOneTask())
+            std::this_thread::yield();
+    }
+}
+
+void ThreadPool::ProcessLoop(Loop& loop)
+{
+    bool wasInsideTask = insideTask;
+    insideTask = true;
+    uint32_t thread = GetThreadIndex();
+    for (uint32_t chunk = loop.nextChunk++; chunk < loop.chunkCount; chunk = loop.nextChunk++)
+    {
+        (*loop.function)(chunk, thread);
+        loop.finishedChunks.fetch_add(1, std::memory_order_release);
+    }
+    insideTask = wasInsideTask;
+}
+
+void ThreadPool::Push(TaskHandle task)
+{
+    // Licznik rośnie przed dodaniem zadania, więc wątek, który zobaczy puste kolejki i zero, na pewno zostanie obudzony.
+    queuedTasks++;
+    Queue& queue = *queues[GetThreadIndex()];
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+
+    if (sleepingWorkers > 0)
+    {
+        {
+            std::lock_guard lock(mutex);
+        }
+        wakeCondition.notify_one();
+    }
+}
+
+bool ThreadPool::RunOneTask()
+{
+    if (queuedTasks == 0)
+        return false;
+
+    uint32_t index = GetThreadIndex();
+    TaskHandle task;
+    {
+        Queue& queue = *queues[index];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+    }
+
+    for (uint32_t k = 1; k < queues.size() && !task; k++)
+    {
+        Queue& queue = *queues[(index + k) % queues.size()];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+
+    if (!task)
+        return false;
+
+    queuedTasks--;
+    Execute(task);
+    return true;
+}
+
+void ThreadPool::Execute(const TaskHandle& task)
+{
+    bool wasInsideTask = insideTask;
+    insideTask = true;
+    task->function();
+    task->function = nullptr;
+    insideTask = wasInsideTask;
+
+    std::vector<TaskHandle> successors;
+    {
+        std::lock_guard lock(task->mutex);
+        task->done.store(true, std::memory_order_release);
+        successors.swap(task->successors);
+    }
+
+    for (auto&& successor : successors)
+        if (successor->pendingDependencies.fetch_sub(1) == 1)
+            Push(std::move(successor));
+}
+
+void ThreadPool::WorkerLoop(uint32_t index)
+{
+    threadIndex = index;
+    threadGeneration = generation;
+    int idle = 0;
+    while (true)
+    {
+        if (RunOneTask())
+        {
+            idle = 0;
+            continue;
+        }
+
+        if (++idle < spinCount)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        idle = 0;
+
+        std::unique_lock lock(mutex);
+        sleepingWorkers++;
+        wakeCondition.wait(lock, []() { return stopping || queuedTasks > 0; });
+        sleepingWorkers--;
+        if (stopping)
+            return;
+    }
+}
+
+std::vector<std::thread> ThreadPool::workers;
+std::vector<std::unique_ptr<ThreadPool::Queue>> ThreadPool::queues;
+std::mutex ThreadPool::mutex;
+std::condition_variable ThreadPool::wakeCondition;
+std::atomic<uint32_t> ThreadPool::queuedTasks = 0;
+std::atomic<uint32_t> ThreadPool::sleepingWorkers = 0;
+std::atomic<uint32_t> ThreadPool::externalSlots = 0;
+std::atomic<uint64_t> ThreadPool::generation = 0;
+bool ThreadPool::stopping = false;
+bool ThreadPool::initialized = false;
+thread_local uint32_t ThreadPool::threadIndex = 0;
+thread_local uint64_t ThreadPool::threadGeneration = 0;
+thread_local bool ThreadPool::insideTask = false;
+thread_local ThreadPool::ExternalSlot ThreadPool::externalSlot;
@@ -0,0 +1,129 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <initializer_list>
+#include <cstdint>
+#include <algorithm>
+
+/// @brief Pula wątków roboczych z podkradaniem zadań, wspólna dla fizyki, rysowania i wczytywania zasobów.
+/// @details Każdy wątek ma własną kolejkę dwustronną, nowe zadania trafiają na koniec kolejki wątku, który je dodał, a wątek bierze zadania
+/// z końca swojej kolejki, a gdy jest pusta, podkrada z początku kolejek innych wątków. Zadanie może zależeć od innych zadań i trafia do kolejki
+/// dopiero po ich zakończeniu. Wątek czekający na zadanie lub na ParallelFor wykonuje w tym czasie inne zadania z kolejek.
+/// Wątki są tworzone przy pierwszym użyciu, a z puli mogą jednocześnie korzystać wątek, który ją utworzył, i do @ref maxExternalThreads innych wątków,
+/// np. wątek fizyki, indeks zakończonego wątku może dostać kolejny. Zagnieżdżone wywołania ParallelFor z wnętrza zadania wykonywane są szeregowo.
+class ThreadPool
+{
+public:
+    struct Task;
+    /// @brief Uchwyt zadania, utrzymuje zadanie, dopóki ktoś może na nie czekać lub od niego zależeć.
+    using TaskHandle = std::shared_ptr<Task>;
+
+    /// @brief Liczba wątków spoza puli, innych niż wątek, który ją utworzył, które mogą z niej jednocześnie korzystać, użycie przez kolejny kończy program.
+    static constexpr uint32_t maxExternalThreads = 4;
+
+    /// @brief Tworzy pulę z @p threadCount wątkami, wliczając wątek wywołujący.
+    /// @details Nie może być wywoływane, gdy inny wątek korzysta z puli.
+    /// @param threadCount liczba wątków, 0 oznacza liczbę wątków sprzętowych
+    static void Init(uint32_t threadCount = 0);
+
+    /// @brief Zatrzymuje i łączy wszystkie wątki robocze, niewykonane zadania są porzucane.
+    static void Shutdown();
+
+    /// @brief Liczba wątków wykonujących zadania, wliczając wątek wywołujący.
+    static uint32_t GetThreadCount();
+
+    /// @brief Liczba możliwych indeksów wątków, rozmiar buforów indeksowanych przez indeks wątku z ParallelFor.
+    static uint32_t GetThreadSlotCount() { return GetThreadCount() + maxExternalThreads; }
+
+    /// @brief Indeks aktualnego wątku z przedziału [0, GetThreadSlotCount()), 0 to wątek, który utworzył pulę, a wątki robocze mają indeksy od 1.
+    /// @details Inne wątki dostają kolejne wolne indeksy przy pierwszym użyciu puli.
+    static uint32_t GetThreadIndex()
+    {
+        if (threadGeneration != generation.load(std::memory_order_relaxed))
+            RegisterThread();
+        return threadIndex;
+    }
+
+    /// @brief Dodaje zadanie, które zostanie wykonane po zakończeniu wszystkich @p dependencies .
+    /// @param function funkcja zadania
+    /// @param dependencies zadania, które muszą się zakończyć przed tym zadaniem
+    /// @return uchwyt zadania do Wait i jako zależność kolejnych zadań
+    static TaskHandle Submit(std::function<void()> function, std::initializer_list<TaskHandle> dependencies = {});
+    static TaskHandle Submit(std::function<void()> function, const std::vector<TaskHandle>& dependencies);
+
+    /// @brief Czeka na zakończenie zadania, wykonując w tym czasie zadania z kolejek.
+    static void Wait(const TaskHandle& task);
+
+    /// @brief Czy zadanie zostało wykonane.
+    static bool IsDone(const TaskHandle& task);
+
+    /// @brief Dzieli przedział [0, @p count) na fragmenty po @p grainSize elementów i przetwarza je równolegle.
+    /// @details Do kolejki wątku trafia jedno zadanie pomocnicze na każdy wątek roboczy, pomocnicy pobierają kolejne fragmenty z licznika atomowego,
+    /// tak samo jak wątek wywołujący, który po skończeniu fragmentów wykonuje inne zadania, dopóki pomocnicy nie skończą swoich.
+    /// @param count liczba elementów
+    /// @param grainSize liczba elementów w jednym fragmencie
+    /// @param function funkcja przyjmująca początek i koniec fragmentu oraz indeks wątku
+    template <typename TFunction>
+    static void ParallelFor(uint32_t count, uint32_t grainSize, TFunction&& function)
+    {
+        if (count == 0)
+            return;
+
+        if (grainSize == 0)
+            grainSize = 1;
+
+        uint32_t chunks = (count + grainSize - 1) / grainSize;
+        if (chunks == 1 || insideTask || GetThreadCount() == 1)
+        {
+            function(0u, count, GetThreadIndex());
+            return;
+        }
+
+        Run(chunks, [&](uint32_t chunk, uint32_t thread) {
+            uint32_t begin = chunk * grainSize;
+            uint32_t end = std::min(begin + grainSize, count);
+            function(begin, end, thread);
+            });
+    }
+
+private:
+    struct Queue;
+    struct Loop;
+    struct ExternalSlot;
+
+    static std::vector<std::thread> workers;
+    /// @brief Kolejki zadań, kolejka wątku o indeksie i to queues[i].
+    static std::vector<std::unique_ptr<Queue>> queues;
+    static std::mutex mutex;
+    static std::condition_variable wakeCondition;
+    /// @brief Liczba zadań we wszystkich kolejkach.
+    static std::atomic<uint32_t> queuedTasks;
+    /// @brief Liczba wątków roboczych czekających na wakeCondition.
+    static std::atomic<uint32_t> sleepingWorkers;
+    /// @brief Zajęte indeksy wątków spoza puli, bit i oznacza indeks GetThreadCount() + i.
+    static std::atomic<uint32_t> externalSlots;
+    /// @brief Zwiększane przez Init, wątki spoza puli dostają nowe indeksy, gdy ich threadGeneration jest inne.
+    static std::atomic<uint64_t> generation;
+    static bool stopping;
+    static bool initialized;
+    static thread_local uint32_t threadIndex;
+    static thread_local uint64_t threadGeneration;
+    static thread_local bool insideTask;
+    static thread_local ExternalSlot externalSlot;
+
+    static void Run(uint32_t chunks, const std::function<void(uint32_t, uint32_t)>& function);
+    static void ProcessLoop(Loop& loop);
+    static void RegisterThread();
+    static void Push(TaskHandle task);
+    /// @brief Wykonuje jedno zadanie z kolejki wątku lub podkradzione innemu wątkowi.
+    /// @return fałsz jeżeli wszystkie kolejki były puste
+    static bool RunOneTask();
+    static void Execute(const TaskHandle& task);
+    static void WorkerLoop(uint32_t index);
+};
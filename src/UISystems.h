@@ -104,9 +104,34 @@ public:
         ImGui::SliderInt("Liczba przewidywanych krokow", &futureStepCount, 0, 200);
         ImGui::SliderInt("Liczba pod krokow", &subStepCount, 1, 16);
         ImGui::SliderFloat("DeltaT", &deltaT, 0.00001f, 0.1f);
+        ImGui::SliderInt("Maks. liczba krokow na klatke", &Physics::maxTicksPerFrame, 1, 16);
         ImGui::SliderFloat("Restytucja", &restitutionMultiplier, 0.0f, 1.0f);
         ImGui::SliderFloat("Tarcie statyczne", &staticFrictionMultiplier, 0.0f, 1.0f);
         ImGui::SliderFloat("Tarcie dynamiczne", &dynamicFrictionMultiplier, 0.0f, 1.0f);
+        int broadphase = (int)ColliderManager::broadphase;
+        ImGui::Combo("Faza szeroka", &broadphase, "Promien\0Drzewo AABB\0Siatka\0Sweep and prune\0");
+        ColliderManager::broadphase = (ColliderManager::Broadphase)broadphase;
+        ImGui::Checkbox("Analityczne kolizje prostopadloscianow", &ColliderManager::analyticContacts);
+        ImGui::Checkbox("Rozgrzewanie kontaktow", &Physics::warmStarting);
+        ImGui::Checkbox("Usypianie obiektow", &Physics::allowSleeping);
+        ImGui::Checkbox("Ciagle wykrywanie kolizji (CCD)", &Physics::continuousCollisions);
+        ImGui::Checkbox("Kontakty spekulatywne", &Physics::speculativeContacts);
+        ImGui::Checkbox("Adaptacyjna liczba pod krokow", &Physics::adaptiveSubSteps);
+        if (Physics::adaptiveSubSteps)
+        {
+            ImGui::SliderInt("Min. liczba pod krokow", &Physics::minSubStepCount, 1, 16);
+            ImGui::SliderInt("Maks. liczba pod krokow", &Physics::maxSubStepCount, 1, 32);
+        }
+
+        // Liczba pod kroków wybrana w ostatnich klatkach.
+        static float subStepHistory[120] = {};
+        static int historyOffset = 0;
+        const Physics::StepStats& stats = Physics::GetStepStats();
+        subStepHistory[historyOffset] = (float)stats.subStepCount;
+        historyOffset = (historyOffset + 1) % IM_ARRAYSIZE(subStepHistory);
+        std::string overlay = std::to_string(stats.subStepCount) + " pod krokow, " + std::to_string(stats.constraintCount) + " kontaktow";
+        ImGui::PlotLines("Pod kroki", subStepHistory, IM_ARRAYSIZE(subStepHistory), historyOffset, overlay.c_str(), 0.0f, 32.0f, ImVec2(0, 50));
+        ImGui::Text(("Odrzucony czas: " + std::to_string(Physics::GetDroppedTime()) + " s").c_str());
         ImGui::Checkbox("Stop", &stop);
 
         static bool bReleased = false;
@@ -144,7 +169,7 @@ public:
     }
 };
 int SettingsSystem::futureStepCount = 0;
-int SettingsSystem::subStepCount = 8;
+int SettingsSystem::subStepCount = 4;
 float SettingsSystem::deltaT = 1.0 / 70.0;
 float SettingsSystem::restitutionMultiplier = 1;
 float SettingsSystem::staticFrictionMultiplier = 1;
@@ -286,27 +311,32 @@ public:
             auto rigidBodyState = ECS::System<RigidBody>::components;
             auto transformState = ECS::System<Transform>::components;
 
-            std::unordered_set<CollisionPair, CollisionPair::Hash> futurePossibleColliders;
+            CollisionPairBuffer futurePossibleBuffer;
             for (auto&& i : components)
-                ColliderManager::QuarryInRadius(i, 1 + glm::length(i.GetComponent<RigidBody>().velocity) * Physics::deltaT * 2 * futureStepCount, &futurePossibleColliders);
+                ColliderManager::QuarryInRadius(i, 1 + glm::length(i.GetComponent<RigidBody>().velocity) * Physics::deltaT * 2 * futureStepCount, &futurePossibleBuffer);
+            futurePossibleBuffer.SortAndRemoveDuplicates();
+            std::unordered_set<CollisionPair, CollisionPair::Hash> futurePossibleColliders(futurePossibleBuffer.begin(), futurePossibleBuffer.end());
 
             for (int n = 0; n <= futureStepCount; n++)
             {
-                std::unordered_set<CollisionPair, CollisionPair::Hash> possibleColliders;
+                CollisionPairBuffer possibleColliders;
                 for (auto&& i : components)
                     ColliderManager::QuarryInRadius(i, 1 + glm::length(i.GetComponent<RigidBody>().velocity) * Physics::deltaT * 2, &possibleColliders);
+                possibleColliders.SortAndRemoveDuplicates();
 
                 inCollisionAtStep.push_back(std::unordered_set<CollisionPair, CollisionPair::Hash>());
                 for (int k = 0; k < Physics::subStepCount; k++)
                 {
                     if (futurePossibleColliders.size() == 0);
 
-                    std::unordered_set<CollisionPair, CollisionPair::Hash> collisions;
+                    CollisionPairBuffer collisions;
                     for (auto&& i : possibleColliders)
-                        if (ColliderManager::AreColliding(*i.a, *i.b))
-                            collisions.insert(i);
+                        if (ColliderManager::AreColliding(components[i.a], components[i.b]))
+                            collisions.Add(i.a, i.b);
 
+                    Physics::LoadBodies();
                     Physics::Substep(Physics::deltaT / Physics::subStepCount, collisions);
+                    Physics::StoreBodies();
 
                     for (auto&& i : collisions)
                     {
@@ -321,6 +351,7 @@ public:
 
             ECS::System<RigidBody>::components = rigidBodyState;
             ECS::System<Transform>::components = transformState;
+            ColliderManager::UpdatePoses();
 
             ImGui::TableNextColumn();
             for (int k = 0; k < components.size(); k++)
@@ -339,7 +370,7 @@ public:
                     ImGui::PushStyleVar(ImGuiStyleVar_CellPadding, ImVec2((cellSize) / 2.0f, (cellSize) / 2.0f));
 
                     ImColor color(0, 255, 0);
-                    CollisionPair pair(&components[i], &components[j]);
+                    CollisionPair pair(i, j);
                     bool previouslyColliding = previouslyInCollision.contains(pair) || previouslyInCollision.contains(pair.Inverse());
                     for (int n = 0; n <= futureStepCount; n++)
                     {
@@ -0,0 +1,1365 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <new>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <functional>
+#include <set>
+#include <algorithm>
+#include "Physics.h"
+#include "PhysicsThread.h"
+#include "Profiler.h"
+using namespace ECS;
+
+/// @brief Liczba alokacji na stercie, zliczana przez podmienione operatory new.
+static std::atomic<size_t> allocationCount = 0;
+
+void* operator new(size_t size)
+{
+    allocationCount++;
+    if (void* pointer = std::malloc(size ? size : 1))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+// GCC po wstawieniu operatora delete w miejsce wywołania zestawia free z niewstawionym operatorem new i błędnie zgłasza niezgodność.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+/// @brief Mierzy średni czas wykonania @p function w milisekundach.
+template <typename TFunction>
+double Measure(int iterations, TFunction&& function)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; i++)
+        function();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+/// @brief Dodaje losowe kule i prostopadłościany do sceny, aż będzie ich @p count .
+/// @details Obiekty są rozłożone w sześcianie o gęstości podobnej do stosu obiektów w pojemniku.
+void FillScene(std::vector<Entity>& bodies, size_t count)
+{
+    double side = cbrt(count) * 2.2;
+    while (bodies.size() < count)
+    {
+        rvec3 position{ rand() / double(RAND_MAX) * side, rand() / double(RAND_MAX) * side, rand() / double(RAND_MAX) * side };
+        rvec3 velocity{ rand() / double(RAND_MAX) * 2 - 1, rand() / double(RAND_MAX) * 2 - 1, rand() / double(RAND_MAX) * 2 - 1 };
+        double scale = rand() / double(RAND_MAX) * 0.3 + 0.5;
+        if (bodies.size() % 2 == 0)
+            bodies.push_back(Entity::AddEntity(Transform(position, { scale,scale,scale }), Collider(scale), RigidBody(velocity, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(2.0 / 5.0 * scale * scale))));
+        else
+            bodies.push_back(Entity::AddEntity(Transform(position, { scale,scale,scale }), Collider({ scale,scale,scale }), RigidBody(velocity, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(1.0 / 12.0 * 8.0 * scale * scale))));
+    }
+}
+
+/// @brief Przesuwa obiekty zgodnie z ich prędkością, symulując jeden krok bez rozwiązywania kolizji.
+void MoveBodies()
+{
+    for (auto&& body : Physics::components)
+        body.GetPosition() += body.velocity * Physics::deltaT;
+}
+
+/// @brief Niszczy obiekty sceny i stan par z poprzednich kroków, żeby nie wpływały na kolejne pomiary.
+/// @details Jednostki są niszczone jawnie od końca, przeniesienie do wektora zwiększa ich licznik referencji,
+/// więc samo usunięcie wektora by ich nie zniszczyło.
+void DestroyScene(std::vector<Entity>& bodies)
+{
+    for (auto entity = bodies.rbegin(); entity != bodies.rend(); entity++)
+        entity->Destroy();
+    bodies.clear();
+    Physics::possibleColliders.Clear();
+    Physics::gjkCaches.clear();
+    Physics::manifolds.clear();
+}
+
+/// @brief Porównuje algorytmy szerokiej fazy wykrywania kolizji.
+void BenchmarkBroadphase(const std::vector<int>& bodyCounts, int scanLimit)
+{
+    std::cout << "broadphase, " << ThreadPool::GetThreadCount() << " threads\n";
+    std::cout << std::setw(10) << "bodies" << std::setw(12) << "pairs" << std::setw(16) << "radius [ms]" << std::setw(16) << "tree [ms]" << std::setw(16) << "grid [ms]" << std::setw(16) << "sap [ms]" << '\n';
+
+    // Obiekty nie są niszczone, usuwanie jednostki jest liniowe względem ich liczby.
+    auto& bodies = *new std::vector<Entity>();
+    for (int count : bodyCounts)
+    {
+        FillScene(bodies, count);
+
+        size_t pairCount = 0;
+        std::vector<double> times;
+        for (auto broadphase : { ColliderManager::Broadphase::Radius, ColliderManager::Broadphase::DynamicTree, ColliderManager::Broadphase::SpatialHash, ColliderManager::Broadphase::SweepAndPrune })
+        {
+            if (broadphase == ColliderManager::Broadphase::Radius && count > scanLimit)
+            {
+                times.push_back(-1);
+                continue;
+            }
+
+            // Pierwsze wywołanie buduje struktury, mierzone są kolejne kroki.
+            CollisionPairBuffer pairs;
+            ColliderManager::broadphase = broadphase;
+            ColliderManager::GetPossibleCollisions(Physics::deltaT, &pairs);
+
+            int iterations = broadphase == ColliderManager::Broadphase::Radius ? 1 : 10;
+            times.push_back(Measure(iterations, [&]() {
+                MoveBodies();
+                ColliderManager::GetPossibleCollisions(Physics::deltaT, &pairs);
+                }));
+            pairCount = pairs.size();
+        }
+
+        std::cout << std::setw(10) << count << std::setw(12) << pairCount << std::fixed << std::setprecision(3);
+        for (double time : times)
+        {
+            if (time < 0)
+                std::cout << std::setw(16) << "-";
+            else
+                std::cout << std::setw(16) << time;
+        }
+        std::cout << '\n';
+    }
+}
+
+/// @brief Porównuje analityczne wyznaczanie kolizji z GJK i EPA na parach leżących na sobie obiektów.
+/// @details Sprawdza też, że GJK i EPA nie alokują pamięci.
+/// @param pairCount liczba par każdego rodzaju
+/// @return fałsz jeżeli wyznaczanie kolizji alokowało pamięć
+bool BenchmarkNarrowphase(int pairCount)
+{
+    std::cout << "narrowphase, " << pairCount << " pairs\n";
+    std::cout << std::setw(12) << "pair" << std::setw(20) << "gjk+epa [us]" << std::setw(20) << "analytic [us]" << std::setw(12) << "speedup" << std::setw(16) << "allocs/call" << '\n';
+
+    bool allocationFree = true;
+
+    // Stos dwóch obiektów lekko przechylonych i zagłębionych w siebie, tak jak w stosie prostopadłościanów.
+    std::vector<Entity> bodies;
+    auto addPair = [&](rvec3 position, bool sphere) {
+        double scale = rand() / double(RAND_MAX) * 0.3 + 0.5;
+        rvec3 axis = glm::normalize(rvec3(rand() / double(RAND_MAX) - 0.5, rand() / double(RAND_MAX) - 0.5, 0.01));
+        rquat tilt = glm::angleAxis(real(rand() / double(RAND_MAX) * 0.1), axis);
+        bodies.push_back(Entity::AddEntity(Transform(position, { scale,scale,scale }), Collider({ scale,scale,scale }), RigidBody({ 0,0,0 }, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(1))));
+
+        position.z += scale * 2 - 0.01;
+        if (sphere)
+            bodies.push_back(Entity::AddEntity(Transform(position, { scale,scale,scale }, tilt), Collider(scale), RigidBody({ 0,0,0 }, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(1))));
+        else
+            bodies.push_back(Entity::AddEntity(Transform(position, { scale,scale,scale }, tilt), Collider({ scale,scale,scale }), RigidBody({ 0,0,0 }, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(1))));
+        };
+
+    for (bool sphere : { false, true })
+    {
+        uint32_t first = ColliderManager::components.size();
+        for (int i = 0; i < pairCount; i++)
+            addPair({ (i % 100) * 4.0, (i / 100) * 4.0, 1000.0 }, sphere);
+        ColliderManager::UpdatePoses();
+
+        std::vector<double> times;
+        times.reserve(2);
+        size_t allocations = allocationCount;
+        for (bool analytic : { false, true })
+        {
+            ColliderManager::analyticContacts = analytic;
+            int contacts = 0;
+            times.push_back(Measure(10, [&]() {
+                for (int i = 0; i < pairCount; i++)
+                {
+                    PenetrationConstraint penetration;
+                    contacts += ColliderManager::GetPenetration(ColliderManager::components[first + i * 2], ColliderManager::components[first + i * 2 + 1], &penetration);
+                }
+                }) * 1000.0 / pairCount);
+        }
+        allocations = allocationCount - allocations;
+
+        std::cout << std::setw(12) << (sphere ? "sphere-box" : "box-box") << std::fixed << std::setprecision(3)
+            << std::setw(20) << times[0] << std::setw(20) << times[1] << std::setw(12) << times[0] / times[1]
+            << std::setw(16) << allocations / (20.0 * pairCount) << '\n';
+        allocationFree = allocationFree && allocations == 0;
+    }
+    DestroyScene(bodies);
+    ColliderManager::analyticContacts = true;
+
+    if (!allocationFree)
+        std::cout << "narrowphase allocated memory\n";
+    return allocationFree;
+}
+
+/// @brief Porównuje GJK rozpoczynane od zera z GJK korzystającym z wyniku poprzedniego wywołania dla tej samej pary.
+/// @details Pary prostopadłościanów poruszają się powoli, a GJK wywoływane jest dla każdej pary w każdym pod kroku, tak jak w Physics::Update.
+/// @param pairCount liczba par
+void BenchmarkGJK(int pairCount)
+{
+    std::cout << "gjk, " << pairCount << " pairs, " << Physics::subStepCount << " substeps\n";
+    std::cout << std::setw(12) << "mode" << std::setw(16) << "time [us]" << std::setw(16) << "supports" << std::setw(16) << "cache hits" << std::setw(12) << "colliding" << '\n';
+
+    std::vector<Entity> bodies;
+    uint32_t first = ColliderManager::components.size();
+    for (int i = 0; i < pairCount; i++)
+    {
+        rvec3 position{ (i % 100) * 6.0, (i / 100) * 6.0, -1000.0 };
+        rvec3 offset{ rand() / double(RAND_MAX) * 2 - 1, rand() / double(RAND_MAX) * 2 - 1, rand() / double(RAND_MAX) * 2 - 1 };
+        rvec3 velocity{ rand() / double(RAND_MAX) * 2 - 1, rand() / double(RAND_MAX) * 2 - 1, rand() / double(RAND_MAX) * 2 - 1 };
+        rvec3 axis = glm::normalize(rvec3(rand() / double(RAND_MAX) - 0.5, rand() / double(RAND_MAX) - 0.5, rand() / double(RAND_MAX) - 0.5));
+        rquat rotation = glm::angleAxis(real(rand() / double(RAND_MAX) * 3.0), axis);
+        bodies.push_back(Entity::AddEntity(Transform(position, { 1,1,1 }), Collider({ 0.5,0.5,0.5 }), RigidBody({ 0,0,0 }, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(1))));
+        bodies.push_back(Entity::AddEntity(Transform(position + offset * real(1.2), { 1,1,1 }, rotation), Collider({ 0.5,0.5,0.5 }), RigidBody(velocity, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(1))));
+    }
+
+    int frames = 10;
+    real subDeltaT = Physics::deltaT / Physics::subStepCount;
+    std::vector<rvec3> startPositions(pairCount);
+    for (int i = 0; i < pairCount; i++)
+        startPositions[i] = ColliderManager::components[first + i * 2 + 1].GetComponent<Transform>().position;
+
+    for (bool cached : { false, true })
+    {
+        for (int i = 0; i < pairCount; i++)
+            ColliderManager::components[first + i * 2 + 1].GetComponent<Transform>().position = startPositions[i];
+        ColliderManager::UpdatePoses();
+
+        std::vector<GJKCache> caches(pairCount);
+        ColliderManager::gjkStatistics.Reset();
+        size_t colliding = 0;
+        double time = Measure(frames * Physics::subStepCount, [&]() {
+            for (int i = 0; i < pairCount; i++)
+            {
+                Collider& moving = ColliderManager::components[first + i * 2 + 1];
+                moving.GetComponent<Transform>().position += moving.GetComponent<RigidBody>().velocity * subDeltaT;
+                ColliderManager::UpdatePose(moving);
+
+                Support simplex[4];
+                colliding += ColliderManager::GJK(ColliderManager::components[first + i * 2], moving, simplex, cached ? &caches[i] : nullptr);
+            }
+            }) * 1000.0 / pairCount;
+
+        auto& statistics = ColliderManager::gjkStatistics;
+        std::cout << std::setw(12) << (cached ? "cached" : "cold") << std::fixed << std::setprecision(3) << std::setw(16) << time
+            << std::setw(16) << statistics.supportEvaluations / double(statistics.calls)
+            << std::setw(16) << statistics.cacheHits / double(statistics.calls)
+            << std::setw(12) << colliding / double(statistics.calls) << '\n';
+    }
+    DestroyScene(bodies);
+}
+
+/// @brief Mierzy krok fizyki i samą fazę wąską na stosie obiektów leżących w pojemniku dla różnej liczby wątków.
+/// @details Każdy pomiar zaczyna od tego samego stanu, a pozycje po pomiarze muszą być identyczne dla każdej liczby wątków.
+/// @param bodyCount liczba obiektów
+/// @param threadCounts liczby wątków
+/// @return fałsz jeżeli wynik zależał od liczby wątków
+bool BenchmarkSolver(int bodyCount, const std::vector<int>& threadCounts)
+{
+    std::cout << "solver, " << bodyCount << " bodies, " << Physics::subStepCount << " substeps\n";
+    // Usypianie pomijałoby część pracy zależnie od liczby kroków, mierzony jest pełny krok.
+    Physics::allowSleeping = false;
+
+    std::vector<Entity> bodies;
+    auto infinity = std::numeric_limits<double>::infinity();
+    int side = (int)ceil(sqrt(bodyCount / 10.0));
+    // Podłoga jest dużo szersza od stosu, żeby rozsypujące się obiekty z niej nie spadały.
+    double half = side * 1.7;
+    rvec3 origin{ 0, 0, 2000.0 };
+    bodies.push_back(Entity::AddEntity(Transform(origin - rvec3(0, 0, 0.5), { half,half,0.5 }), Collider({ half + 1,half + 1,0.5 }), RigidBody({ 0,0,0 }, { 0,0,0 }, { 0,0,0 }, infinity, rmat3(infinity), 0.2)));
+    for (int i = 0; i < bodyCount; i++)
+    {
+        rvec3 position = origin + rvec3(((i % side) - side / 2) * 1.7, ((i / side % side) - side / 2) * 1.7, 1 + (i / (side * side)) * 1.7);
+        double scale = rand() / double(RAND_MAX) * 0.3 + 0.5;
+        if (i % 2 == 0)
+            bodies.push_back(Entity::AddEntity(Transform(position, { scale,scale,scale }), Collider(scale), RigidBody({ 0,0,0 }, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(2.0 / 5.0 * scale * scale), 0.2)));
+        else
+            bodies.push_back(Entity::AddEntity(Transform(position, { scale,scale,scale }), Collider({ scale,scale,scale }), RigidBody({ 0,0,0 }, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(1.0 / 12.0 * 8.0 * scale * scale), 0.2)));
+    }
+
+    // Obiekty spadają na siebie, zanim zacznie się pomiar.
+    ColliderManager::broadphase = ColliderManager::Broadphase::SpatialHash;
+    for (int i = 0; i < 250; i++)
+        Physics::Update();
+
+    std::vector<Transform> transforms(Physics::components.size());
+    std::vector<RigidBody> states(Physics::components.size());
+    for (size_t i = 0; i < Physics::components.size(); i++)
+    {
+        transforms[i] = Physics::components[i].GetComponent<Transform>();
+        states[i] = Physics::components[i];
+    }
+
+    std::cout << std::setw(10) << "threads" << std::setw(16) << "step [ms]" << std::setw(12) << "speedup" << std::setw(20) << "narrowphase [ms]" << std::setw(12) << "speedup"
+        << std::setw(12) << "colors" << std::setw(12) << "contacts" << '\n';
+    bool deterministic = true;
+    std::vector<rvec3> firstPositions;
+    double firstTime = 0;
+    double firstNarrowphaseTime = 0;
+    for (int threadCount : threadCounts)
+    {
+        ThreadPool::Init(threadCount);
+        for (size_t i = 0; i < Physics::components.size(); i++)
+        {
+            Physics::components[i].GetComponent<Transform>() = transforms[i];
+            Physics::components[i] = states[i];
+        }
+        Physics::possibleColliders.Clear();
+        Physics::gjkCaches.clear();
+        Physics::manifolds.clear();
+
+        double time = Measure(20, []() { Physics::Update(); });
+
+        std::vector<rvec3> positions;
+        for (auto&& body : Physics::components)
+            positions.push_back(body.GetPosition());
+
+        // Faza wąska jednego pod kroku na końcowych pozycjach, bez rozwiązywania ograniczników.
+        real subDeltaT = Physics::deltaT / Physics::subStepCount;
+        double narrowphaseTime = Measure(20, [&]() { Physics::Narrowphase(subDeltaT, Physics::possibleColliders, Physics::gjkCaches.data(), Physics::manifolds.data()); });
+
+        if (firstPositions.empty())
+        {
+            firstPositions = positions;
+            firstTime = time;
+            firstNarrowphaseTime = narrowphaseTime;
+        }
+        deterministic = deterministic && positions == firstPositions;
+
+        size_t contacts = 0;
+        for (auto&& manifold : Physics::manifolds)
+            contacts += manifold.pointCount;
+        std::cout << std::setw(10) << threadCount << std::fixed << std::setprecision(3) << std::setw(16) << time << std::setw(12) << firstTime / time
+            << std::setw(20) << narrowphaseTime << std::setw(12) << firstNarrowphaseTime / narrowphaseTime << std::setw(12) << Physics::GetColoring().GetColorCount() << std::setw(12) << contacts << '\n';
+    }
+
+    DestroyScene(bodies);
+    if (!deterministic)
+        std::cout << "solver result depends on thread count\n";
+    return deterministic;
+}
+
+/// @brief Dodaje szerokie pole dwuelementowych stosów (prostopadłościan z kulą lub prostopadłościanem na wierzchu) na podłodze w @p origin .
+/// @details Ten solwer potrafi takie stosy ustabilizować, każdy stos tworzy osobną wyspę.
+void AddStackField(std::vector<Entity>& bodies, int bodyCount, rvec3 origin)
+{
+    auto infinity = std::numeric_limits<real>::infinity();
+    int stackCount = (bodyCount + 1) / 2;
+    int side = (int)ceil(sqrt(stackCount));
+    real half = side * 0.85 + 1;
+    bodies.push_back(Entity::AddEntity(Transform(origin - rvec3(0, 0, 0.5), { half,half,0.5 }), Collider({ half,half,0.5 }), RigidBody({ 0,0,0 }, { 0,0,0 }, { 0,0,0 }, infinity, rmat3(infinity), 0.2)));
+    for (int i = 0; i < stackCount; i++)
+    {
+        real scale = rand() / double(RAND_MAX) * 0.3 + 0.5;
+        rvec3 position = origin + rvec3(((i % side) - side / 2) * 1.7, ((i / side) - side / 2) * 1.7, scale);
+        bodies.push_back(Entity::AddEntity(Transform(position, { scale,scale,scale }), Collider({ scale,scale,scale }), RigidBody({ 0,0,0 }, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(1.0 / 12.0 * 8.0 * scale * scale), 0.2)));
+        if (2 * i + 1 >= bodyCount)
+            break;
+
+        real topScale = rand() / double(RAND_MAX) * 0.2 + 0.3;
+        position.z += scale + topScale + real(0.001);
+        if (i % 2 == 0)
+            bodies.push_back(Entity::AddEntity(Transform(position, { topScale,topScale,topScale }), Collider(topScale), RigidBody({ 0,0,0 }, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(2.0 / 5.0 * topScale * topScale), 0.2)));
+        else
+            bodies.push_back(Entity::AddEntity(Transform(position, { topScale,topScale,topScale }), Collider({ topScale,topScale,topScale }), RigidBody({ 0,0,0 }, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(1.0 / 12.0 * 8.0 * topScale * topScale), 0.2)));
+    }
+}
+
+/// @brief Porównuje czas kroku bez usypiania i po uśpieniu wszystkich spoczywających wysp.
+/// @details Scena to pole stosów z AddStackField, niszczone na końcu przez DestroyScene.
+void BenchmarkSleeping(int bodyCount, int maxFrames)
+{
+    std::cout << "sleeping, " << bodyCount << " bodies, " << Physics::subStepCount << " substeps\n";
+
+    std::vector<Entity> bodies;
+    AddStackField(bodies, bodyCount, { 0, 0, -2000.0 });
+
+    auto sleepingFraction = []()
+    {
+        size_t dynamic = 0;
+        size_t sleeping = 0;
+        for (auto&& body : Physics::components)
+        {
+            if (body.inverseMass == 0)
+                continue;
+            dynamic++;
+            sleeping += body.sleeping;
+        }
+        return dynamic == 0 ? 0.0 : sleeping / double(dynamic);
+    };
+
+    ColliderManager::broadphase = ColliderManager::Broadphase::SpatialHash;
+    Physics::allowSleeping = false;
+    for (int i = 0; i < 50; i++)
+        Physics::Update();
+    double awakeTime = Measure(20, []() { Physics::Update(); });
+
+    Physics::allowSleeping = true;
+    int frames = 0;
+    while (frames < maxFrames && sleepingFraction() < 1.0)
+    {
+        Physics::Update();
+        frames++;
+    }
+    double fraction = sleepingFraction();
+    double sleepingTime = Measure(20, []() { Physics::Update(); });
+
+    std::cout << frames << " frames to settle, " << std::fixed << std::setprecision(1) << fraction * 100 << "% bodies asleep, " << Physics::GetIslands().GetIslandCount() << " islands\n";
+    std::cout << std::setw(16) << "awake [ms]" << std::setw(16) << "asleep [ms]" << std::setw(12) << "speedup" << '\n';
+    std::cout << std::setprecision(3) << std::setw(16) << awakeTime << std::setw(16) << sleepingTime << std::setw(12) << awakeTime / sleepingTime << '\n';
+
+    DestroyScene(bodies);
+}
+
+/// @brief Mierzy czas kroku i dokładność spoczynku tego samego pola stosów w różnej odległości od początku układu.
+/// @details Uruchomiony w wersji double i float (BenchmarkFloat) pozwala porównać obie precyzje na tych samych scenach.
+/// Dokładność to największa głębokość penetracji, średnia prędkość i średnie przesunięcie obiektów, które powinny spoczywać.
+/// @param bodyCount liczba obiektów
+/// @param distances odległości sceny od początku układu
+void BenchmarkPrecision(int bodyCount, const std::vector<double>& distances)
+{
+    std::cout << "precision, " << (sizeof(real) == sizeof(float) ? "float" : "double") << ", " << bodyCount << " bodies, " << Physics::subStepCount << " substeps\n";
+    std::cout << std::setw(12) << "distance" << std::setw(16) << "step [ms]" << std::setw(16) << "max depth" << std::setw(16) << "mean speed" << std::setw(16) << "mean drift" << '\n';
+
+    // Usypianie zatrzymałoby obiekty i ukryło błędy spoczynku.
+    Physics::allowSleeping = false;
+    ColliderManager::broadphase = ColliderManager::Broadphase::SpatialHash;
+    for (double distance : distances)
+    {
+        std::vector<Entity> bodies;
+        srand(1);
+        AddStackField(bodies, bodyCount, { distance, distance, distance });
+        for (int i = 0; i < 100; i++)
+            Physics::Update();
+
+        std::vector<rvec3> startPositions;
+        for (auto&& body : Physics::components)
+            startPositions.push_back(body.GetPosition());
+
+        int frames = 50;
+        double time = Measure(frames, []() { Physics::Update(); });
+
+        double maxDepth = 0;
+        for (auto&& manifold : Physics::manifolds)
+            for (int i = 0; i < manifold.pointCount; i++)
+                maxDepth = std::max(maxDepth, (double)manifold.points[i].depth);
+
+        size_t dynamic = 0;
+        double speed = 0;
+        double drift = 0;
+        for (size_t i = 0; i < Physics::components.size(); i++)
+        {
+            auto&& body = Physics::components[i];
+            if (body.inverseMass == 0)
+                continue;
+            dynamic++;
+            speed += glm::length(body.velocity);
+            drift += glm::length(body.GetPosition() - startPositions[i]);
+        }
+
+        std::cout << std::setw(12) << std::setprecision(0) << std::fixed << distance << std::setprecision(3) << std::setw(16) << time
+            << std::scientific << std::setprecision(2) << std::setw(16) << maxDepth << std::setw(16) << speed / dynamic << std::setw(16) << drift / dynamic << std::fixed << '\n';
+
+        DestroyScene(bodies);
+    }
+}
+
+/// @brief Porównuje GJK dla pojedynczych par z GJKBatch na deszczu prostopadłościanów spadających na podłogę.
+/// @details Pary to pary z szerokiej fazy, które GetContacts sprawdzałoby przez GJK. Para rozdzielona według GJKBatch
+/// nie może być w kolizji według GJK. Mierzona jest też faza wąska bez zapamiętanych wyników GJK i cały krok, bez i z odrzucaniem par przez GJKBatch.
+/// @param bodyCount liczba prostopadłościanów
+/// @return fałsz jeżeli GJKBatch uznał za rozdzieloną parę w kolizji
+bool BenchmarkBoxRain(int bodyCount)
+{
+    std::cout << "box rain, " << bodyCount << " bodies, " << SimdReal::width << " pairs per batch\n";
+
+    std::vector<Entity> bodies;
+    auto infinity = std::numeric_limits<real>::infinity();
+    real half = sqrt(bodyCount / 4.0) + 2;
+    rvec3 origin{ 0, 0, 3000.0 };
+    bodies.push_back(Entity::AddEntity(Transform(origin - rvec3(0, 0, 0.5), { half,half,0.5 }), Collider({ half,half,0.5 }), RigidBody({ 0,0,0 }, { 0,0,0 }, { 0,0,0 }, infinity, rmat3(infinity), 0.2)));
+    for (int i = 0; i < bodyCount; i++)
+    {
+        rvec3 position = origin + rvec3((rand() / double(RAND_MAX) * 2 - 1) * (half - 1), (rand() / double(RAND_MAX) * 2 - 1) * (half - 1), 1 + rand() / double(RAND_MAX) * 20);
+        rvec3 axis = glm::normalize(rvec3(rand() / double(RAND_MAX) - 0.5, rand() / double(RAND_MAX) - 0.5, rand() / double(RAND_MAX) - 0.5));
+        rquat rotation = glm::angleAxis(real(rand() / double(RAND_MAX) * 3.0), axis);
+        real scale = rand() / double(RAND_MAX) * 0.3 + 0.3;
+        bodies.push_back(Entity::AddEntity(Transform(position, { scale,scale,scale }, rotation), Collider({ scale,scale,scale }), RigidBody({ 0,0,-5 }, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(1.0 / 12.0 * 8.0 * scale * scale), 0.2)));
+    }
+
+    // Część prostopadłościanów leży już na podłodze, reszta spada. GJKBatch jest używany tylko bez testów analitycznych.
+    Physics::allowSleeping = false;
+    ColliderManager::analyticContacts = false;
+    ColliderManager::broadphase = ColliderManager::Broadphase::SpatialHash;
+    for (int i = 0; i < 30; i++)
+        Physics::Update();
+
+    std::vector<CollisionPair> pairs;
+    for (size_t j = 0; j < Physics::possibleColliders.size(); j++)
+    {
+        const CollisionPair& pair = Physics::possibleColliders[j];
+        if (ColliderManager::ClassifyPair(ColliderManager::components[pair.a], ColliderManager::components[pair.b], nullptr) == ColliderManager::ContactTest::Batch)
+            pairs.push_back(pair);
+    }
+
+    std::vector<char> colliding(pairs.size());
+    double scalarTime = Measure(20, [&]() {
+        for (size_t j = 0; j < pairs.size(); j++)
+        {
+            Support simplex[4];
+            colliding[j] = ColliderManager::GJK(ColliderManager::components[pairs[j].a], ColliderManager::components[pairs[j].b], simplex);
+        }
+        }) * 1000.0 / pairs.size();
+
+    std::vector<char> separated(pairs.size());
+    double batchedTime = Measure(20, [&]() {
+        for (size_t j = 0; j < pairs.size(); j += SimdReal::width)
+        {
+            uint32_t count = std::min<size_t>(SimdReal::width, pairs.size() - j);
+            uint32_t bits = ColliderManager::GJKBatch(&pairs[j], count);
+            for (uint32_t k = 0; k < count; k++)
+                separated[j + k] = bits >> k & 1;
+        }
+        }) * 1000.0 / pairs.size();
+
+    size_t separatedCount = 0;
+    size_t mismatches = 0;
+    for (size_t j = 0; j < pairs.size(); j++)
+    {
+        separatedCount += separated[j];
+        mismatches += separated[j] && colliding[j];
+    }
+
+    std::cout << pairs.size() << " pairs, " << std::fixed << std::setprecision(1) << separatedCount * 100.0 / pairs.size() << "% separated\n";
+    std::cout << std::setw(12) << "gjk" << std::setw(20) << "scalar [us]" << std::setw(20) << "batched [us]" << std::setw(12) << "speedup" << std::setw(12) << "mismatches" << '\n';
+    std::cout << std::setw(12) << "" << std::setprecision(3) << std::setw(20) << scalarTime << std::setw(20) << batchedTime << std::setw(12) << scalarTime / batchedTime << std::setw(12) << mismatches << '\n';
+
+    std::cout << std::setw(12) << "gjk+epa" << std::setw(20) << "scalar [ms]" << std::setw(20) << "batched [ms]" << std::setw(12) << "speedup" << '\n';
+
+    // Faza wąska jednego pod kroku bez zapamiętanych wyników GJK, tak jak dla par, które właśnie pojawiły się w szerokiej fazie.
+    real subDeltaT = Physics::deltaT / Physics::subStepCount;
+    double narrowphaseTimes[2];
+    for (bool batched : { false, true })
+    {
+        ColliderManager::batchedGJK = batched;
+        narrowphaseTimes[batched] = Measure(20, [&]() { Physics::Narrowphase(subDeltaT, Physics::possibleColliders); });
+    }
+    std::cout << std::setw(12) << "narrowphase" << std::setw(20) << narrowphaseTimes[0] << std::setw(20) << narrowphaseTimes[1] << std::setw(12) << narrowphaseTimes[0] / narrowphaseTimes[1] << '\n';
+
+    // Kroki zaczynają od tego samego stanu, a różnica jest mała w porównaniu z całym krokiem, więc brany jest najkrótszy z kilku pomiarów.
+    std::vector<Transform> transforms(Physics::components.size());
+    std::vector<RigidBody> states(Physics::components.size());
+    for (size_t i = 0; i < Physics::components.size(); i++)
+    {
+        transforms[i] = Physics::components[i].GetComponent<Transform>();
+        states[i] = Physics::components[i];
+    }
+
+    double stepTimes[2] = { std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity() };
+    for (int repeat = 0; repeat < 5; repeat++)
+    {
+        for (bool batched : { false, true })
+        {
+            for (size_t i = 0; i < Physics::components.size(); i++)
+            {
+                Physics::components[i].GetComponent<Transform>() = transforms[i];
+                Physics::components[i] = states[i];
+            }
+            Physics::possibleColliders.Clear();
+            Physics::gjkCaches.clear();
+            Physics::manifolds.clear();
+
+            ColliderManager::batchedGJK = batched;
+            stepTimes[batched] = std::min(stepTimes[batched], Measure(30, []() { Physics::Update(); }));
+        }
+    }
+    std::cout << std::setw(12) << "step" << std::setw(20) << stepTimes[0] << std::setw(20) << stepTimes[1] << std::setw(12) << stepTimes[0] / stepTimes[1] << '\n';
+    ColliderManager::analyticContacts = true;
+    ColliderManager::batchedGJK = true;
+
+    DestroyScene(bodies);
+    if (mismatches != 0)
+        std::cout << "batched gjk separated colliding pairs\n";
+    return mismatches == 0;
+}
+
+/// @brief Liczy pociski, które przeleciały przez cienką ścianę, bez CCD i kontaktów spekulatywnych, z samymi kontaktami spekulatywnymi i z CCD, dla kilku prędkości.
+/// @details Kule i obrócone prostopadłościany lecą prostopadle do statycznej ściany o grubości 0.5, krok ma domyślne deltaT i liczbę pod kroków.
+/// Mierzony jest też średni czas kroku w trakcie lotu.
+/// @param projectileCount liczba pocisków
+/// @return fałsz jeżeli z CCD jakiś pocisk przeleciał przez ścianę
+bool BenchmarkTunneling(int projectileCount)
+{
+    std::cout << "tunneling, " << projectileCount << " projectiles, wall 0.5 thick, " << Physics::subStepCount << " substeps\n";
+    std::cout << std::setw(12) << "speed" << std::setw(16) << "none" << std::setw(16) << "speculative" << std::setw(16) << "ccd" << std::setw(16) << "step [ms]" << std::setw(16) << "ccd step [ms]" << '\n';
+
+    auto infinity = std::numeric_limits<real>::infinity();
+    int side = (int)ceil(sqrt(projectileCount));
+    real half = side * 0.75 + 5;
+    bool passed = true;
+    Physics::allowSleeping = false;
+    ColliderManager::broadphase = ColliderManager::Broadphase::SpatialHash;
+    for (real speed : { 50.0, 150.0, 500.0 })
+    {
+        // Tryby: bez obu metod, same kontakty spekulatywne, CCD z kontaktami spekulatywnymi.
+        size_t tunneled[3];
+        double times[3];
+        for (int mode = 0; mode < 3; mode++)
+        {
+            std::vector<Entity> bodies;
+            srand(1);
+            bodies.push_back(Entity::AddEntity(Transform({ 0, 0, 0 }, { 0.25, half, half }), Collider({ 0.25, half, half }), RigidBody({ 0,0,0 }, { 0,0,0 }, { 0,0,0 }, infinity, rmat3(infinity), 0.2)));
+            for (int i = 0; i < projectileCount; i++)
+            {
+                real scale = rand() / double(RAND_MAX) * 0.2 + 0.2;
+                rvec3 position = { -10, ((i % side) - side / 2) * 1.5, ((i / side) - side / 2) * 1.5 };
+                rvec3 angularVelocity = { rand() / double(RAND_MAX) * 20 - 10, rand() / double(RAND_MAX) * 20 - 10, rand() / double(RAND_MAX) * 20 - 10 };
+                if (i % 2 == 0)
+                    bodies.push_back(Entity::AddEntity(Transform(position, { scale,scale,scale }), Collider(scale), RigidBody({ speed, 0, 0 }, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(2.0 / 5.0 * scale * scale), 0.2)));
+                else
+                    bodies.push_back(Entity::AddEntity(Transform(position, { scale,scale,scale }, glm::angleAxis(real(i), glm::normalize(rvec3(1, 2, 3)))), Collider({ scale,scale,scale }),
+                        RigidBody({ speed, 0, 0 }, angularVelocity, { 0,0,0 }, 1.0, rmat3(1.0 / 12.0 * 8.0 * scale * scale), 0.2)));
+            }
+
+            Physics::continuousCollisions = mode == 2;
+            Physics::speculativeContacts = mode != 0;
+            int frames = (int)ceil(20 / (speed * Physics::deltaT)) + 2;
+            times[mode] = Measure(frames, []() { Physics::Update(); });
+
+            tunneled[mode] = 0;
+            for (auto&& body : Physics::components)
+                tunneled[mode] += body.inverseMass != 0 && body.GetPosition().x > 0;
+
+            DestroyScene(bodies);
+        }
+
+        passed = passed && tunneled[2] == 0;
+        std::cout << std::setw(12) << std::setprecision(0) << std::fixed << speed << std::setw(16) << tunneled[0] << std::setw(16) << tunneled[1] << std::setw(16) << tunneled[2]
+            << std::setprecision(3) << std::setw(16) << times[0] << std::setw(16) << times[2] << '\n';
+    }
+
+    Physics::continuousCollisions = true;
+    Physics::speculativeContacts = true;
+    return passed;
+}
+
+/// @brief Porównuje liczbę par i kontaktów na klatkę przy kulach szerokiej fazy powiększanych proporcjonalnie do rozmiaru obiektu
+/// i przy kontaktach spekulatywnych z kulami powiększanymi tylko o drogę w kroku.
+/// @details Scena to kule i prostopadłościany różnej wielkości rzucane z dużą prędkością na podłogę, oba pomiary zaczynają od tego samego stanu.
+/// Liczone są pary z szerokiej fazy, ograniczniki z ostatniego pod kroku i obiekty, które przeleciały przez podłogę.
+/// @param bodyCount liczba obiektów
+void BenchmarkSpeculative(int bodyCount, int frames)
+{
+    std::cout << "speculative contacts, " << bodyCount << " bodies, " << frames << " frames, " << Physics::subStepCount << " substeps\n";
+    std::cout << std::setw(12) << "mode" << std::setw(16) << "pairs/frame" << std::setw(16) << "contacts" << std::setw(16) << "speculative" << std::setw(16) << "step [ms]" << std::setw(12) << "tunneled" << '\n';
+
+    auto infinity = std::numeric_limits<real>::infinity();
+    real side = sqrt(bodyCount) * 3;
+    Physics::allowSleeping = false;
+    ColliderManager::broadphase = ColliderManager::Broadphase::SpatialHash;
+    for (bool speculative : { false, true })
+    {
+        std::vector<Entity> bodies;
+        srand(1);
+        bodies.push_back(Entity::AddEntity(Transform({ 0, 0, -0.25 }, { side, side, 0.25 }), Collider({ side, side, 0.25 }), RigidBody({ 0,0,0 }, { 0,0,0 }, { 0,0,0 }, infinity, rmat3(infinity), 0.2)));
+        for (int i = 0; i < bodyCount; i++)
+        {
+            real scale = rand() / double(RAND_MAX) * 2 + 0.5;
+            rvec3 position = { (rand() / double(RAND_MAX) * 2 - 1) * side * 0.8, (rand() / double(RAND_MAX) * 2 - 1) * side * 0.8, rand() / double(RAND_MAX) * 20 + 3 };
+            rvec3 velocity = { rand() / double(RAND_MAX) * 30 - 15, rand() / double(RAND_MAX) * 30 - 15, -rand() / double(RAND_MAX) * 30 };
+            if (i % 2 == 0)
+                bodies.push_back(Entity::AddEntity(Transform(position, { scale,scale,scale }), Collider(scale), RigidBody(velocity, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(2.0 / 5.0 * scale * scale), 0.2)));
+            else
+                bodies.push_back(Entity::AddEntity(Transform(position, { scale,scale,scale }), Collider({ scale,scale,scale }), RigidBody(velocity, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(1.0 / 12.0 * 8.0 * scale * scale), 0.2)));
+        }
+
+        Physics::speculativeContacts = speculative;
+        size_t pairs = 0;
+        size_t contacts = 0;
+        size_t speculativeCount = 0;
+        double time = Measure(frames, [&]() {
+            Physics::Update();
+            pairs += Physics::possibleColliders.size();
+            for (auto&& penetration : Physics::GetPenetrations())
+            {
+                contacts += !penetration.speculative;
+                speculativeCount += penetration.speculative;
+            }
+            });
+
+        size_t tunneled = 0;
+        for (auto&& body : Physics::components)
+            tunneled += body.inverseMass != 0 && body.GetPosition().z < 0;
+
+        std::cout << std::setw(12) << (speculative ? "speculative" : "inflated") << std::fixed << std::setprecision(1) << std::setw(16) << pairs / double(frames)
+            << std::setw(16) << contacts / double(frames) << std::setw(16) << speculativeCount / double(frames) << std::setprecision(3) << std::setw(16) << time << std::setw(12) << tunneled << '\n';
+
+        DestroyScene(bodies);
+    }
+
+    Physics::speculativeContacts = true;
+}
+
+/// @brief Porównuje stałą liczbę pod kroków z adaptacyjną na scenie, która najpierw spoczywa, a potem jest zasypywana szybkimi pociskami.
+/// @details Scena to pole stosów z AddStackField, po ustabilizowaniu nad nim pojawiają się pociski lecące w dół z prędkością 40 m/s.
+/// Dla obu faz liczona jest średnia liczba pod kroków z Physics::GetStepStats i czas kroku, dla fazy z pociskami także największa
+/// głębokość penetracji i liczba obiektów, które przeleciały przez podłogę.
+/// @param bodyCount liczba obiektów w stosach
+/// @param projectileCount liczba pocisków
+void BenchmarkAdaptive(int bodyCount, int projectileCount)
+{
+    const int frames = 30;
+    std::cout << "adaptive substeps, " << bodyCount << " bodies, " << projectileCount << " projectiles, " << frames << " frames per phase\n";
+    std::cout << std::setw(12) << "substeps" << std::setw(14) << "calm count" << std::setw(14) << "calm [ms]" << std::setw(14) << "impact count"
+        << std::setw(14) << "impact [ms]" << std::setw(14) << "max depth" << std::setw(12) << "tunneled" << '\n';
+
+    rvec3 origin = { 0, 0, -3000.0 };
+    Physics::allowSleeping = false;
+    ColliderManager::broadphase = ColliderManager::Broadphase::SpatialHash;
+    for (int fixedCount : { 4, 16, 0 })
+    {
+        std::vector<Entity> bodies;
+        srand(1);
+        AddStackField(bodies, bodyCount, origin);
+        Physics::adaptiveSubSteps = fixedCount == 0;
+        Physics::subStepCount = fixedCount == 0 ? 4 : fixedCount;
+        for (int i = 0; i < frames; i++)
+            Physics::Update();
+
+        int calmCount = 0;
+        double calmTime = Measure(frames, [&]() {
+            Physics::Update();
+            calmCount += Physics::GetStepStats().subStepCount;
+            });
+
+        // Pociski na siatce nad polem stosów, żeby nie przenikały się od początku.
+        real half = ceil(sqrt((bodyCount + 1) / 2)) * 0.85;
+        int side = (int)ceil(sqrt(projectileCount));
+        for (int i = 0; i < projectileCount; i++)
+        {
+            real scale = rand() / double(RAND_MAX) * 0.2 + 0.2;
+            rvec3 position = origin + rvec3(((i % side) / real(side) * 2 - 1) * half, ((i / side) / real(side) * 2 - 1) * half, rand() / double(RAND_MAX) * 5 + 5);
+            if (i % 2 == 0)
+                bodies.push_back(Entity::AddEntity(Transform(position, { scale,scale,scale }), Collider(scale), RigidBody({ 0, 0, -40 }, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(2.0 / 5.0 * scale * scale), 0.2)));
+            else
+                bodies.push_back(Entity::AddEntity(Transform(position, { scale,scale,scale }), Collider({ scale,scale,scale }), RigidBody({ 0, 0, -40 }, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(1.0 / 12.0 * 8.0 * scale * scale), 0.2)));
+        }
+
+        int impactCount = 0;
+        real maxDepth = 0;
+        double impactTime = Measure(frames, [&]() {
+            Physics::Update();
+            impactCount += Physics::GetStepStats().subStepCount;
+            maxDepth = std::max(maxDepth, Physics::GetStepStats().maxDepth);
+            });
+
+        size_t tunneled = 0;
+        for (auto&& body : Physics::components)
+            tunneled += body.inverseMass != 0 && body.GetPosition().z < origin.z - 1;
+
+        std::cout << std::setw(12) << (fixedCount == 0 ? std::string("adaptive") : std::to_string(fixedCount)) << std::fixed << std::setprecision(2)
+            << std::setw(14) << calmCount / double(frames) << std::setprecision(3) << std::setw(14) << calmTime << std::setprecision(2) << std::setw(14) << impactCount / double(frames)
+            << std::setprecision(3) << std::setw(14) << impactTime << std::setprecision(4) << std::setw(14) << maxDepth << std::setw(12) << tunneled << '\n';
+
+        DestroyScene(bodies);
+    }
+
+    Physics::adaptiveSubSteps = false;
+    Physics::subStepCount = 4;
+}
+
+/// @brief Sprawdza Physics::Advance przy losowym czasie klatki z jednym długim zacięciem.
+/// @details Obiekt porusza się ze stałą prędkością bez grawitacji, więc jego położenie w chwili rysowania, opóźnionej o jeden krok
+/// względem czasu rzeczywistego pomniejszonego o czas odrzucony, jest znane. Porównywany jest błąd tego położenia dla transformacji
+/// interpolowanej przez Physics::GetInterpolatedTransform i stanu z ostatniego kroku.
+/// @return fałsz jeżeli któraś klatka wykonała więcej niż Physics::maxTicksPerFrame kroków, interpolacja nie jest dokładniejsza od stanu
+/// z ostatniego kroku, albo czas symulacji nie zgadza się z czasem rzeczywistym
+bool BenchmarkFixedStep(int frames)
+{
+    std::cout << "fixed step, " << frames << " frames of 4-40 ms, one 500 ms stall, deltaT " << Physics::deltaT * 1000 << " ms, at most " << Physics::maxTicksPerFrame << " ticks per frame\n";
+
+    const real speed = 10;
+    rvec3 gravity = Physics::gravity;
+    Physics::gravity = { 0, 0, 0 };
+    std::vector<Entity> bodies;
+    srand(1);
+    bodies.push_back(Entity::AddEntity(Transform({ 0, 0, 4000 }, { 0.5, 0.5, 0.5 }), Collider(0.5), RigidBody({ speed, 0, 0 }, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(0.1), 0.2)));
+    Transform& transform = bodies[0].GetComponent<Transform>();
+
+    real realTime = 0;
+    int ticks = 0;
+    int maxTicks = 0;
+    real interpolatedError = 0;
+    real rawError = 0;
+    real droppedBefore = Physics::GetDroppedTime();
+    for (int i = 0; i < frames; i++)
+    {
+        real frameTime = i == frames / 2 ? 0.5 : (rand() / double(RAND_MAX) * 36 + 4) / 1000;
+        realTime += frameTime;
+        int frameTicks = Physics::Advance(frameTime);
+        ticks += frameTicks;
+        maxTicks = std::max(maxTicks, frameTicks);
+        if (ticks < 2)
+            continue;
+
+        real expected = speed * (realTime - (Physics::GetDroppedTime() - droppedBefore) - Physics::deltaT);
+        interpolatedError = std::max(interpolatedError, std::abs(Physics::GetInterpolatedTransform(transform).position.x - expected));
+        rawError = std::max(rawError, std::abs(transform.position.x - expected));
+    }
+
+    real simulatedTime = ticks * Physics::deltaT + Physics::GetInterpolationAlpha() * Physics::deltaT;
+    real dropped = Physics::GetDroppedTime() - droppedBefore;
+    std::cout << std::fixed << std::setprecision(3) << "real " << realTime << " s, simulated " << simulatedTime << " s, dropped " << dropped << " s, "
+        << ticks << " ticks, at most " << maxTicks << " per frame\n";
+    std::cout << std::setw(16) << "mode" << std::setw(16) << "max error" << '\n';
+    std::cout << std::setprecision(6) << std::setw(16) << "last tick" << std::setw(16) << rawError << '\n';
+    std::cout << std::setw(16) << "interpolated" << std::setw(16) << interpolatedError << '\n';
+
+    Physics::gravity = gravity;
+    DestroyScene(bodies);
+    return maxTicks <= Physics::maxTicksPerFrame && interpolatedError < rawError && std::abs(simulatedTime + dropped - realTime) < 1e-3;
+}
+
+/// @brief Porównuje czas klatki, gdy krok fizyki i rysowanie wykonywane są po kolei i gdy fizyka działa w PhysicsThread.
+/// @details Rysowanie zastępuje odczyt transformacji wszystkich obiektów i oczekiwanie tyle, ile trwa krok, jak na zakończenie pracy GPU.
+/// deltaT ustawiane jest na zmierzony czas kroku, więc wątek fizyki wykonuje kroki bez przerw, a klatka z wątkiem powinna trwać
+/// tyle co dłuższy z kroku i rysowania zamiast ich sumy. Scena to pole stosów z AddStackField.
+/// @return fałsz jeżeli któraś migawka nie zawierała wszystkich obiektów lub miała nieskończone położenia
+bool BenchmarkPhysicsThread(int bodyCount, int frames)
+{
+    std::vector<Entity> bodies;
+    srand(1);
+    AddStackField(bodies, bodyCount, { 0, 0, -4000.0 });
+    Physics::allowSleeping = false;
+    ColliderManager::broadphase = ColliderManager::Broadphase::SpatialHash;
+    for (int i = 0; i < 10; i++)
+        Physics::Update();
+
+    double tickTime = Measure(10, []() { Physics::Update(); });
+    auto renderTime = std::chrono::duration<double, std::milli>(tickTime);
+    std::cout << "physics thread, " << bodyCount << " bodies, " << frames << " frames, step " << std::fixed << std::setprecision(3) << tickTime << " ms, render " << tickTime << " ms\n";
+    std::cout << std::setw(12) << "mode" << std::setw(16) << "frame [ms]" << std::setw(16) << "ticks/frame" << '\n';
+
+    real checksum = 0;
+    double serialTime = Measure(frames, [&]() {
+        Physics::Update();
+        for (auto&& transform : ECS::System<Transform>::components)
+            checksum += transform.Matrix()[3][0];
+        std::this_thread::sleep_for(renderTime);
+        });
+
+    real deltaT = Physics::deltaT;
+    Physics::deltaT = tickTime / 1000;
+    bool passed = true;
+    PhysicsThread::Start();
+    uint64_t firstTick = PhysicsThread::AcquireSnapshot().tickCount;
+    std::vector<real> matrixX(ECS::System<Transform>::components.size());
+    double threadedTime = Measure(frames, [&]() {
+        PhysicsThread::Synchronize([]() {});
+        const PhysicsThread::Snapshot& snapshot = PhysicsThread::AcquireSnapshot();
+        passed = passed && snapshot.endPositions.size() == Physics::components.size();
+        // Macierze liczone są równolegle, jak w GPUDrivenRendererSystem, więc GetInterpolatedTransform wywoływane jest z wielu wątków naraz.
+        ThreadPool::ParallelFor(matrixX.size(), 64, [&](uint32_t begin, uint32_t end, uint32_t) {
+            for (uint32_t i = begin; i < end; i++)
+                matrixX[i] = PhysicsThread::GetInterpolatedTransform(ECS::System<Transform>::components[i]).Matrix()[3][0];
+            });
+        for (real x : matrixX)
+        {
+            passed = passed && std::isfinite(x);
+            checksum += x;
+        }
+        std::this_thread::sleep_for(renderTime);
+        });
+    PhysicsThread::Stop();
+    uint64_t ticks = PhysicsThread::AcquireSnapshot().tickCount - firstTick;
+
+    std::cout << std::setw(12) << "serial" << std::setw(16) << serialTime << std::setw(16) << 1.0 << '\n';
+    std::cout << std::setw(12) << "threaded" << std::setw(16) << threadedTime << std::setw(16) << ticks / double(frames) << '\n';
+
+    Physics::deltaT = deltaT;
+    DestroyScene(bodies);
+    return passed && std::isfinite(checksum);
+}
+
+/// @brief Porównuje szeroką fazę i krok sceny z dużą podłogą z kafli, gdy kafle są ciałami statycznymi w osobnym drzewie i gdy
+/// jako ciała RigidBody::Type::Dynamic o nieskończonej masie trafiają do par razem z obiektami dynamicznymi, jak przed podziałem.
+/// @details Po podłodze jedzie kinematyczny prostopadłościan, który rozpycha spadające obiekty, a sam porusza się tylko ze swoją prędkością.
+/// @param bodyCount liczba obiektów dynamicznych
+/// @param tileCount liczba kafli podłogi
+/// @return fałsz jeżeli obiekt kinematyczny zboczył z toru lub pary statyczne-statyczne trafiły do wyniku z podziałem
+bool BenchmarkStatic(int bodyCount, int tileCount)
+{
+    std::cout << "static partition, " << bodyCount << " bodies, " << tileCount << " static tiles, " << Physics::subStepCount << " substeps\n";
+    std::cout << std::setw(12) << "mode" << std::setw(12) << "pairs" << std::setw(20) << "broadphase [ms]" << std::setw(16) << "step [ms]" << '\n';
+
+    auto infinity = std::numeric_limits<real>::infinity();
+    rvec3 origin = { 0, 0, -5000.0 };
+    bool passed = true;
+    Physics::allowSleeping = false;
+    ColliderManager::broadphase = ColliderManager::Broadphase::DynamicTree;
+    for (bool partition : { false, true })
+    {
+        std::vector<Entity> bodies;
+        srand(1);
+        int side = (int)ceil(sqrt(tileCount));
+        for (int i = 0; i < tileCount; i++)
+        {
+            rvec3 position = origin + rvec3(((i % side) - side / 2) * 2.0, ((i / side) - side / 2) * 2.0, -0.25);
+            bodies.push_back(Entity::AddEntity(Transform(position, { 1,1,0.25 }), Collider({ 1,1,0.25 }), RigidBody({ 0,0,0 }, { 0,0,0 }, { 0,0,0 }, infinity, rmat3(infinity), 0.2)));
+            if (!partition)
+                bodies.back().GetComponent<RigidBody>().type = RigidBody::Type::Dynamic;
+        }
+
+        // Obiekt kinematyczny startuje tuż przed krawędzią warstw obiektów dynamicznych i wjeżdża w nie.
+        int bodySide = (int)ceil(sqrt(bodyCount / 4.0));
+        rvec3 pusherStart = origin + rvec3(-(bodySide / 2) - 1.5, 0, 1);
+        rvec3 pusherVelocity = { 2, 0, 0 };
+        bodies.push_back(Entity::AddEntity(Transform(pusherStart, { 0.5,4,1 }), Collider({ 0.5,4,1 }), RigidBody(pusherVelocity, { 0,0,0 }, { 0,0,0 }, infinity, rmat3(infinity), 0.2)));
+        bodies.back().GetComponent<RigidBody>().type = RigidBody::Type::Kinematic;
+        Entity pusherEntity = bodies.back();
+
+        for (int i = 0; i < bodyCount; i++)
+        {
+            int layer = i / (bodySide * bodySide);
+            int cell = i % (bodySide * bodySide);
+            real scale = rand() / double(RAND_MAX) * 0.1 + 0.3;
+            rvec3 position = origin + rvec3(((cell % bodySide) - bodySide / 2) * 1.0, ((cell / bodySide) - bodySide / 2) * 1.0, 1 + layer * 1.0);
+            bodies.push_back(Entity::AddEntity(Transform(position, { scale,scale,scale }), Collider({ scale,scale,scale }), RigidBody({ 0,0,0 }, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(1.0 / 12.0 * 8.0 * scale * scale), 0.2)));
+        }
+
+        int frames = 30;
+        for (int i = 0; i < frames; i++)
+            Physics::Update();
+
+        CollisionPairBuffer pairs;
+        double broadphaseTime = Measure(20, [&]() { ColliderManager::GetPossibleCollisions(Physics::deltaT, &pairs); });
+        double stepTime = Measure(20, []() { Physics::Update(); });
+        frames += 20;
+
+        uint32_t staticPairs = 0;
+        for (auto&& pair : pairs)
+            staticPairs += ColliderManager::components[pair.a].GetComponent<RigidBody>().inverseMass == 0 && ColliderManager::components[pair.b].GetComponent<RigidBody>().inverseMass == 0;
+        if (partition)
+            passed = passed && staticPairs == 0;
+
+        rvec3 expected = pusherStart + pusherVelocity * real(frames * Physics::deltaT);
+        real offset = glm::length(pusherEntity.GetComponent<Transform>().position - expected);
+        passed = passed && offset < 1e-3;
+
+        std::cout << std::setw(12) << (partition ? "partition" : "single") << std::setw(12) << pairs.size() << std::fixed << std::setprecision(3)
+            << std::setw(20) << broadphaseTime << std::setw(16) << stepTime << '\n';
+
+        DestroyScene(bodies);
+    }
+
+    if (!passed)
+        std::cout << "static partition failed\n";
+    return passed;
+}
+
+/// @brief Mierzy narzut zadań ThreadPool i skalowanie ParallelFor z liczbą wątków.
+/// @details Dla każdej liczby wątków mierzony jest czas dodania i wykonania pustych zadań, łańcucha zależnych zadań oraz pętli z obliczeniami
+/// o stałym koszcie na element. Sprawdzana jest też kolejność łańcucha, wynik pętli i jednoczesne użycie puli przez inny wątek.
+bool BenchmarkJobs(int taskCount, const std::vector<int>& threadCounts)
+{
+    std::cout << "jobs, " << taskCount << " tasks\n";
+    std::cout << std::setw(10) << "threads" << std::setw(20) << "empty task [ns]" << std::setw(20) << "chain task [ns]" << std::setw(20) << "parallel for [ms]"
+        << std::setw(12) << "speedup" << '\n';
+
+    uint32_t initialThreadCount = ThreadPool::GetThreadCount();
+    uint32_t count = 1 << 20;
+    auto work = [](uint32_t i) {
+        double value = i;
+        for (int k = 0; k < 32; k++)
+            value = std::sqrt(value + k);
+        return value;
+    };
+    std::vector<double> expected(count);
+    for (uint32_t i = 0; i < count; i++)
+        expected[i] = work(i);
+
+    bool passed = true;
+    double firstTime = 0;
+    for (int threadCount : threadCounts)
+    {
+        ThreadPool::Init(threadCount);
+        std::vector<ThreadPool::TaskHandle> tasks(taskCount);
+        std::atomic<int> executed = 0;
+        double emptyTime = Measure(5, [&]() {
+            for (auto&& task : tasks)
+                task = ThreadPool::Submit([&]() { executed++; });
+            for (auto&& task : tasks)
+                ThreadPool::Wait(task);
+            });
+        passed = passed && executed == taskCount * 5;
+
+        // Każde zadanie łańcucha zależy od poprzedniego, więc muszą wykonać się po kolei.
+        int chainLength = taskCount / 10;
+        int next = 0;
+        bool ordered = true;
+        double chainTime = Measure(5, [&]() {
+            next = 0;
+            ThreadPool::TaskHandle previous = ThreadPool::Submit([&]() { ordered = ordered && next++ == 0; });
+            for (int i = 1; i < chainLength; i++)
+                previous = ThreadPool::Submit([&, i]() { ordered = ordered && next++ == i; }, { previous });
+            ThreadPool::Wait(previous);
+            });
+        passed = passed && ordered && next == chainLength;
+
+        std::vector<double> values(count);
+        double time = Measure(10, [&]() {
+            ThreadPool::ParallelFor(count, 4096, [&](uint32_t begin, uint32_t end, uint32_t) {
+                for (uint32_t i = begin; i < end; i++)
+                    values[i] = work(i);
+                });
+            });
+        passed = passed && values == expected;
+        if (firstTime == 0)
+            firstTime = time;
+
+        // Inny wątek dodaje zadania i wywołuje ParallelFor w tym samym czasie co wątek główny.
+        std::vector<double> otherValues(count);
+        std::thread other([&]() {
+            ThreadPool::TaskHandle task = ThreadPool::Submit([&]() { otherValues[0] = work(0); });
+            ThreadPool::ParallelFor(count - 1, 4096, [&](uint32_t begin, uint32_t end, uint32_t) {
+                for (uint32_t i = begin; i < end; i++)
+                    otherValues[i + 1] = work(i + 1);
+                });
+            ThreadPool::Wait(task);
+            });
+        std::fill(values.begin(), values.end(), 0.0);
+        ThreadPool::ParallelFor(count, 4096, [&](uint32_t begin, uint32_t end, uint32_t) {
+            for (uint32_t i = begin; i < end; i++)
+                values[i] = work(i);
+            });
+        other.join();
+        passed = passed && values == expected && otherValues == expected;
+
+        // Kolejne krótko żyjące wątki dostają indeksy zwolnione przez zakończone.
+        for (uint32_t i = 0; i < 2 * ThreadPool::maxExternalThreads; i++)
+        {
+            uint32_t index = 0;
+            std::thread([&]() { index = ThreadPool::GetThreadIndex(); }).join();
+            passed = passed && index == ThreadPool::GetThreadCount();
+        }
+
+        std::cout << std::setw(10) << threadCount << std::fixed << std::setprecision(1) << std::setw(20) << emptyTime * 1e6 / taskCount
+            << std::setw(20) << chainTime * 1e6 / chainLength << std::setprecision(3) << std::setw(20) << time << std::setw(12) << firstTime / time << '\n';
+    }
+    ThreadPool::Init(initialThreadCount);
+
+    if (!passed)
+        std::cout << "job system failed\n";
+    return passed;
+}
+
+/// @brief Scena BenchmarkScenes, @p build dodaje obiekty sceny do wektora.
+struct Scene
+{
+    std::string name;
+    std::function<void(std::vector<Entity>&)> build;
+    /// @brief Liczba kroków przed pomiarem, w których obiekty spadają na siebie.
+    int warmupFrames;
+    int frames;
+};
+
+/// @brief Dodaje nieruchomą podłogę o połowie szerokości @p half z górną powierzchnią na wysokości @p origin .
+void AddFloor(std::vector<Entity>& bodies, real half, rvec3 origin)
+{
+    auto infinity = std::numeric_limits<real>::infinity();
+    bodies.push_back(Entity::AddEntity(Transform(origin - rvec3(0, 0, 0.5), { half,half,0.5 }), Collider({ half,half,0.5 }), RigidBody({ 0,0,0 }, { 0,0,0 }, { 0,0,0 }, infinity, rmat3(infinity), 0.2)));
+}
+
+/// @brief Dodaje kulę lub sześcian o połowie boku @p scale , co drugi obiekt jest kulą.
+void AddMixedBody(std::vector<Entity>& bodies, rvec3 position, real scale, rvec3 velocity = { 0,0,0 })
+{
+    if (bodies.size() % 2 == 0)
+        bodies.push_back(Entity::AddEntity(Transform(position, { scale,scale,scale }), Collider(scale), RigidBody(velocity, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(2.0 / 5.0 * scale * scale), 0.2)));
+    else
+        bodies.push_back(Entity::AddEntity(Transform(position, { scale,scale,scale }), Collider({ scale,scale,scale }), RigidBody(velocity, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(1.0 / 12.0 * 8.0 * scale * scale), 0.2)));
+}
+
+/// @brief Dodaje @p bodyCount obiektów ułożonych w kratę po 10 warstw, spadających na podłogę, jak w BenchmarkSolver.
+void AddPile(std::vector<Entity>& bodies, int bodyCount, rvec3 origin)
+{
+    int side = (int)ceil(sqrt(bodyCount / 10.0));
+    AddFloor(bodies, side * 1.7, origin);
+    for (int i = 0; i < bodyCount; i++)
+    {
+        rvec3 position = origin + rvec3(((i % side) - side / 2) * 1.7, ((i / side % side) - side / 2) * 1.7, 1 + (i / (side * side)) * 1.7);
+        AddMixedBody(bodies, position, rand() / double(RAND_MAX) * 0.3 + 0.5);
+    }
+}
+
+/// @brief Mierzy kroki na stałych scenach i zapisuje czasy faz z Physics::GetStepStats w formacie JSON.
+/// @details Sceny to deszcz kul, piramida prostopadłościanów, stosy 10 i 100 tysięcy obiektów oraz pojemnik z pięciu ścian z przykładowej aplikacji.
+/// Każda scena jest budowana od nowa, po rozgrzewce mierzonych jest @ref Scene::frames kroków bez usypiania, a czasy są uśredniane.
+/// @param names nazwy scen do zmierzenia, puste oznacza wszystkie
+/// @param jsonPath plik wynikowy, pusty oznacza wypisanie JSON na standardowe wyjście
+void BenchmarkScenes(const std::vector<std::string>& names, const std::string& jsonPath)
+{
+    // Sceny leżą przy początku układu, w pojedynczej precyzji daleko od niego małe przesunięcia pod kroku byłyby zaokrąglane do zera.
+    rvec3 origin = { 0, 0, 0 };
+    std::vector<Scene> scenes = {
+        { "sphere_rain", [&](std::vector<Entity>& bodies) {
+            int count = 2000;
+            real half = sqrt(count / 4.0) + 2;
+            AddFloor(bodies, half, origin);
+            for (int i = 0; i < count; i++)
+            {
+                rvec3 position = origin + rvec3((rand() / double(RAND_MAX) * 2 - 1) * (half - 1), (rand() / double(RAND_MAX) * 2 - 1) * (half - 1), 1 + rand() / double(RAND_MAX) * 20);
+                real scale = rand() / double(RAND_MAX) * 0.3 + 0.3;
+                bodies.push_back(Entity::AddEntity(Transform(position, { scale,scale,scale }), Collider(scale), RigidBody({ 0,0,-5 }, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(2.0 / 5.0 * scale * scale), 0.2)));
+            }
+            }, 30, 30 },
+        { "box_pyramid", [&](std::vector<Entity>& bodies) {
+            int base = 14;
+            AddFloor(bodies, base, origin);
+            for (int level = 0; level < base; level++)
+            {
+                int side = base - level;
+                for (int i = 0; i < side * side; i++)
+                {
+                    rvec3 position = origin + rvec3((i % side) - (side - 1) / 2.0, (i / side) - (side - 1) / 2.0, 0.5 + level * 1.001);
+                    bodies.push_back(Entity::AddEntity(Transform(position, { 0.5,0.5,0.5 }), Collider({ 0.5,0.5,0.5 }), RigidBody({ 0,0,0 }, { 0,0,0 }, { 0,0,0 }, 1.0, rmat3(1.0 / 6.0), 0.2)));
+                }
+            }
+            }, 30, 30 },
+        { "pile_10k", [&](std::vector<Entity>& bodies) { AddPile(bodies, 10000, origin); }, 30, 20 },
+        { "pile_100k", [&](std::vector<Entity>& bodies) { AddPile(bodies, 100000, origin); }, 20, 5 },
+        { "container", [&](std::vector<Entity>& bodies) {
+            // Podłoga i cztery ściany jak w tests/Source.cpp.
+            auto infinity = std::numeric_limits<real>::infinity();
+            bodies.push_back(Entity::AddEntity(Transform(origin + rvec3(0, 0, -0.25), { 10,10,0.5 }), Collider({ 10,10,0.5 }), RigidBody({ 0,0,0 }, { 0,0,0 }, { 0,0,0 }, infinity, rmat3(infinity), 1.0)));
+            for (rvec3 wall : { rvec3(10.501, 0, 10.26), rvec3(-10.501, 0, 10.26) })
+                bodies.push_back(Entity::AddEntity(Transform(origin + wall, { 0.5,10,10 }), Collider({ 0.5,10,10 }), RigidBody({ 0,0,0 }, { 0,0,0 }, { 0,0,0 }, infinity, rmat3(infinity), 0.2, 0.1)));
+            for (rvec3 wall : { rvec3(0, 10.501, 10.26), rvec3(0, -10.501, 10.26) })
+                bodies.push_back(Entity::AddEntity(Transform(origin + wall, { 10,0.5,10 }), Collider({ 10,0.5,10 }), RigidBody({ 0,0,0 }, { 0,0,0 }, { 0,0,0 }, infinity, rmat3(infinity), 0.2, 0.1)));
+            for (int i = 0; i < 1000; i++)
+            {
+                rvec3 position = origin + rvec3(((i % 10) - 4.5) * 1.7, ((i / 10 % 10) - 4.5) * 1.7, 1 + (i / 100) * 1.7);
+                AddMixedBody(bodies, position, rand() / double(RAND_MAX) * 0.3 + 0.5);
+            }
+            }, 30, 30 },
+    };
+
+    std::cout << "scenes, " << ThreadPool::GetThreadCount() << " threads, " << Physics::subStepCount << " substeps\n";
+    std::cout << std::setw(14) << "scene" << std::setw(10) << "bodies" << std::setw(12) << "step [ms]" << std::setw(16) << "broadphase [ms]"
+        << std::setw(18) << "narrowphase [ms]" << std::setw(12) << "solve [ms]" << std::setw(16) << "integrate [ms]" << std::setw(12) << "steps/s" << '\n';
+
+    Physics::allowSleeping = false;
+    ColliderManager::broadphase = ColliderManager::Broadphase::SpatialHash;
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(4);
+    json << "{\n  \"precision\": \"" << (sizeof(real) == sizeof(float) ? "float" : "double") << "\",\n  \"threads\": " << ThreadPool::GetThreadCount()
+        << ",\n  \"substeps\": " << Physics::subStepCount << ",\n  \"broadphase\": \"SpatialHash\",\n  \"scenes\": [";
+    bool first = true;
+    for (auto&& scene : scenes)
+    {
+        if (!names.empty() && std::find(names.begin(), names.end(), scene.name) == names.end())
+            continue;
+
+        std::vector<Entity> bodies;
+        srand(1);
+        scene.build(bodies);
+        for (int i = 0; i < scene.warmupFrames; i++)
+            Physics::Update();
+
+        Physics::StepStats total;
+        for (int i = 0; i < scene.frames; i++)
+        {
+            Physics::Update();
+            const Physics::StepStats& stats = Physics::GetStepStats();
+            total.stepTime += stats.stepTime;
+            total.broadphaseTime += stats.broadphaseTime;
+            total.narrowphaseTime += stats.narrowphaseTime;
+            total.solveTime += stats.solveTime;
+            total.integrateTime += stats.integrateTime;
+        }
+        double step = total.stepTime / scene.frames;
+        double broadphase = total.broadphaseTime / scene.frames;
+        double narrowphase = total.narrowphaseTime / scene.frames;
+        double solve = total.solveTime / scene.frames;
+        double integrate = total.integrateTime / scene.frames;
+
+        std::cout << std::setw(14) << scene.name << std::setw(10) << bodies.size() << std::fixed << std::setprecision(3) << std::setw(12) << step
+            << std::setw(16) << broadphase << std::setw(18) << narrowphase << std::setw(12) << solve << std::setw(16) << integrate
+            << std::setprecision(1) << std::setw(12) << 1000.0 / step << '\n';
+        json << (first ? "" : ",") << "\n    {\n      \"name\": \"" << scene.name << "\",\n      \"bodies\": " << bodies.size()
+            << ",\n      \"frames\": " << scene.frames << ",\n      \"pairs\": " << Physics::possibleColliders.size() << ",\n      \"constraints\": " << Physics::GetStepStats().constraintCount
+            << ",\n      \"step_ms\": " << step << ",\n      \"broadphase_ms\": " << broadphase << ",\n      \"narrowphase_ms\": " << narrowphase
+            << ",\n      \"solve_ms\": " << solve << ",\n      \"integrate_ms\": " << integrate << ",\n      \"steps_per_second\": " << 1000.0 / step << "\n    }";
+        first = false;
+
+        DestroyScene(bodies);
+    }
+    json << "\n  ]\n}\n";
+
+    if (jsonPath.empty())
+        std::cout << json.str();
+    else
+        std::ofstream(jsonPath) << json.str();
+}
+
+/// @brief Pomiary wybierane flagami programu, wykonywane w kolejności wyliczenia.
+/// @details Broadphase jako jedyny nie niszczy swojej sceny, więc jest ostatni, żeby jego obiekty nie zmieniały wyników pozostałych pomiarów.
+enum class Mode
+{
+    Narrowphase, GJK, Sleeping, Precision, BoxRain, Tunneling, Speculative, Adaptive, FixedStep, PhysicsThread, Static, Scenes, Jobs, Solver, Broadphase,
+    Count
+};
+
+/// @brief Flaga wybierająca tryb, kilka flag można łączyć, --scenes jest obsługiwane osobno, bo przyjmuje nazwy scen.
+struct ModeFlag
+{
+    const char* name;
+    Mode mode;
+};
+
+constexpr ModeFlag modeFlags[] = {
+    { "--broadphase", Mode::Broadphase }, { "--narrowphase", Mode::Narrowphase }, { "--gjk", Mode::GJK }, { "--sleeping", Mode::Sleeping },
+    { "--precision", Mode::Precision }, { "--box-rain", Mode::BoxRain }, { "--tunneling", Mode::Tunneling }, { "--speculative", Mode::Speculative },
+    { "--adaptive", Mode::Adaptive }, { "--fixed-step", Mode::FixedStep }, { "--physics-thread", Mode::PhysicsThread }, { "--static", Mode::Static },
+    { "--jobs", Mode::Jobs }, { "--solver", Mode::Solver },
+};
+
+int main(int argc, char** argv)
+{
+    std::vector<int> bodyCounts = { 1000, 10000, 100000 };
+    int scanLimit = 100000;
+    int narrowphasePairs = 10000;
+    int sleepingBodies = 10000;
+    int sleepingFrames = 1000;
+    int precisionBodies = 2000;
+    int rainBodies = 2000;
+    int projectiles = 400;
+    int speculativeBodies = 2000;
+    std::set<Mode> selected;
+    std::vector<std::string> sceneNames;
+    std::string jsonPath;
+    std::string tracePath;
+    int jobTasks = 100000;
+    int threadBodies = 1000;
+    int staticBodies = 2000;
+    int adaptiveBodies = 2000;
+    std::vector<double> distances = { 0, 1000, 10000 };
+    int solverBodies = 10000;
+    std::vector<int> threadCounts;
+    for (uint32_t threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2)
+        threadCounts.push_back(threads);
+#ifdef PHYSICS_PROFILER
+    // Bufor stref wątku głównego tworzony jest przed pomiarami alokacji.
+    Profiler::InitThread();
+#endif
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--scan-limit" && i + 1 < argc)
+            scanLimit = atoi(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc)
+            ThreadPool::Init(atoi(argv[++i]));
+        else if (arg == "--narrowphase-pairs" && i + 1 < argc)
+            narrowphasePairs = atoi(argv[++i]);
+        else if (arg == "--solver-bodies" && i + 1 < argc)
+            solverBodies = atoi(argv[++i]);
+        else if (arg == "--sleeping-frames" && i + 1 < argc)
+            sleepingFrames = atoi(argv[++i]);
+        else if (arg == "--sleeping-bodies" && i + 1 < argc)
+            sleepingBodies = atoi(argv[++i]);
+        else if (arg == "--precision-bodies" && i + 1 < argc)
+            precisionBodies = atoi(argv[++i]);
+        else if (arg == "--rain-bodies" && i + 1 < argc)
+            rainBodies = atoi(argv[++i]);
+        else if (arg == "--projectiles" && i + 1 < argc)
+            projectiles = atoi(argv[++i]);
+        else if (arg == "--speculative-bodies" && i + 1 < argc)
+            speculativeBodies = atoi(argv[++i]);
+        else if (arg == "--adaptive-bodies" && i + 1 < argc)
+            adaptiveBodies = atoi(argv[++i]);
+        else if (arg == "--scenes")
+        {
+            selected.insert(Mode::Scenes);
+            while (i + 1 < argc && argv[i + 1][0] != '-')
+                sceneNames.push_back(argv[++i]);
+        }
+        else if (auto mode = std::find_if(std::begin(modeFlags), std::end(modeFlags), [&](const ModeFlag& flag) { return arg == flag.name; }); mode != std::end(modeFlags))
+            selected.insert(mode->mode);
+        else if (arg == "--json" && i + 1 < argc)
+            jsonPath = argv[++i];
+        else if (arg == "--trace" && i + 1 < argc)
+            tracePath = argv[++i];
+        else if (arg == "--job-tasks" && i + 1 < argc)
+            jobTasks = atoi(argv[++i]);
+        else if (arg == "--static-bodies" && i + 1 < argc)
+            staticBodies = atoi(argv[++i]);
+        else if (arg == "--thread-bodies" && i + 1 < argc)
+            threadBodies = atoi(argv[++i]);
+        else if (arg == "--thread-counts")
+        {
+            threadCounts.clear();
+            while (i + 1 < argc && argv[i + 1][0] != '-')
+                threadCounts.push_back(atoi(argv[++i]));
+        }
+        else if (arg == "--distances")
+        {
+            distances.clear();
+            while (i + 1 < argc && argv[i + 1][0] != '-')
+                distances.push_back(atof(argv[++i]));
+        }
+        else if (arg == "--bodies" && i + 1 < argc)
+        {
+            bodyCounts.clear();
+            while (i + 1 < argc && argv[i + 1][0] != '-')
+                bodyCounts.push_back(atoi(argv[++i]));
+        }
+    }
+
+    // Bez flag trybów wykonywane są wszystkie, w kolejności Mode.
+    if (selected.empty())
+        for (int mode = 0; mode < int(Mode::Count); mode++)
+            selected.insert(Mode(mode));
+
+    srand(1);
+    bool passed = true;
+    for (Mode mode : selected)
+    {
+        switch (mode)
+        {
+        case Mode::Narrowphase: passed = BenchmarkNarrowphase(narrowphasePairs) && passed; break;
+        case Mode::GJK: BenchmarkGJK(narrowphasePairs); break;
+        case Mode::Sleeping: BenchmarkSleeping(sleepingBodies, sleepingFrames); break;
+        case Mode::Precision: BenchmarkPrecision(precisionBodies, distances); break;
+        case Mode::BoxRain: passed = BenchmarkBoxRain(rainBodies) && passed; break;
+        case Mode::Tunneling: passed = BenchmarkTunneling(projectiles) && passed; break;
+        case Mode::Speculative: BenchmarkSpeculative(speculativeBodies, 60); break;
+        case Mode::Adaptive: BenchmarkAdaptive(adaptiveBodies, adaptiveBodies / 4); break;
+        case Mode::FixedStep: passed = BenchmarkFixedStep(1000) && passed; break;
+        case Mode::PhysicsThread: passed = BenchmarkPhysicsThread(threadBodies, 60) && passed; break;
+        case Mode::Static: passed = BenchmarkStatic(staticBodies, staticBodies * 5) && passed; break;
+        case Mode::Scenes: BenchmarkScenes(sceneNames, jsonPath); break;
+        case Mode::Jobs: passed = BenchmarkJobs(jobTasks, threadCounts) && passed; break;
+        case Mode::Solver: passed = BenchmarkSolver(solverBodies, threadCounts) && passed; break;
+        case Mode::Broadphase: BenchmarkBroadphase(bodyCounts, scanLimit); break;
+        case Mode::Count: break;
+        }
+    }
+
+    if (!tracePath.empty())
+    {
+#ifndef PHYSICS_PROFILER
+        std::cout << "built without PHYSICS_PROFILER, the trace has no zones\n";
+#endif
+        if (!Profiler::WriteChromeTrace(tracePath.c_str()))
+            std::cout << "unable to write " << tracePath << '\n';
+    }
+
+    // Pomiń niszczenie jednostek przy wyjściu.
+    std::cout.flush();
+    std::_Exit(passed ? 0 : 1);
+}
@@ -9,9 +9,11 @@
 #include <math.h>
 #include "VG/VG.h"
 #include "Physics.h"
+#include "PhysicsThread.h"
 #include "Renderer.h"
 #include "ObjLoader.h"
 #include "UISystems.h"
+#include "Profiler.h"
 using namespace std::chrono_literals;
 using namespace ECS;
 using namespace vg;
@@ -113,40 +115,21 @@ int main()
             auto [vertices, normals, uvs, triangles] = GenerateSphereMesh();
             Renderer::renderSystem[0].AddMesh(triangles, vertices, normals, uvs);
         }
+        // Pliki wczytywane są równolegle, a siatki dodawane w stałej kolejności, bo ich indeksy używane są w MeshArray.
+        const char* meshPaths[] = { "resources/Box.obj", "resources/Kieliszek.obj", "resources/Parasol.obj", "resources/Parasolka.obj",
+            "resources/Stolek.obj", "resources/Stolik.obj", "resources/Ziemia.obj" };
+        constexpr size_t meshCount = std::size(meshPaths);
+        std::vector<glm::vec3> vertices[meshCount];
+        std::vector<glm::vec3> normals[meshCount];
+        std::vector<unsigned int> triangles[meshCount];
+        ThreadPool::TaskHandle loads[meshCount];
+        for (size_t i = 0; i < meshCount; i++)
+            loads[i] = LoadMeshAsync(meshPaths[i], &vertices[i], &normals[i], &triangles[i]);
+        for (size_t i = 0; i < meshCount; i++)
         {
-            auto [vertices, normals, triangles] = LoadMesh("resources/Box.obj");
-            std::vector<glm::vec2> uvs(vertices.size());
-            Renderer::renderSystem[0].AddMesh(triangles, vertices, normals, uvs);
-        }
-        {
-            auto [vertices, normals, triangles] = LoadMesh("resources/Kieliszek.obj");
-            std::vector<glm::vec2> uvs(vertices.size());
-            Renderer::renderSystem[0].AddMesh(triangles, vertices, normals, uvs);
-        }
-        {
-            auto [vertices, normals, triangles] = LoadMesh("resources/Parasol.obj");
-            std::vector<glm::vec2> uvs(vertices.size());
-            Renderer::renderSystem[0].AddMesh(triangles, vertices, normals, uvs);
-        }
-        {
-            auto [vertices, normals, triangles] = LoadMesh("resources/Parasolka.obj");
-            std::vector<glm::vec2> uvs(vertices.size());
-            Renderer::renderSystem[0].AddMesh(triangles, vertices, normals, uvs);
-        }
-        {
-            auto [vertices, normals, triangles] = LoadMesh("resources/Stolek.obj");
-            std::vector<glm::vec2> uvs(vertices.size());
-            Renderer::renderSystem[0].AddMesh(triangles, vertices, normals, uvs);
-        }
-        {
-            auto [vertices, normals, triangles] = LoadMesh("resources/Stolik.obj");
-            std::vector<glm::vec2> uvs(vertices.size());
-            Renderer::renderSystem[0].AddMesh(triangles, vertices, normals, uvs);
-        }
-        {
-            auto [vertices, normals, triangles] = LoadMesh("resources/Ziemia.obj");
-            std::vector<glm::vec2> uvs(vertices.size());
-            Renderer::renderSystem[0].AddMesh(triangles, vertices, normals, uvs);
+            ThreadPool::Wait(loads[i]);
+            std::vector<glm::vec2> uvs(vertices[i].size());
+            Renderer::renderSystem[0].AddMesh(triangles[i], vertices[i], normals[i], uvs);
         }
     }
     std::vector<Entity> glasses(1024 * 128);
@@ -209,12 +192,15 @@ int main()
         });
     glm::dvec2 lastMousePos;
     glfwGetCursorPos(window, &lastMousePos.x, &lastMousePos.y);
+    GPUDrivenRendererSystem::instanceMatrix = [](const Transform& transform) { return PhysicsThread::GetInterpolatedTransform(transform).Matrix(); };
+    PhysicsThread::Start();
     while (!glfwWindowShouldClose(window))
     {
         glfwPollEvents();
         if (glfwGetKey(window, GLFW_KEY_ESCAPE)) glfwSetWindowShouldClose(window, true);
 
-        {
+        // Zmiany świata wykonywane są między krokami wątku fizyki.
+        PhysicsThread::Synchronize([&]() {
             glm::dvec2 mousePos;
             glfwGetCursorPos(window, &mousePos.x, &mousePos.y);
             auto mouseDelta = (lastMousePos - mousePos) * 0.00006 * (double) fov;
@@ -282,30 +268,29 @@ int main()
 
             if (glfwGetKey(window, GLFW_KEY_KP_2))
                 rigidBodies[0].GetComponent<Transform>().position -= glm::dvec3{ 0,1,0 } *speed;
-        }
 
-        if (!SettingsSystem::stop || SettingsSystem::doAStep)
-        {
-            SettingsSystem::doAStep = false;
             Physics::restitutionMult = SettingsSystem::restitutionMultiplier;
             Physics::staticFrictionMult = SettingsSystem::staticFrictionMultiplier;
             Physics::dynamicFrictionMult = SettingsSystem::dynamicFrictionMultiplier;
 
-            Physics::Update();
+            PhysicsThread::paused = SettingsSystem::stop;
+            if (SettingsSystem::stop && SettingsSystem::doAStep)
+                PhysicsThread::Step();
+            SettingsSystem::doAStep = false;
 
             if (SettingsSystem::shouldAddObject)
             {
                 SettingsSystem::shouldAddObject = false;
                 int type = rand() % 2;
-                dvec3 pos;
+                rvec3 pos;
                 pos.x = rand() / double(RAND_MAX) * 7 - 3.5;
                 pos.y = rand() / double(RAND_MAX) * 7 - 3.5;
                 pos.z = 35;
-                dvec3 scale;
+                rvec3 scale;
                 scale.x = rand() / double(RAND_MAX) * 1.5 + 1.75;
                 scale.y = rand() / double(RAND_MAX) * 1.5 + 1.75;
                 scale.z = rand() / double(RAND_MAX) * 1.5 + 1.75;
-                dvec3 velocity;
+                rvec3 velocity;
                 velocity.x = rand() / double(RAND_MAX) * 2 - 1;
                 velocity.y = rand() / double(RAND_MAX) * 2 - 1;
                 velocity.z = rand() / double(RAND_MAX) * 2 - 1;
@@ -330,25 +315,33 @@ int main()
                     ));
                 }
             }
-        }
+            });
         int w, h;
         glfwGetWindowSize(window, &w, &h);
 
+        // Rysowanie czyta tylko migawkę, wątek fizyki może w tym czasie wykonywać krok.
+        PhysicsThread::AcquireSnapshot();
         Renderer::DrawFrame(cameraTransform, glm::radians(fov));
         if (glfwGetKey(window, GLFW_KEY_I)) drawUI = true;
         if (glfwGetKey(window, GLFW_KEY_U)) drawUI = false;
 
         if (drawUI)
         {
-            UISystem::Begin();
-            SettingsSystem::Run();
-            IDDisplaySystem::Run(cameraTransform, glm::radians(fov), (float) w / (float) h);
-            CollisionDisplaySystem::Run();
-            LoggerSystem::Run();
-            UISystem::End(Renderer::GetCurrentCmdBuffer());
+            PhysicsThread::Synchronize([&]() {
+                UISystem::Begin();
+                SettingsSystem::Run();
+                IDDisplaySystem::Run(cameraTransform, glm::radians(fov), (float) w / (float) h);
+                CollisionDisplaySystem::Run();
+                LoggerSystem::Run();
+                UISystem::End(Renderer::GetCurrentCmdBuffer());
+                });
         }
         Renderer::Present(generalQueue);
     }
+    PhysicsThread::Stop();
+#ifdef PHYSICS_PROFILER
+    Profiler::WriteChromeTrace("trace.json");
+#endif
     UISystem::Destroy();
     Renderer::Destroy();
     glfwTerminate();